@@ -0,0 +1,158 @@
+// Streaming NetAnim Output for the IDS Dataset Simulation
+//
+// AnimationInterface writes its XML trace with stdio into a single file, and with packet metadata
+// enabled every packet of the run becomes an element in it. AnimationInterface has no hook for
+// filtering or compressing its output, so this streamer hands it a named pipe (FIFO) as the output
+// file: a reader thread consumes the XML as it is produced, keeps only every N-th packet element
+// (<p> for wired links, <wpr> for Wi-Fi) and writes the result through the AsyncOutputWriter,
+// which compresses it on its writer thread if the file was opened with compression. Topology, node
+// and link elements always pass, so the sampled file still opens in NetAnim.
+//
+// The animation time window is applied by AnimationInterface itself (SetStartTime/SetStopTime);
+// the streamer only sees the packets inside the window. AnimationInterface's per-file packet limit
+// (SetMaxPktsPerTraceFile, 100000 by default, counted before sampling) must be lifted: when it is
+// reached AnimationInterface closes the pipe, the reader sees end of file and the rest of the run
+// would go to plain, unsampled trace files next to the pipe.
+
+#ifndef IDS_ANIM_STREAM_H
+#define IDS_ANIM_STREAM_H
+
+#include "ids_async_output.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+/**
+ * Reader side of the NetAnim pipe: samples packet elements and writes the (compressed) XML.
+ *
+ * Usage: Start() before the AnimationInterface is constructed (its constructor opens the pipe and
+ * blocks until the reader is attached), destroy the AnimationInterface after the run to close the
+ * pipe, then call Finish().
+ */
+class AnimationStream {
+public:
+    AnimationStream() : m_output(nullptr), m_sampleEvery(1), m_packets(0), m_packetsKept(0), m_bytesIn(0) {}
+
+    ~AnimationStream() { Finish(); }
+
+    AnimationStream(const AnimationStream&) = delete;
+    AnimationStream& operator=(const AnimationStream&) = delete;
+
+    /**
+     * Creates the pipe and starts the reader thread.
+     *
+     * @param fifoPath Path of the named pipe to pass to AnimationInterface.
+     * @param output Final output file created by the AsyncOutputWriter, possibly compressed.
+     * @param sampleEvery Keep one packet element in N (1 keeps all).
+     * @return false if the pipe cannot be created or the output file is invalid.
+     */
+    bool Start(const std::string& fifoPath, AsyncOutputFile* output, uint32_t sampleEvery) {
+        if (output == nullptr) {
+            return false;
+        }
+        ::unlink(fifoPath.c_str());
+        if (::mkfifo(fifoPath.c_str(), 0600) != 0) {
+            return false;
+        }
+        m_fifoPath = fifoPath;
+        m_output = output;
+        m_sampleEvery = sampleEvery > 0 ? sampleEvery : 1;
+        m_thread = std::thread(&AnimationStream::Run, this);
+        return true;
+    }
+
+    /// Waits until AnimationInterface has closed the pipe, closes the output and removes the pipe.
+    void Finish() {
+        if (!m_thread.joinable()) {
+            return;
+        }
+        m_thread.join();
+        ::unlink(m_fifoPath.c_str());
+    }
+
+    /**
+     * Writes the number of packet elements seen and kept and the output size.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        os << "NetAnim stream: kept " << m_packetsKept << " of " << m_packets << " packet elements, "
+           << m_bytesIn << " bytes of XML -> " << m_output->GetBytesWritten() << " bytes"
+           << (m_output->GetCompression() == OUTPUT_COMPRESSION_LZ4 ? " before lz4" : "") << std::endl;
+    }
+
+private:
+    /// Reader thread: copies the pipe into the output line by line until AnimationInterface closes it.
+    void Run() {
+        int fd = ::open(m_fifoPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            char buffer[64 * 1024];
+            ssize_t n;
+            while ((n = ::read(fd, buffer, sizeof(buffer))) != 0) {
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    break;
+                }
+                m_bytesIn += n;
+                Consume(buffer, n);
+            }
+            ::close(fd);
+        }
+        if (!m_line.empty()) {
+            EmitLine();
+        }
+        m_output->Close();
+    }
+
+    void Consume(const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            m_line.push_back(data[i]);
+            if (data[i] == '\n') {
+                EmitLine();
+            }
+        }
+    }
+
+    /// Forwards the buffered line unless it is a packet element that is not sampled.
+    void EmitLine() {
+        size_t start = m_line.find_first_not_of(" \t");
+        bool packet = start != std::string::npos &&
+                      (m_line.compare(start, 3, "<p ") == 0 || m_line.compare(start, 5, "<wpr ") == 0);
+        bool keep = true;
+        if (packet) {
+            keep = (m_packets % m_sampleEvery) == 0;
+            ++m_packets;
+            if (keep) {
+                ++m_packetsKept;
+            }
+        }
+        if (keep) {
+            m_output->Write(m_line.data(), m_line.size());
+        }
+        m_line.clear();
+    }
+
+    std::string m_fifoPath;
+    AsyncOutputFile* m_output;   // Final XML file (compressed by the writer if opened so)
+    uint32_t m_sampleEvery;      // Keep one packet element in N
+    std::thread m_thread;        // Pipe reader
+    std::string m_line;          // Line being assembled
+    uint64_t m_packets;          // Packet elements seen
+    uint64_t m_packetsKept;      // Packet elements written
+    uint64_t m_bytesIn;          // XML bytes read from the pipe
+};
+
+} // namespace ns3
+
+#endif // IDS_ANIM_STREAM_H
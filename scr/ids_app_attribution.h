@@ -0,0 +1,308 @@
+// Per-Application Event Attribution for the IDS Dataset Simulation
+//
+// The scenario installs hundreds of applications in loops (OnOff, BulkSend, UdpEcho, PacketSink)
+// and it is not obvious which of them drive the scheduler. This report attributes packets and
+// scheduler events to every application instance and sums them per role (benign-http, syn-flood,
+// ddos, ...).
+//
+// - Roles are derived after setup from each application's attributes: the remote (or local) port
+//   names the service, and a client whose node, peer and start time match an attack window of the
+//   AttackSchedule takes that attack's label. Install sites do not need to register anything.
+// - Packets are counted exactly through the applications' own trace sources (Tx for clients, Rx
+//   for sinks and echo servers).
+// - Events are counted per node by CountingMapScheduler (see ids_sim_profiler.h). ns-3 events do
+//   not carry the application that scheduled them, so a node's events are shared among its
+//   applications in proportion to their packets (est_events). Events of nodes without traced
+//   packets, mostly routers and switches forwarding traffic, are reported as "network".
+//
+// Report format (one row per application):
+//   app,node,type,role,start_s,packets,bytes,est_events
+
+#ifndef IDS_APP_ATTRIBUTION_H
+#define IDS_APP_ATTRIBUTION_H
+
+#include "ns3/application.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+#include "ids_sim_profiler.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Returns the TypeId name of an application without the ns3:: prefix.
+ *
+ * @param app The application.
+ */
+inline std::string AppTypeName(Ptr<Application> app) {
+    std::string type = app->GetInstanceTypeId().GetName();
+    return type.compare(0, 5, "ns3::") == 0 ? type.substr(5) : type;
+}
+
+/**
+ * Name of the service behind a well-known port of the scenario.
+ *
+ * @param port TCP or UDP port.
+ */
+inline std::string AppServiceName(uint16_t port) {
+    switch (port) {
+        case 9: return "echo";
+        case 21: return "ftp";
+        case 22: return "ssh";
+        case 25: return "smtp";
+        case 53: return "dns";
+        case 80: return "http";
+        case 110: return "pop3";
+        case 143: return "imap";
+        case 443: return "https";
+        case 554: return "stream";
+        case 8081: return "fake-http";
+        case 9999: return "cnc";
+        default: return "port-" + std::to_string(port);
+    }
+}
+
+/**
+ * Derives the role of an application from its type, its peer, its start time and the attack
+ * schedule: "server-<service>" for sinks and echo servers, the attack label for clients matching
+ * an attack window, "benign-<service>" for other clients and "other" for unknown types.
+ *
+ * @param node The node the application is installed on.
+ * @param app The application.
+ * @param schedule Attack schedule used to recognise attack clients, or nullptr.
+ */
+inline std::string DeriveAppRole(Ptr<Node> node, Ptr<Application> app, const AttackSchedule* schedule) {
+    std::string type = AppTypeName(app);
+    if (type == "PacketSink") {
+        AddressValue local;
+        app->GetAttribute("Local", local);
+        uint16_t port = InetSocketAddress::IsMatchingType(local.Get())
+                            ? InetSocketAddress::ConvertFrom(local.Get()).GetPort() : 0;
+        return "server-" + AppServiceName(port);
+    }
+    if (type == "UdpEchoServer") {
+        UintegerValue port;
+        app->GetAttribute("Port", port);
+        return "server-" + AppServiceName(static_cast<uint16_t>(port.Get()));
+    }
+
+    Address remote;
+    uint16_t port = 0;
+    uint8_t protocol = 17;
+    if (type == "UdpEchoClient") {
+        AddressValue address;
+        UintegerValue remotePort;
+        app->GetAttribute("RemoteAddress", address);
+        app->GetAttribute("RemotePort", remotePort);
+        remote = address.Get();
+        port = static_cast<uint16_t>(remotePort.Get());
+    } else if (type == "OnOffApplication" || type == "BulkSendApplication") {
+        AddressValue address;
+        TypeIdValue socketType;
+        app->GetAttribute("Remote", address);
+        app->GetAttribute("Protocol", socketType);
+        remote = address.Get();
+        protocol = (socketType.Get().GetName() == "ns3::TcpSocketFactory") ? 6 : 17;
+    } else {
+        return "other";
+    }
+
+    uint32_t target = 0;
+    if (InetSocketAddress::IsMatchingType(remote)) {
+        InetSocketAddress inet = InetSocketAddress::ConvertFrom(remote);
+        target = inet.GetIpv4().Get();
+        port = inet.GetPort();
+    } else if (Ipv4Address::IsMatchingType(remote)) {
+        target = Ipv4Address::ConvertFrom(remote).Get();
+    }
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+    if (schedule != nullptr && ipv4 != nullptr && ipv4->GetNInterfaces() > 1) {
+        TimeValue start;
+        app->GetAttribute("StartTime", start);
+        uint32_t source = ipv4->GetAddress(1, 0).GetLocal().Get();
+        uint8_t label = schedule->Classify(start.Get().GetSeconds(), source, target, protocol, 0, port);
+        if (label != ATTACK_BENIGN) {
+            return AttackLabelName(label);
+        }
+    }
+    return "benign-" + AppServiceName(port);
+}
+
+/**
+ * Registry of all applications with per-instance packet counters and a role for each.
+ */
+class AppAttribution {
+public:
+    AppAttribution() = default;
+
+    AppAttribution(const AppAttribution&) = delete;
+    AppAttribution& operator=(const AppAttribution&) = delete;
+
+    /**
+     * Registers every application installed on every node, derives its role and connects its
+     * packet trace. Call after all applications are installed and addresses are assigned.
+     *
+     * @param schedule Attack schedule used to recognise attack clients, or nullptr.
+     */
+    void Attach(const AttackSchedule* schedule) {
+        CountingMapScheduler::EnableContextCounts();
+        for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+            Ptr<Node> node = *it;
+            for (uint32_t a = 0; a < node->GetNApplications(); ++a) {
+                Ptr<Application> app = node->GetApplication(a);
+                AppSlot slot;
+                slot.nodeId = node->GetId();
+                slot.type = AppTypeName(app);
+                TimeValue start;
+                app->GetAttribute("StartTime", start);
+                slot.start = start.Get().GetSeconds();
+                slot.role = DeriveAppRole(node, app, schedule);
+                m_apps.push_back(slot);
+                Connect(app, static_cast<uint32_t>(m_apps.size() - 1));
+            }
+        }
+    }
+
+    /**
+     * Writes the per-application CSV and closes the file.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @return false if the file is invalid.
+     */
+    bool WriteCsv(AsyncOutputFile* file) const {
+        if (file == nullptr) {
+            return false;
+        }
+        std::vector<uint64_t> estEvents = EstimateEvents();
+        std::string out = "app,node,type,role,start_s,packets,bytes,est_events\n";
+        char line[256];
+        for (size_t i = 0; i < m_apps.size(); ++i) {
+            const AppSlot& slot = m_apps[i];
+            std::snprintf(line, sizeof(line), "%zu,%u,%s,%s,%.3f,%llu,%llu,%llu\n", i, slot.nodeId, slot.type.c_str(),
+                          slot.role.c_str(), slot.start, static_cast<unsigned long long>(slot.packets),
+                          static_cast<unsigned long long>(slot.bytes), static_cast<unsigned long long>(estEvents[i]));
+            out += line;
+        }
+        file->Write(out.data(), out.size());
+        file->Close();
+        return true;
+    }
+
+    /**
+     * Writes the per-role summary.
+     *
+     * @param os The stream receiving the summary.
+     */
+    void Report(std::ostream& os) const {
+        std::vector<uint64_t> estEvents = EstimateEvents();
+        std::map<uint32_t, uint64_t> nodePackets = PacketsPerNode();
+        uint64_t totalEvents = CountingMapScheduler::GetContextEvents(Simulator::NO_CONTEXT);
+        uint64_t networkEvents = 0;
+        for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+            uint32_t id = (*it)->GetId();
+            uint64_t events = CountingMapScheduler::GetContextEvents(id);
+            totalEvents += events;
+            if (nodePackets[id] == 0) {
+                networkEvents += events;
+            }
+        }
+
+        struct RoleTotals {
+            uint32_t apps = 0;
+            uint64_t packets = 0;
+            uint64_t bytes = 0;
+            uint64_t events = 0;
+        };
+        std::map<std::string, RoleTotals> roles;
+        for (size_t i = 0; i < m_apps.size(); ++i) {
+            RoleTotals& t = roles[m_apps[i].role];
+            ++t.apps;
+            t.packets += m_apps[i].packets;
+            t.bytes += m_apps[i].bytes;
+            t.events += estEvents[i];
+        }
+        os << "Application attribution: " << m_apps.size() << " applications, " << totalEvents << " events ("
+           << networkEvents << " on network nodes, " << CountingMapScheduler::GetContextEvents(Simulator::NO_CONTEXT)
+           << " without a node)" << std::endl;
+        for (const auto& entry : roles) {
+            os << "  " << entry.first << ": " << entry.second.apps << " apps, " << entry.second.packets << " packets, "
+               << entry.second.bytes << " bytes, ~" << entry.second.events << " events ("
+               << (totalEvents > 0 ? 100.0 * entry.second.events / totalEvents : 0.0) << "%)" << std::endl;
+        }
+    }
+
+private:
+    /// Counters and description of one application instance.
+    struct AppSlot {
+        uint32_t nodeId = 0;
+        std::string type;      // TypeId name without the ns3:: prefix
+        std::string role;      // e.g. benign-http, server-dns, syn-flood
+        double start = 0.0;    // StartTime in seconds
+        uint64_t packets = 0;  // Packets sent (clients) or received (sinks, echo servers)
+        uint64_t bytes = 0;
+    };
+
+    /// Packets traced for each node, summed over its applications.
+    std::map<uint32_t, uint64_t> PacketsPerNode() const {
+        std::map<uint32_t, uint64_t> nodePackets;
+        for (const AppSlot& slot : m_apps) {
+            nodePackets[slot.nodeId] += slot.packets;
+        }
+        return nodePackets;
+    }
+
+    /// Shares each node's events among its applications in proportion to their packets.
+    std::vector<uint64_t> EstimateEvents() const {
+        std::map<uint32_t, uint64_t> nodePackets = PacketsPerNode();
+        std::vector<uint64_t> estEvents(m_apps.size(), 0);
+        for (size_t i = 0; i < m_apps.size(); ++i) {
+            uint64_t total = nodePackets[m_apps[i].nodeId];
+            if (total > 0) {
+                double events = static_cast<double>(CountingMapScheduler::GetContextEvents(m_apps[i].nodeId));
+                estEvents[i] = static_cast<uint64_t>(events * m_apps[i].packets / total);
+            }
+        }
+        return estEvents;
+    }
+
+    static void OnPacket(AppAttribution* self, uint32_t slot, Ptr<const Packet> packet) {
+        AppSlot& s = self->m_apps[slot];
+        ++s.packets;
+        s.bytes += packet->GetSize();
+    }
+
+    static void OnPacketFrom(AppAttribution* self, uint32_t slot, Ptr<const Packet> packet, const Address& /* from */) {
+        OnPacket(self, slot, packet);
+    }
+
+    /// Connects the packet trace matching the application type.
+    void Connect(Ptr<Application> app, uint32_t slot) {
+        const std::string& type = m_apps[slot].type;
+        if (type == "PacketSink") {
+            app->TraceConnectWithoutContext("Rx", MakeBoundCallback(&AppAttribution::OnPacketFrom, this, slot));
+        } else if (type == "UdpEchoServer") {
+            app->TraceConnectWithoutContext("Rx", MakeBoundCallback(&AppAttribution::OnPacket, this, slot));
+        } else {
+            app->TraceConnectWithoutContext("Tx", MakeBoundCallback(&AppAttribution::OnPacket, this, slot));
+        }
+    }
+
+    std::vector<AppSlot> m_apps;  // Indexed by the slot bound to each trace sink
+};
+
+} // namespace ns3
+
+#endif // IDS_APP_ATTRIBUTION_H
@@ -0,0 +1,522 @@
+// Asynchronous Output Subsystem for the IDS Dataset Simulation
+//
+// Every file the scenario writes used to be written synchronously on the simulator thread, so each
+// write (and any fsync) stalled event processing. This subsystem gives all writers a common
+// AsyncOutputFile handle: records are copied into a per-file buffer on the simulator thread, full
+// buffers are handed to one dedicated writer thread, and the writer thread performs the write,
+// fsync and close system calls.
+//
+// Memory is bounded: buffers come from a fixed pool (bufferSize * maxBuffers bytes, or one buffer
+// per open file if more files than that are open). When the pool is exhausted the producer blocks
+// until the writer thread returns a buffer (backpressure), and the time spent blocked is reported.
+//
+// With threading disabled the same API writes inline on the calling thread, so callers do not need
+// a separate synchronous code path.
+//
+// Record producers that must not stall the simulation (packet captures) can reserve space for a
+// whole record directly in the file buffer and serialize into it, so a record costs one copy into
+// a large batch. Such a file can be set to drop records instead of blocking when the pool is
+// exhausted; dropped records are counted per file. Plain Write calls always block.
+//
+// Files can be opened with streaming LZ4 compression (see ids_lz4_frame.h). Compression runs on
+// the writer thread as part of the write operation, so it costs the simulator thread nothing; the
+// compressed size and the time spent compressing are reported per file. Compressed files get the
+// suffix .lz4 and are standard LZ4 frames with independent 64 KiB blocks.
+//
+// Files are opened on the simulator thread. Each AsyncOutputFile must only be written by one
+// thread at a time, but different files may be written from different threads (the NetAnim
+// streamer fills its file from its own reader thread).
+
+#ifndef IDS_ASYNC_OUTPUT_H
+#define IDS_ASYNC_OUTPUT_H
+
+#include "ids_lz4_frame.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+class AsyncOutputWriter;
+
+/// Compression applied to an output file on the writer thread.
+enum OutputCompression : uint8_t {
+    OUTPUT_COMPRESSION_NONE = 0,
+    OUTPUT_COMPRESSION_LZ4          // LZ4 frame, file name suffix .lz4
+};
+
+/// What Reserve does when the buffer pool is exhausted.
+enum OutputOverflow : uint8_t {
+    OUTPUT_OVERFLOW_BLOCK = 0,      // Wait for the writer thread to return a buffer
+    OUTPUT_OVERFLOW_DROP            // Drop the record and count it
+};
+
+/**
+ * Handle of one output file. Writes are buffered on the calling (simulator) thread; the file
+ * descriptor is only touched by the writer thread.
+ */
+class AsyncOutputFile {
+public:
+    /**
+     * Appends bytes to the file.
+     *
+     * @param data Bytes to write.
+     * @param size Number of bytes.
+     */
+    void Write(const void* data, size_t size);
+
+    /**
+     * Reserves contiguous space for one record in the file buffer. The caller fills all of it
+     * before the next call on this file. Records are never split across buffers, so a dropped
+     * record leaves the file consistent.
+     *
+     * @param size Size of the record in bytes.
+     * @return Pointer to the reserved bytes, or nullptr if the record was dropped because the
+     *         pool is exhausted and the file drops on overflow.
+     */
+    char* Reserve(size_t size);
+
+    /**
+     * Sets the behaviour of Reserve when the buffer pool is exhausted.
+     *
+     * @param overflow Block (default) or drop records.
+     */
+    void SetOverflow(OutputOverflow overflow) { m_overflow = overflow; }
+
+    /// Records dropped by Reserve on overflow.
+    uint64_t GetDroppedRecords() const { return m_droppedRecords; }
+
+    /// Bytes of the records dropped by Reserve on overflow.
+    uint64_t GetDroppedBytes() const { return m_droppedBytes; }
+
+    /// Hands the partially filled buffer to the writer thread.
+    void Flush();
+
+    /// Flushes and closes the file (the close happens on the writer thread).
+    void Close();
+
+    /// Bytes accepted by Write since the file was opened.
+    uint64_t GetBytesWritten() const { return m_bytesWritten; }
+
+    /// Bytes written to disk so far (compressed size for compressed files).
+    uint64_t GetBytesOnDisk() const {
+        return m_compression == OUTPUT_COMPRESSION_NONE ? m_bytesWritten : m_bytesCompressed.load();
+    }
+
+    /// Writer-thread time spent compressing this file, in nanoseconds.
+    uint64_t GetCompressNs() const { return m_compressNs.load(); }
+
+    /// Compression applied to the file.
+    OutputCompression GetCompression() const { return m_compression; }
+
+    /// Path given when the file was opened.
+    const std::string& GetPath() const { return m_path; }
+
+private:
+    friend class AsyncOutputWriter;
+
+    AsyncOutputFile(AsyncOutputWriter* writer, int fd, const std::string& path, bool ownsFd, bool syncOnClose,
+                    OutputCompression compression)
+        : m_writer(writer), m_fd(fd), m_path(path), m_ownsFd(ownsFd), m_syncOnClose(syncOnClose),
+          m_closed(false), m_bytesWritten(0), m_compression(compression), m_frameStarted(false),
+          m_bytesCompressed(0), m_compressNs(0), m_overflow(OUTPUT_OVERFLOW_BLOCK), m_droppedRecords(0),
+          m_droppedBytes(0) {}
+
+    AsyncOutputWriter* m_writer;
+    int m_fd;                                 // Descriptor, used by the writer thread only
+    std::string m_path;
+    bool m_ownsFd;                            // false for stdout/stderr
+    bool m_syncOnClose;                       // fsync before close
+    bool m_closed;
+    uint64_t m_bytesWritten;
+    std::unique_ptr<std::vector<char>> m_buffer;  // Buffer being filled (front buffer)
+    OutputCompression m_compression;
+    bool m_frameStarted;                      // LZ4 frame header written (writer thread only)
+    std::vector<char> m_compressed;           // Compressed output of one operation (writer thread only)
+    std::atomic<uint64_t> m_bytesCompressed;  // Compressed bytes written
+    std::atomic<uint64_t> m_compressNs;       // Writer time spent compressing
+    OutputOverflow m_overflow;                // Reserve policy when the pool is exhausted
+    uint64_t m_droppedRecords;
+    uint64_t m_droppedBytes;
+};
+
+/**
+ * Owns the buffer pool, the queue of pending buffers and the writer thread.
+ */
+class AsyncOutputWriter {
+public:
+    /**
+     * @param threaded Run file I/O on a dedicated writer thread (false writes inline).
+     * @param bufferSize Size of one buffer in bytes.
+     * @param maxBuffers Number of buffers in the pool; bounds the memory used for pending output.
+     */
+    AsyncOutputWriter(bool threaded = true, size_t bufferSize = 1 << 20, size_t maxBuffers = 32)
+        : m_threaded(threaded), m_bufferSize(std::max<size_t>(bufferSize, 4096)),
+          m_maxBuffers(std::max<size_t>(maxBuffers, 2)), m_allocatedBuffers(0), m_inFlight(0), m_stopping(false),
+          m_stallNs(0), m_ioNs(0), m_bytesOut(0), m_writeErrors(0) {
+        if (m_threaded) {
+            m_thread = std::thread(&AsyncOutputWriter::Run, this);
+        }
+    }
+
+    ~AsyncOutputWriter() { Stop(); }
+
+    AsyncOutputWriter(const AsyncOutputWriter&) = delete;
+    AsyncOutputWriter& operator=(const AsyncOutputWriter&) = delete;
+
+    /**
+     * Creates (truncates) a file and returns its handle. The handle stays owned by the writer.
+     *
+     * @param path File to create.
+     * @param syncOnClose fsync the file before closing it.
+     * @param compression Compression applied on the writer thread; LZ4 appends .lz4 to the path.
+     * @return The file handle, or nullptr if the file cannot be created.
+     */
+    AsyncOutputFile* Open(const std::string& path, bool syncOnClose = false,
+                          OutputCompression compression = OUTPUT_COMPRESSION_NONE) {
+        std::string filePath = path + (compression == OUTPUT_COMPRESSION_LZ4 ? ".lz4" : "");
+        int fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return nullptr;
+        }
+        return Adopt(fd, filePath, true, syncOnClose, compression);
+    }
+
+    /**
+     * Wraps an already open descriptor such as STDERR_FILENO. The descriptor is not closed.
+     *
+     * @param fd The descriptor to write to.
+     * @param name Name used in reports.
+     * @return The file handle.
+     */
+    AsyncOutputFile* OpenDescriptor(int fd, const std::string& name) {
+        return Adopt(fd, name, false, false, OUTPUT_COMPRESSION_NONE);
+    }
+
+    /// Closes all files, drains the queue and joins the writer thread.
+    void Stop() {
+        for (auto& file : m_files) {
+            file->Close();
+        }
+        if (m_threaded && m_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_queueCv.notify_one();
+            m_thread.join();
+        }
+    }
+
+    /**
+     * Writes a short report: bytes per file, time the simulator thread was blocked by backpressure
+     * and time the writer spent in system calls.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        uint64_t compressNs = 0;
+        for (const auto& file : m_files) {
+            compressNs += file->GetCompressNs();
+        }
+        os << "Async output: " << m_bytesOut.load() << " bytes written, producer blocked "
+           << m_stallNs / 1e6 << " ms, writer I/O " << m_ioNs.load() / 1e6 << " ms, compression "
+           << compressNs / 1e6 << " ms" << (m_threaded ? "" : " (inline)") << ", " << m_writeErrors.load()
+           << " write errors" << std::endl;
+        for (const auto& file : m_files) {
+            os << "  " << file->GetPath() << ": " << file->GetBytesWritten() << " bytes";
+            if (file->GetCompression() == OUTPUT_COMPRESSION_LZ4) {
+                uint64_t onDisk = file->GetBytesOnDisk();
+                os << " -> " << onDisk << " bytes lz4 ("
+                   << (onDisk > 0 ? static_cast<double>(file->GetBytesWritten()) / onDisk : 0.0) << "x, "
+                   << file->GetCompressNs() / 1e6 << " ms)";
+            }
+            if (file->GetDroppedRecords() > 0) {
+                os << ", " << file->GetDroppedRecords() << " records (" << file->GetDroppedBytes()
+                   << " bytes) dropped on overflow";
+            }
+            os << std::endl;
+        }
+    }
+
+private:
+    friend class AsyncOutputFile;
+
+    /// Unit of work for the writer thread: a filled buffer and/or a close request.
+    struct Op {
+        AsyncOutputFile* file;
+        std::unique_ptr<std::vector<char>> buffer;  // May be null for a pure close
+        bool close;
+    };
+
+    AsyncOutputFile* Adopt(int fd, const std::string& path, bool ownsFd, bool syncOnClose,
+                           OutputCompression compression) {
+        m_files.emplace_back(new AsyncOutputFile(this, fd, path, ownsFd, syncOnClose, compression));
+        return m_files.back().get();
+    }
+
+    /**
+     * Takes a buffer from the pool, blocking while the pool is exhausted (backpressure).
+     *
+     * @param wait false to return nullptr instead of blocking.
+     */
+    std::unique_ptr<std::vector<char>> AcquireBuffer(bool wait = true) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_freeBuffers.empty() && m_allocatedBuffers >= m_maxBuffers && m_inFlight > 0) {
+            if (!wait) {
+                return nullptr;
+            }
+            auto start = std::chrono::steady_clock::now();
+            m_freeCv.wait(lock, [this] { return !m_freeBuffers.empty() || m_inFlight == 0; });
+            m_stallNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+        if (m_freeBuffers.empty()) {
+            // Either the pool is not exhausted yet, or every buffer is a front buffer of an open file
+            // and nothing in flight could free one; allocating is the only way to make progress.
+            ++m_allocatedBuffers;
+            lock.unlock();
+            std::unique_ptr<std::vector<char>> buffer(new std::vector<char>());
+            buffer->reserve(m_bufferSize);
+            return buffer;
+        }
+        std::unique_ptr<std::vector<char>> buffer = std::move(m_freeBuffers.back());
+        m_freeBuffers.pop_back();
+        return buffer;
+    }
+
+    /// Queues an operation for the writer thread, or performs it inline when not threaded.
+    void Submit(Op op) {
+        if (op.buffer) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_inFlight;
+        }
+        if (!m_threaded) {
+            Execute(op);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(op));
+        }
+        m_queueCv.notify_one();
+    }
+
+    /// Performs the system calls of one operation and returns its buffer to the pool.
+    void Execute(Op& op) {
+        AsyncOutputFile* file = op.file;
+        if (file->m_compression == OUTPUT_COMPRESSION_LZ4) {
+            Compress(op);
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (file->m_compression == OUTPUT_COMPRESSION_LZ4) {
+            WriteAll(file->m_fd, file->m_compressed.data(), file->m_compressed.size());
+            file->m_bytesCompressed += file->m_compressed.size();
+            file->m_compressed.clear();
+        } else if (op.buffer && !op.buffer->empty()) {
+            WriteAll(file->m_fd, op.buffer->data(), op.buffer->size());
+        }
+        if (op.close && op.file->m_ownsFd) {
+            if (op.file->m_syncOnClose) {
+                ::fsync(op.file->m_fd);
+            }
+            ::close(op.file->m_fd);
+        }
+        m_ioNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (op.buffer) {
+            op.buffer->clear();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_freeBuffers.push_back(std::move(op.buffer));
+            --m_inFlight;
+        }
+        m_freeCv.notify_one();
+    }
+
+    /// Turns the operation's data into LZ4 frame output: header on first use, blocks, end mark on close.
+    void Compress(const Op& op) {
+        AsyncOutputFile* file = op.file;
+        auto start = std::chrono::steady_clock::now();
+        if (!file->m_frameStarted) {
+            uint8_t header[7];
+            Lz4FrameHeader(header);
+            file->m_compressed.insert(file->m_compressed.end(), header, header + sizeof(header));
+            file->m_frameStarted = true;
+        }
+        if (op.buffer && !op.buffer->empty()) {
+            Lz4AppendBlocks(op.buffer->data(), op.buffer->size(), file->m_compressed);
+        }
+        if (op.close) {
+            const char endMark[4] = {0, 0, 0, 0};
+            file->m_compressed.insert(file->m_compressed.end(), endMark, endMark + sizeof(endMark));
+        }
+        file->m_compressNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void WriteAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ++m_writeErrors;
+                return;
+            }
+            data += n;
+            size -= n;
+            m_bytesOut += n;
+        }
+    }
+
+    /// Writer thread loop: executes queued operations until stopped and drained.
+    void Run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_queueCv.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;  // Stopping and fully drained
+            }
+            Op op = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+            Execute(op);
+            lock.lock();
+        }
+    }
+
+    bool m_threaded;
+    size_t m_bufferSize;
+    size_t m_maxBuffers;
+    size_t m_allocatedBuffers;                                // Buffers created so far
+    size_t m_inFlight;                                        // Buffers queued or being written
+    std::vector<std::unique_ptr<std::vector<char>>> m_freeBuffers;
+    std::deque<Op> m_queue;                                   // Buffers waiting for the writer thread
+    std::vector<std::unique_ptr<AsyncOutputFile>> m_files;
+    std::mutex m_mutex;
+    std::condition_variable m_queueCv;                        // Signals work for the writer thread
+    std::condition_variable m_freeCv;                         // Signals a buffer returned to the pool
+    std::thread m_thread;
+    bool m_stopping;
+    uint64_t m_stallNs;                                       // Producer time blocked on the pool
+    std::atomic<uint64_t> m_ioNs;                             // Writer time spent in system calls
+    std::atomic<uint64_t> m_bytesOut;                         // Bytes written to descriptors
+    std::atomic<uint64_t> m_writeErrors;
+};
+
+inline void AsyncOutputFile::Write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    m_bytesWritten += size;
+    while (size > 0) {
+        if (!m_buffer) {
+            m_buffer = m_writer->AcquireBuffer();
+        }
+        // A record larger than a buffer (see Reserve) can leave the buffer over its nominal size
+        size_t space = m_buffer->size() < m_writer->m_bufferSize ? m_writer->m_bufferSize - m_buffer->size() : 0;
+        size_t chunk = std::min(space, size);
+        m_buffer->insert(m_buffer->end(), bytes, bytes + chunk);
+        bytes += chunk;
+        size -= chunk;
+        if (m_buffer->size() >= m_writer->m_bufferSize) {
+            Flush();
+        }
+    }
+}
+
+inline char* AsyncOutputFile::Reserve(size_t size) {
+    if (m_buffer && !m_buffer->empty() && m_buffer->size() + size > m_writer->m_bufferSize) {
+        Flush();
+    }
+    if (!m_buffer) {
+        m_buffer = m_writer->AcquireBuffer(m_overflow == OUTPUT_OVERFLOW_BLOCK);
+        if (!m_buffer) {
+            ++m_droppedRecords;
+            m_droppedBytes += size;
+            return nullptr;
+        }
+    }
+    // A record larger than a buffer grows it; the buffer is flushed by the next call
+    size_t offset = m_buffer->size();
+    m_buffer->resize(offset + size);
+    m_bytesWritten += size;
+    return m_buffer->data() + offset;
+}
+
+inline void AsyncOutputFile::Flush() {
+    if (m_buffer && !m_buffer->empty()) {
+        m_writer->Submit(AsyncOutputWriter::Op{this, std::move(m_buffer), false});
+    }
+}
+
+inline void AsyncOutputFile::Close() {
+    if (m_closed) {
+        return;
+    }
+    m_closed = true;
+    m_writer->Submit(AsyncOutputWriter::Op{this, std::move(m_buffer), true});
+}
+
+/**
+ * std::streambuf adapter so stream-based producers (std::clog for NS_LOG output, FlowMonitor XML
+ * serialization) can write through an AsyncOutputFile.
+ */
+class AsyncOutputStreamBuf : public std::streambuf {
+public:
+    /**
+     * @param file The file written to.
+     * @param flushOnSync Hand the file buffer to the writer thread on every sync (std::endl, flush),
+     *        so interactive output such as log lines on stderr appears as it is produced instead
+     *        of when a whole buffer has filled.
+     */
+    explicit AsyncOutputStreamBuf(AsyncOutputFile* file, bool flushOnSync = false)
+        : m_file(file), m_flushOnSync(flushOnSync) {
+        setp(m_chunk, m_chunk + sizeof(m_chunk));
+    }
+
+    ~AsyncOutputStreamBuf() override { sync(); }
+
+protected:
+    int overflow(int c) override {
+        sync();
+        if (c != traits_type::eof()) {
+            *pptr() = static_cast<char>(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    /// Moves the locally staged characters into the file buffer (no system call on this thread).
+    int sync() override {
+        if (pptr() > pbase()) {
+            m_file->Write(pbase(), pptr() - pbase());
+            setp(m_chunk, m_chunk + sizeof(m_chunk));
+            if (m_flushOnSync) {
+                m_file->Flush();
+            }
+        }
+        return 0;
+    }
+
+private:
+    AsyncOutputFile* m_file;
+    bool m_flushOnSync;  // Flush the file on every sync
+    char m_chunk[4096];  // Small staging area to batch character-wise writes
+};
+
+} // namespace ns3
+
+#endif // IDS_ASYNC_OUTPUT_H
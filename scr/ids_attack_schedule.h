@@ -0,0 +1,350 @@
+// Attack Schedule and Labels for the IDS Dataset Simulation
+//
+// The attack section of ids_dataset.cc configures each attack with a time window, a target
+// address/port and a set of attacker nodes. This header keeps the same information in one table so
+// exporters can label records while the simulation runs (and offline tools can label PCAPs) without
+// re-deriving the schedule from the code.
+//
+// A record matches a window when its time lies inside the window, one endpoint is an attacker
+// address and the other endpoint is the target (port and protocol must match when the window
+// specifies them). Replies from the target to the attacker match as well. Benign traffic between
+// the same endpoints during a window is labelled as the attack; per-packet ground truth comes from
+// the AttackTag the attack applications attach to their packets (see ids_attack_tag.h), and the
+// windows remain the fallback for consumers without packets (offline tools, phase timelines).
+//
+// Match returns the attack instance of a packet, the 1-based index of its window, which is the row
+// number of the window in attack-schedule.csv (0 for benign traffic).
+//
+// The schedule is written as attack-schedule.csv:
+//   label_id,label,start_s,stop_s,target_ip,target_port,protocol,attackers
+// where attackers is a space-separated list of dotted IPv4 addresses and 0 means "any" for the
+// port and protocol columns. Offline tools load it back with ReadCsv (window times then have the
+// millisecond precision of the file).
+
+#ifndef IDS_ATTACK_SCHEDULE_H
+#define IDS_ATTACK_SCHEDULE_H
+
+#include "ids_async_output.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/// Traffic labels. Values are stored in exported records, so existing values must not change.
+enum AttackLabel : uint8_t {
+    ATTACK_BENIGN = 0,
+    ATTACK_SYN_FLOOD,
+    ATTACK_UDP_FLOOD,
+    ATTACK_ICMP_FLOOD,
+    ATTACK_PORT_SCAN,
+    ATTACK_MITM,
+    ATTACK_FTP_BRUTE_FORCE,
+    ATTACK_SQL_INJECTION,
+    ATTACK_SSH_BRUTE_FORCE,
+    ATTACK_FTP_LOGIN_FLOOD,
+    ATTACK_BOTNET,
+    ATTACK_VPN_FLOOD,
+    ATTACK_CREDENTIAL_STUFFING,
+    ATTACK_XSS,
+    ATTACK_ARP_SPOOFING,
+    ATTACK_ZERO_DAY,
+    ATTACK_DDOS,
+    ATTACK_LABEL_COUNT
+};
+
+/// Name of a label as used in CSV files and reports.
+inline const char* AttackLabelName(uint8_t label) {
+    static const char* const names[ATTACK_LABEL_COUNT] = {
+        "benign", "syn-flood", "udp-flood", "icmp-flood", "port-scan", "mitm",
+        "ftp-brute-force", "sql-injection", "ssh-brute-force", "ftp-login-flood", "botnet",
+        "vpn-flood", "credential-stuffing", "xss", "arp-spoofing", "zero-day", "ddos"};
+    return label < ATTACK_LABEL_COUNT ? names[label] : "unknown";
+}
+
+/// One scheduled attack. Addresses are IPv4 addresses in host byte order (Ipv4Address::Get()).
+struct AttackWindow {
+    uint8_t label;                    // AttackLabel
+    double start;                     // Seconds
+    double stop;                      // Seconds
+    uint32_t target;                  // Target address
+    uint16_t port;                    // Target port, 0 = any
+    uint8_t protocol;                 // IP protocol number, 0 = any
+    std::vector<uint32_t> attackers;  // Attacker addresses
+};
+
+/// Addressing fields of an IPv4 packet, as used for classification. Addresses in host byte order.
+struct PacketTuple {
+    uint32_t src;
+    uint32_t dst;
+    uint8_t protocol;      // IP protocol number
+    uint16_t srcPort;      // TCP/UDP source port, 0 otherwise
+    uint16_t dstPort;      // TCP/UDP destination port, 0 otherwise
+    uint8_t tcpFlags;      // TCP flags byte, 0 for other protocols
+};
+
+/**
+ * Parses the 5-tuple and TCP flags from the raw bytes of an IPv4 header and the start of its
+ * payload. Ports and flags are left 0 for non-first fragments and truncated transport headers.
+ *
+ * @param bytes The IPv4 header.
+ * @param length Number of bytes available.
+ * @param tuple Receives the parsed fields.
+ * @return false if the bytes are not an IPv4 header.
+ */
+inline bool ParseIpv4Tuple(const uint8_t* bytes, size_t length, PacketTuple& tuple) {
+    if (length < 20 || (bytes[0] >> 4) != 4) {
+        return false;
+    }
+    size_t headerLength = (bytes[0] & 0x0f) * 4u;
+    tuple.protocol = bytes[9];
+    tuple.src = (uint32_t(bytes[12]) << 24) | (uint32_t(bytes[13]) << 16) | (uint32_t(bytes[14]) << 8) | bytes[15];
+    tuple.dst = (uint32_t(bytes[16]) << 24) | (uint32_t(bytes[17]) << 16) | (uint32_t(bytes[18]) << 8) | bytes[19];
+    tuple.srcPort = 0;
+    tuple.dstPort = 0;
+    tuple.tcpFlags = 0;
+    bool firstFragment = (((bytes[6] & 0x1f) << 8) | bytes[7]) == 0;
+    if (firstFragment && (tuple.protocol == 6 || tuple.protocol == 17) && length >= headerLength + 4) {
+        tuple.srcPort = static_cast<uint16_t>((bytes[headerLength] << 8) | bytes[headerLength + 1]);
+        tuple.dstPort = static_cast<uint16_t>((bytes[headerLength + 2] << 8) | bytes[headerLength + 3]);
+        if (tuple.protocol == 6 && length >= headerLength + 14) {
+            tuple.tcpFlags = bytes[headerLength + 13];
+        }
+    }
+    return true;
+}
+
+/**
+ * Table of the scheduled attacks with a lookup from a packet's time and 5-tuple to its label.
+ *
+ * The scenario has a handful of windows, so Classify scans them linearly; the time check rejects
+ * almost all windows before any address is compared.
+ */
+class AttackSchedule {
+public:
+    /**
+     * Adds an attack window.
+     *
+     * @param label The AttackLabel of the window.
+     * @param start Start time in seconds.
+     * @param stop Stop time in seconds.
+     * @param target Target address (host byte order).
+     * @param port Target port, 0 for any.
+     * @param protocol IP protocol number (6 TCP, 17 UDP), 0 for any.
+     * @param attackers Attacker addresses (host byte order).
+     * @return The attack instance of the window (its 1-based index).
+     */
+    uint32_t Add(uint8_t label, double start, double stop, uint32_t target, uint16_t port, uint8_t protocol,
+                 const std::vector<uint32_t>& attackers) {
+        m_windows.push_back(AttackWindow{label, start, stop, target, port, protocol, attackers});
+        return static_cast<uint32_t>(m_windows.size());
+    }
+
+    /// All windows in the order they were added.
+    const std::vector<AttackWindow>& GetWindows() const { return m_windows; }
+
+    /**
+     * Returns the label of a packet, or ATTACK_BENIGN if no window matches.
+     *
+     * @param time Packet time in seconds.
+     * @param src Source address (host byte order).
+     * @param dst Destination address (host byte order).
+     * @param protocol IP protocol number.
+     * @param srcPort Source port (0 for protocols without ports).
+     * @param dstPort Destination port (0 for protocols without ports).
+     */
+    uint8_t Classify(double time, uint32_t src, uint32_t dst, uint8_t protocol, uint16_t srcPort, uint16_t dstPort) const {
+        return InstanceLabel(Match(time, src, dst, protocol, srcPort, dstPort));
+    }
+
+    /**
+     * Returns the attack instance a packet belongs to: the 1-based index of the first matching
+     * window in GetWindows() order, or 0 for benign traffic. Parameters as for Classify.
+     */
+    uint32_t Match(double time, uint32_t src, uint32_t dst, uint8_t protocol, uint16_t srcPort, uint16_t dstPort) const {
+        for (size_t i = 0; i < m_windows.size(); ++i) {
+            const AttackWindow& w = m_windows[i];
+            if (time < w.start || time > w.stop) {
+                continue;
+            }
+            if (w.protocol != 0 && w.protocol != protocol) {
+                continue;
+            }
+            if ((dst == w.target && (w.port == 0 || dstPort == w.port) && IsAttacker(w, src)) ||
+                (src == w.target && (w.port == 0 || srcPort == w.port) && IsAttacker(w, dst))) {
+                return static_cast<uint32_t>(i + 1);
+            }
+        }
+        return 0;
+    }
+
+    /// Label of an attack instance returned by Match (ATTACK_BENIGN for instance 0).
+    uint8_t InstanceLabel(uint32_t instance) const {
+        if (instance == 0 || instance > m_windows.size()) {
+            return ATTACK_BENIGN;
+        }
+        return m_windows[instance - 1].label;
+    }
+
+    /**
+     * Returns the label of the first window active at a time, or ATTACK_BENIGN.
+     *
+     * @param time Time in seconds.
+     */
+    uint8_t ActivePhase(double time) const {
+        for (const AttackWindow& w : m_windows) {
+            if (time >= w.start && time <= w.stop) {
+                return w.label;
+            }
+        }
+        return ATTACK_BENIGN;
+    }
+
+    /**
+     * Writes the schedule as CSV and closes the file.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @return false if the file is invalid.
+     */
+    bool WriteCsv(AsyncOutputFile* file) const {
+        if (file == nullptr) {
+            return false;
+        }
+        std::string out = "label_id,label,start_s,stop_s,target_ip,target_port,protocol,attackers\n";
+        char line[256];
+        for (const AttackWindow& w : m_windows) {
+            std::snprintf(line, sizeof(line), "%u,%s,%.3f,%.3f,%s,%u,%u,", w.label, AttackLabelName(w.label),
+                          w.start, w.stop, FormatAddress(w.target).c_str(), w.port, w.protocol);
+            out += line;
+            for (size_t i = 0; i < w.attackers.size(); ++i) {
+                if (i > 0) {
+                    out += ' ';
+                }
+                out += FormatAddress(w.attackers[i]);
+            }
+            out += '\n';
+        }
+        file->Write(out.data(), out.size());
+        file->Close();
+        return true;
+    }
+
+    /**
+     * Appends the windows of a schedule written by WriteCsv in file order, so attack instances keep
+     * their row numbers.
+     *
+     * @param path The attack-schedule.csv file.
+     * @return false if the file cannot be read or a row is malformed.
+     */
+    bool ReadCsv(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "r");
+        if (file == nullptr) {
+            return false;
+        }
+        std::string text;
+        char chunk[4096];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            text.append(chunk, n);
+        }
+        std::fclose(file);
+
+        size_t start = text.find('\n');  // Skip the header row
+        if (start == std::string::npos) {
+            return false;
+        }
+        ++start;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) {
+                end = text.size();
+            }
+            std::string row = text.substr(start, end - start);
+            start = end + 1;
+            if (row.empty()) {
+                continue;
+            }
+            unsigned label;
+            unsigned port;
+            unsigned protocol;
+            double begin;
+            double stop;
+            char target[16];
+            int consumed = 0;
+            if (std::sscanf(row.c_str(), "%u,%*[^,],%lf,%lf,%15[^,],%u,%u,%n", &label, &begin, &stop, target, &port,
+                            &protocol, &consumed) != 6 || consumed == 0 || label >= ATTACK_LABEL_COUNT) {
+                return false;
+            }
+            AttackWindow w{static_cast<uint8_t>(label), begin, stop, 0, static_cast<uint16_t>(port),
+                           static_cast<uint8_t>(protocol), {}};
+            if (!ParseAddress(target, w.target)) {
+                return false;
+            }
+            size_t pos = static_cast<size_t>(consumed);
+            while (pos < row.size()) {
+                size_t space = row.find(' ', pos);
+                if (space == std::string::npos) {
+                    space = row.size();
+                }
+                uint32_t attacker;
+                if (space > pos) {
+                    if (!ParseAddress(row.substr(pos, space - pos).c_str(), attacker)) {
+                        return false;
+                    }
+                    w.attackers.push_back(attacker);
+                }
+                pos = space + 1;
+            }
+            m_windows.push_back(w);
+        }
+        return true;
+    }
+
+    /**
+     * Parses a dotted IPv4 address into host byte order.
+     *
+     * @param text The address, e.g. "10.3.1.4".
+     * @param address Receives the address.
+     * @return false if the text is not a dotted IPv4 address.
+     */
+    static bool ParseAddress(const char* text, uint32_t& address) {
+        unsigned a;
+        unsigned b;
+        unsigned c;
+        unsigned d;
+        char extra;
+        if (std::sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4 || a > 255 || b > 255 || c > 255 ||
+            d > 255) {
+            return false;
+        }
+        address = (a << 24) | (b << 16) | (c << 8) | d;
+        return true;
+    }
+
+    /// Dotted notation of a host-order IPv4 address.
+    static std::string FormatAddress(uint32_t address) {
+        char text[16];
+        std::snprintf(text, sizeof(text), "%u.%u.%u.%u", (address >> 24) & 0xff, (address >> 16) & 0xff,
+                      (address >> 8) & 0xff, address & 0xff);
+        return text;
+    }
+
+private:
+    static bool IsAttacker(const AttackWindow& w, uint32_t address) {
+        for (uint32_t attacker : w.attackers) {
+            if (attacker == address) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<AttackWindow> m_windows;
+};
+
+} // namespace ns3
+
+#endif // IDS_ATTACK_SCHEDULE_H
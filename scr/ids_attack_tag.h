@@ -0,0 +1,349 @@
+// Packet-Level Ground Truth for the IDS Dataset Simulation
+//
+// The attack schedule (ids_attack_schedule.h) labels a packet when it falls inside an attack
+// window between an attacker and the target, so benign traffic between the same endpoints during
+// a window is labelled as the attack. This header labels packets at their source instead: every
+// attack application is registered with its attack instance, and each packet it sends carries an
+// AttackTag (label and instance, 5 bytes) from the moment it enters the IPv4 stack. Packet tags
+// survive forwarding, fragmentation and the device headers added on the way, so every tracer,
+// capture writer and exporter reads the label from the packet instead of matching windows.
+//
+// - Install sites register the ApplicationContainer of an attack together with the instance
+//   returned by AttackSchedule::Add.
+// - The tagger listens to the Ipv4L3Protocol "SendOutgoing" trace of every node, which fires for
+//   locally generated packets before they are copied to the output interface. A packet sent by a
+//   registered node is tagged when its destination, destination port and protocol are the ones of
+//   a registered application and its source port is the port of that application's socket.
+// - Sockets only exist once an application starts, so their ports are resolved on the first
+//   packet to the target: OnOff and BulkSend through GetSocket, UdpEchoClient through its
+//   TxWithAddresses trace, which fires before the packet is sent.
+// - Replies (SYN-ACKs, echo replies, ACKs of the target) are tagged with the instance of the flow
+//   they answer: the first tagged packet of a flow records its 5-tuple, and packets sent with the
+//   reversed 5-tuple get the same tag.
+//
+// Packets the stack generates on its own (ARP, ICMP errors, routing) carry no tag and are benign.
+
+#ifndef IDS_ATTACK_TAG_H
+#define IDS_ATTACK_TAG_H
+
+#include "ns3/application-container.h"
+#include "ns3/application.h"
+#include "ns3/bulk-send-application.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/node-list.h"
+#include "ns3/onoff-application.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+#include "ns3/tag.h"
+#include "ns3/udp-echo-client.h"
+#include "ns3/uinteger.h"
+
+#include "ids_attack_schedule.h"
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/// Packet tag holding the ground-truth label and attack instance of a packet.
+class AttackTag : public Tag {
+public:
+    AttackTag() : m_label(ATTACK_BENIGN), m_instance(0) {}
+
+    AttackTag(uint8_t label, uint32_t instance) : m_label(label), m_instance(instance) {}
+
+    static TypeId GetTypeId() {
+        static TypeId tid = TypeId("ns3::AttackTag").SetParent<Tag>().SetGroupName("Network").AddConstructor<AttackTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override { return GetTypeId(); }
+
+    uint32_t GetSerializedSize() const override { return 5; }
+
+    void Serialize(TagBuffer buffer) const override {
+        buffer.WriteU8(m_label);
+        buffer.WriteU32(m_instance);
+    }
+
+    void Deserialize(TagBuffer buffer) override {
+        m_label = buffer.ReadU8();
+        m_instance = buffer.ReadU32();
+    }
+
+    void Print(std::ostream& os) const override { os << AttackLabelName(m_label) << " #" << m_instance; }
+
+    /// AttackLabel of the packet.
+    uint8_t GetLabel() const { return m_label; }
+
+    /// Attack instance of the packet (row of its window in attack-schedule.csv).
+    uint32_t GetInstance() const { return m_instance; }
+
+private:
+    uint8_t m_label;
+    uint32_t m_instance;
+};
+
+/**
+ * Reads the ground truth of a packet from its AttackTag.
+ *
+ * @param packet The packet.
+ * @param instance Receives the attack instance, 0 for untagged packets.
+ * @param label Receives the AttackLabel, ATTACK_BENIGN for untagged packets.
+ * @return true if the packet carries an AttackTag.
+ */
+inline bool ReadAttackTag(Ptr<const Packet> packet, uint32_t& instance, uint8_t& label) {
+    AttackTag tag;
+    if (!packet->PeekPacketTag(tag)) {
+        instance = 0;
+        label = ATTACK_BENIGN;
+        return false;
+    }
+    instance = tag.GetInstance();
+    label = tag.GetLabel();
+    return true;
+}
+
+/// Returns the AttackLabel of a packet, ATTACK_BENIGN if it carries no AttackTag.
+inline uint8_t AttackTagLabel(Ptr<const Packet> packet) {
+    AttackTag tag;
+    return packet->PeekPacketTag(tag) ? tag.GetLabel() : static_cast<uint8_t>(ATTACK_BENIGN);
+}
+
+/**
+ * Tags the packets of the registered attack applications and the replies they receive.
+ *
+ * Packets of nodes without attack applications cost one hash lookup (for replies) once the first
+ * attack flow has started; packets of attacker nodes additionally scan the node's applications.
+ */
+class AttackTagger {
+public:
+    AttackTagger() : m_tagged(0), m_replies(0) {}
+
+    AttackTagger(const AttackTagger&) = delete;
+    AttackTagger& operator=(const AttackTagger&) = delete;
+
+    /**
+     * Registers the applications of one attack instance. Supported types are OnOffApplication,
+     * BulkSendApplication and UdpEchoClient; other applications are ignored.
+     *
+     * @param apps The applications installed for the attack.
+     * @param instance The attack instance returned by AttackSchedule::Add.
+     */
+    void Register(const ApplicationContainer& apps, uint32_t instance) {
+        for (ApplicationContainer::Iterator it = apps.Begin(); it != apps.End(); ++it) {
+            Endpoint e;
+            e.app = *it;
+            e.instance = instance;
+            e.label = ATTACK_BENIGN;
+            e.localPort = 0;
+            if (!ReadRemote(e)) {
+                continue;
+            }
+            uint32_t nodeId = e.app->GetNode()->GetId();
+            if (nodeId >= m_nodes.size()) {
+                m_nodes.resize(nodeId + 1);
+            }
+            m_nodes[nodeId].push_back(e);
+        }
+    }
+
+    /**
+     * Resolves the labels of the registered instances and connects the SendOutgoing trace of
+     * every node. Call once after all attacks are registered and before the simulation runs.
+     *
+     * @param schedule The schedule the instances were added to.
+     */
+    void Attach(const AttackSchedule* schedule) {
+        for (uint32_t nodeId = 0; nodeId < m_nodes.size(); ++nodeId) {
+            for (uint32_t i = 0; i < m_nodes[nodeId].size(); ++i) {
+                Endpoint& e = m_nodes[nodeId][i];
+                e.label = schedule->InstanceLabel(e.instance);
+                if (DynamicCast<UdpEchoClient>(e.app)) {
+                    e.app->TraceConnectWithoutContext(
+                        "TxWithAddresses", MakeBoundCallback(&AttackTagger::OnEchoTx, this, nodeId, i));
+                }
+            }
+        }
+        for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+            Ptr<Ipv4L3Protocol> ipv4 = (*it)->GetObject<Ipv4L3Protocol>();
+            if (ipv4) {
+                ipv4->TraceConnectWithoutContext(
+                    "SendOutgoing", MakeBoundCallback(&AttackTagger::OnSendOutgoing, this, (*it)->GetId()));
+            }
+        }
+    }
+
+    /// Packets tagged since Attach, replies included.
+    uint64_t GetTaggedPackets() const { return m_tagged; }
+
+    /**
+     * Writes the number of tagged packets and attack flows.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        uint32_t apps = 0;
+        uint32_t resolved = 0;
+        for (const std::vector<Endpoint>& node : m_nodes) {
+            for (const Endpoint& e : node) {
+                ++apps;
+                resolved += (e.localPort != 0) ? 1 : 0;
+            }
+        }
+        os << "Attack tags: " << m_tagged << " packets tagged (" << m_replies << " replies) in " << m_flows.size()
+           << " flows, " << resolved << " of " << apps << " attack applications sent traffic" << std::endl;
+    }
+
+private:
+    /// A registered attack application and the socket it sends from.
+    struct Endpoint {
+        Ptr<Application> app;
+        uint32_t target;                  // Remote address (host byte order)
+        uint16_t port;                    // Remote port
+        uint8_t protocol;                 // 6 or 17
+        uint16_t localPort;               // Source port of the socket, 0 until resolved
+        uint32_t instance;
+        uint8_t label;
+    };
+
+    /// 5-tuple of a tagged flow in the direction of the attack.
+    struct FlowKey {
+        uint32_t src;
+        uint32_t dst;
+        uint16_t srcPort;
+        uint16_t dstPort;
+        uint8_t protocol;
+
+        bool operator==(const FlowKey& o) const {
+            return src == o.src && dst == o.dst && srcPort == o.srcPort && dstPort == o.dstPort &&
+                   protocol == o.protocol;
+        }
+    };
+
+    struct FlowKeyHash {
+        size_t operator()(const FlowKey& k) const {
+            uint64_t a = (uint64_t(k.src) << 32) | k.dst;
+            uint64_t b = (uint64_t(k.srcPort) << 24) | (uint64_t(k.dstPort) << 8) | k.protocol;
+            return std::hash<uint64_t>()(a ^ (b * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    /// Reads the remote endpoint of an application from its attributes; false for other types.
+    static bool ReadRemote(Endpoint& e) {
+        Address remote;
+        if (DynamicCast<UdpEchoClient>(e.app)) {
+            AddressValue address;
+            UintegerValue remotePort;
+            e.app->GetAttribute("RemoteAddress", address);
+            e.app->GetAttribute("RemotePort", remotePort);
+            remote = address.Get();
+            e.port = static_cast<uint16_t>(remotePort.Get());
+            e.protocol = 17;
+        } else if (DynamicCast<OnOffApplication>(e.app) || DynamicCast<BulkSendApplication>(e.app)) {
+            AddressValue address;
+            TypeIdValue socketType;
+            e.app->GetAttribute("Remote", address);
+            e.app->GetAttribute("Protocol", socketType);
+            remote = address.Get();
+            e.port = 0;
+            e.protocol = (socketType.Get().GetName() == "ns3::TcpSocketFactory") ? 6 : 17;
+        } else {
+            return false;
+        }
+        if (InetSocketAddress::IsMatchingType(remote)) {
+            InetSocketAddress inet = InetSocketAddress::ConvertFrom(remote);
+            e.target = inet.GetIpv4().Get();
+            e.port = inet.GetPort();
+        } else if (Ipv4Address::IsMatchingType(remote)) {
+            e.target = Ipv4Address::ConvertFrom(remote).Get();
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /// Looks up the source port of an OnOff or BulkSend socket once the application has created it.
+    static void ResolveSocket(Endpoint& e) {
+        Ptr<Socket> socket;
+        if (Ptr<OnOffApplication> onOff = DynamicCast<OnOffApplication>(e.app)) {
+            socket = onOff->GetSocket();
+        } else if (Ptr<BulkSendApplication> bulkSend = DynamicCast<BulkSendApplication>(e.app)) {
+            socket = bulkSend->GetSocket();
+        }
+        Address local;
+        if (socket && socket->GetSockName(local) == 0 && InetSocketAddress::IsMatchingType(local)) {
+            e.localPort = InetSocketAddress::ConvertFrom(local).GetPort();
+        }
+    }
+
+    static void OnEchoTx(AttackTagger* self, uint32_t nodeId, uint32_t index, Ptr<const Packet> /* packet */,
+                         const Address& from, const Address& /* to */) {
+        if (InetSocketAddress::IsMatchingType(from)) {
+            self->m_nodes[nodeId][index].localPort = InetSocketAddress::ConvertFrom(from).GetPort();
+        }
+    }
+
+    static void OnSendOutgoing(AttackTagger* self, uint32_t nodeId, const Ipv4Header& header, Ptr<const Packet> packet,
+                               uint32_t /* interface */) {
+        self->Tag(nodeId, header, packet);
+    }
+
+    /// Tags a packet entering the IPv4 stack if it belongs to an attack flow or answers one.
+    void Tag(uint32_t nodeId, const Ipv4Header& header, Ptr<const Packet> packet) {
+        FlowKey key;
+        key.protocol = header.GetProtocol();
+        if (key.protocol != 6 && key.protocol != 17) {
+            return;
+        }
+        uint8_t ports[4];
+        if (packet->CopyData(ports, sizeof(ports)) < sizeof(ports)) {
+            return;
+        }
+        key.src = header.GetSource().Get();
+        key.dst = header.GetDestination().Get();
+        key.srcPort = static_cast<uint16_t>((ports[0] << 8) | ports[1]);
+        key.dstPort = static_cast<uint16_t>((ports[2] << 8) | ports[3]);
+
+        if (nodeId < m_nodes.size()) {
+            for (Endpoint& e : m_nodes[nodeId]) {
+                if (e.target != key.dst || e.port != key.dstPort || e.protocol != key.protocol) {
+                    continue;
+                }
+                if (e.localPort == 0) {
+                    ResolveSocket(e);
+                }
+                if (e.localPort == key.srcPort) {
+                    packet->AddPacketTag(AttackTag(e.label, e.instance));
+                    m_flows.emplace(key, AttackTag(e.label, e.instance));
+                    ++m_tagged;
+                    return;
+                }
+            }
+        }
+        if (m_flows.empty()) {
+            return;
+        }
+        FlowKey reverse{key.dst, key.src, key.dstPort, key.srcPort, key.protocol};
+        auto flow = m_flows.find(reverse);
+        if (flow != m_flows.end()) {
+            packet->AddPacketTag(flow->second);
+            ++m_tagged;
+            ++m_replies;
+        }
+    }
+
+    std::vector<std::vector<Endpoint>> m_nodes;                // Attack applications by node ID
+    std::unordered_map<FlowKey, AttackTag, FlowKeyHash> m_flows;  // Tags of the attack flows seen
+    uint64_t m_tagged;                                         // Packets tagged
+    uint64_t m_replies;                                        // Of which replies to attack flows
+};
+
+} // namespace ns3
+
+#endif // IDS_ATTACK_TAG_H
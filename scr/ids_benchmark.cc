@@ -0,0 +1,233 @@
+// IDS Dataset Scenario Benchmark
+// Runs fixed-seed, shortened variants of ids_dataset.cc and reports events/sec, wall time, peak
+// memory and bytes of output per variant as JSON lines, so runs can be compared over time and
+// performance regressions show up.
+//
+// Each variant runs the scenario binary in its own directory under --out-dir with --RngSeed and
+// --RngRun fixed, --log-profile=none and --run-summary. Events, simulated and wall time come from
+// the run summary; peak memory is the child's maximum RSS (getrusage); output bytes are the total
+// size of the files the run left in its directory, excluding its log and summary.
+//
+// Variants:
+// - benign-only:  benign clients only, first 60 simulated seconds.
+// - flood-only:   attack clients only, first 130 s (SYN flood and UDP flood windows).
+// - wifi-heavy:   benign clients only with 50 Wi-Fi stations, first 60 s.
+// - clients-10x:  all traffic with 10x enterprise, Wi-Fi and remote clients, first 30 s.
+//
+// The benchmark only depends on the C++ standard library and POSIX, so it can be built inside the
+// ns-3 scratch directory or on its own:
+//   g++ -O2 -std=c++17 -o ids_benchmark ids_benchmark.cc
+//
+// Usage:
+//   ids_benchmark --binary=<ids_dataset executable> [--out-dir=benchmark-runs]
+//                 [--results=benchmark-results.jsonl] [--seed=1] [--variants=benign-only,flood-only]
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// One shortened scenario variant.
+struct BenchmarkVariant {
+    const char* name;
+    std::vector<std::string> args;  // Scenario arguments on top of the common ones
+};
+
+/// Result of one variant run.
+struct BenchmarkResult {
+    int exitCode = -1;
+    double wallSeconds = 0.0;       // Measured by the benchmark around the child process
+    double simSeconds = 0.0;        // From the run summary
+    double runWallSeconds = 0.0;    // Simulator::Run only, from the run summary
+    unsigned long long events = 0;
+    double eventsPerSecond = 0.0;
+    long peakRssKb = 0;
+    unsigned long long outputBytes = 0;
+    unsigned outputFiles = 0;
+};
+
+static const std::vector<BenchmarkVariant>& Variants() {
+    static const std::vector<BenchmarkVariant> variants = {
+        {"benign-only", {"--traffic=benign", "--run-time=60"}},
+        {"flood-only", {"--traffic=attack", "--run-time=130"}},
+        {"wifi-heavy", {"--traffic=benign", "--wifi-stations=50", "--run-time=60"}},
+        {"clients-10x", {"--client-scale=10", "--run-time=30"}},
+    };
+    return variants;
+}
+
+static const char RUN_SUMMARY[] = "run-summary.json";
+static const char RUN_LOG[] = "run.log";
+
+/// Returns the value of a --name=value argument, or an empty string.
+static std::string OptionValue(const char* arg, const char* name) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return "";
+}
+
+/// Sums the sizes of the regular files in a directory, skipping the run log and summary.
+static void MeasureOutput(const std::string& dir, BenchmarkResult& result) {
+    DIR* d = ::opendir(dir.c_str());
+    if (d == nullptr) {
+        return;
+    }
+    while (struct dirent* entry = ::readdir(d)) {
+        if (std::strcmp(entry->d_name, RUN_SUMMARY) == 0 || std::strcmp(entry->d_name, RUN_LOG) == 0) {
+            continue;
+        }
+        struct stat st;
+        std::string path = dir + "/" + entry->d_name;
+        if (::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            result.outputBytes += static_cast<unsigned long long>(st.st_size);
+            ++result.outputFiles;
+        }
+    }
+    ::closedir(d);
+}
+
+/// Reads the one-line JSON summary written by ids_dataset --run-summary.
+static bool ReadRunSummary(const std::string& path, BenchmarkResult& result) {
+    std::FILE* file = std::fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        return false;
+    }
+    long peakRssKb = 0;
+    int n = std::fscanf(file, "{\"sim_s\":%lf,\"wall_s\":%lf,\"events\":%llu,\"events_per_s\":%lf,\"peak_rss_kb\":%ld}",
+                        &result.simSeconds, &result.runWallSeconds, &result.events, &result.eventsPerSecond,
+                        &peakRssKb);
+    std::fclose(file);
+    if (peakRssKb > result.peakRssKb) {
+        result.peakRssKb = peakRssKb;
+    }
+    return n == 5;
+}
+
+/// Runs one variant in its own directory and collects its measurements.
+static BenchmarkResult RunVariant(const std::string& binary, const std::string& dir, const BenchmarkVariant& variant,
+                                  unsigned seed) {
+    BenchmarkResult result;
+    ::mkdir(dir.c_str(), 0755);
+    ::unlink((dir + "/" + RUN_SUMMARY).c_str());
+
+    std::vector<std::string> args = {binary, "--RngSeed=" + std::to_string(seed), "--RngRun=1",
+                                     "--log-profile=none", std::string("--run-summary=") + RUN_SUMMARY};
+    args.insert(args.end(), variant.args.begin(), variant.args.end());
+    std::vector<char*> argv;
+    for (std::string& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        // Child: run the scenario inside the variant directory with its output in run.log
+        if (::chdir(dir.c_str()) != 0) {
+            ::_exit(127);
+        }
+        int log = ::open(RUN_LOG, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log >= 0) {
+            ::dup2(log, STDOUT_FILENO);
+            ::dup2(log, STDERR_FILENO);
+            ::close(log);
+        }
+        ::execv(argv[0], argv.data());
+        ::_exit(127);
+    }
+    if (pid < 0) {
+        return result;
+    }
+    int status = 0;
+    struct rusage usage;
+    std::memset(&usage, 0, sizeof(usage));
+    ::wait4(pid, &status, 0, &usage);
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    result.peakRssKb = usage.ru_maxrss;  // KiB on Linux
+
+    ReadRunSummary(dir + "/" + RUN_SUMMARY, result);
+    MeasureOutput(dir, result);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::string binary;
+    std::string outDir = "benchmark-runs";
+    std::string resultsPath = "benchmark-results.jsonl";
+    std::string selected;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (!(value = OptionValue(argv[i], "--binary")).empty()) {
+            binary = value;
+        } else if (!(value = OptionValue(argv[i], "--out-dir")).empty()) {
+            outDir = value;
+        } else if (!(value = OptionValue(argv[i], "--results")).empty()) {
+            resultsPath = value;
+        } else if (!(value = OptionValue(argv[i], "--variants")).empty()) {
+            selected = "," + value + ",";
+        } else if (!(value = OptionValue(argv[i], "--seed")).empty()) {
+            seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (binary.empty()) {
+        std::fprintf(stderr, "Usage: %s --binary=<ids_dataset> [--out-dir=DIR] [--results=FILE] [--seed=N] "
+                             "[--variants=a,b]\n", argv[0]);
+        return 1;
+    }
+
+    // The child changes into the variant directory, so the binary path must be absolute
+    char resolved[PATH_MAX];
+    if (::realpath(binary.c_str(), resolved) == nullptr || ::access(resolved, X_OK) != 0) {
+        std::fprintf(stderr, "Cannot execute %s\n", binary.c_str());
+        return 1;
+    }
+    binary = resolved;
+    ::mkdir(outDir.c_str(), 0755);
+
+    std::FILE* results = std::fopen(resultsPath.c_str(), "a");
+    if (results == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", resultsPath.c_str());
+        return 1;
+    }
+    long long timestamp = static_cast<long long>(std::time(nullptr));
+    int failures = 0;
+    for (const BenchmarkVariant& variant : Variants()) {
+        if (!selected.empty() && selected.find("," + std::string(variant.name) + ",") == std::string::npos) {
+            continue;
+        }
+        BenchmarkResult r = RunVariant(binary, outDir + "/" + variant.name, variant, seed);
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "{\"timestamp\":%lld,\"variant\":\"%s\",\"seed\":%u,\"exit\":%d,\"wall_s\":%.3f,"
+                      "\"run_wall_s\":%.3f,\"sim_s\":%.3f,\"events\":%llu,\"events_per_s\":%.0f,"
+                      "\"peak_rss_kb\":%ld,\"output_bytes\":%llu,\"output_files\":%u}\n",
+                      timestamp, variant.name, seed, r.exitCode, r.wallSeconds, r.runWallSeconds, r.simSeconds,
+                      r.events, r.eventsPerSecond, r.peakRssKb, r.outputBytes, r.outputFiles);
+        std::fputs(line, stdout);
+        std::fflush(stdout);
+        std::fputs(line, results);
+        if (r.exitCode != 0) {
+            ++failures;
+        }
+    }
+    std::fclose(results);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,356 @@
+// Capture Write Filters for the IDS Dataset Simulation
+//
+// A capture tap records every frame of its segment, and most of it is benign bulk traffic that is
+// thrown away later (the DMZ tap behind the SSH view also records the FTP transfers). A write filter
+// is evaluated on the packet's addresses, ports, protocol and attack label before the record is
+// serialized; packets that fail it are never written.
+//
+// The syntax is a subset of BPF (tcpdump) primitives plus ground-truth labels:
+//   [src|dst] host A.B.C.D           [src|dst] net A.B.C.D/LEN
+//   [tcp|udp] [src|dst] port N       [tcp|udp] [src|dst] portrange N-M
+//   tcp | udp | icmp | ip            [ip] proto N
+//   label NAME                       NAME is a label name (syn-flood, ...), benign or attack
+// combined with and/&&, or/||, not/! and parentheses, e.g.
+//   "host 10.3.1.4 and (tcp port 21 or tcp port 22)"     "label attack or udp port 53"
+// Frames that do not carry IPv4 (ARP, 802.11 management) fail every primitive except label, and
+// their label is benign. As in BPF, "and" binds tighter than "or".
+
+#ifndef IDS_CAPTURE_FILTER_H
+#define IDS_CAPTURE_FILTER_H
+
+#include "ids_attack_schedule.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Parsed write filter. An empty filter accepts every packet.
+ */
+class CaptureFilter {
+public:
+    CaptureFilter() : m_root(-1), m_usesLabels(false) {}
+
+    /**
+     * Parses a filter expression, replacing the current one. An empty text clears the filter.
+     *
+     * @param text The expression.
+     * @param error Receives a description of the first error, may be null.
+     * @return false if the expression is malformed (the filter is then empty).
+     */
+    bool Parse(const std::string& text, std::string* error = nullptr) {
+        m_nodes.clear();
+        m_root = -1;
+        m_usesLabels = false;
+        m_text = text;
+        m_tokens = Tokenize(text);
+        m_pos = 0;
+        m_error.clear();
+        if (!m_tokens.empty()) {
+            m_root = ParseOr();
+            if (m_root >= 0 && m_pos < m_tokens.size()) {
+                Fail("unexpected '" + m_tokens[m_pos] + "'");
+            }
+        }
+        if (!m_error.empty()) {
+            if (error != nullptr) {
+                *error = m_error;
+            }
+            m_nodes.clear();
+            m_root = -1;
+            m_usesLabels = false;
+            m_text.clear();
+            return false;
+        }
+        return true;
+    }
+
+    /// true if the filter accepts every packet.
+    bool IsEmpty() const { return m_root < 0; }
+
+    /// true if the filter has label primitives, so packets must be classified before filtering.
+    bool UsesLabels() const { return m_usesLabels; }
+
+    /// Expression the filter was parsed from.
+    const std::string& GetText() const { return m_text; }
+
+    /**
+     * Evaluates the filter.
+     *
+     * @param tuple Addressing fields of the packet, or nullptr if the frame does not carry IPv4.
+     * @param label AttackLabel of the packet (ATTACK_BENIGN if unknown).
+     * @return true if the packet is to be written.
+     */
+    bool Matches(const PacketTuple* tuple, uint8_t label) const {
+        return m_root < 0 || Evaluate(m_root, tuple, label);
+    }
+
+private:
+    enum NodeType : uint8_t {
+        NODE_AND,
+        NODE_OR,
+        NODE_NOT,
+        NODE_HOST,       // a = address
+        NODE_NET,        // a = network, b = mask
+        NODE_PORT,       // a = first port, b = last port
+        NODE_PROTOCOL,   // a = protocol number
+        NODE_IPV4,       // Any IPv4 packet
+        NODE_LABEL,      // a = AttackLabel, or ATTACK_LABEL_COUNT for any attack
+    };
+
+    /// Direction qualifier of host, net and port primitives.
+    enum Direction : uint8_t { DIR_ANY, DIR_SRC, DIR_DST };
+
+    struct Node {
+        NodeType type;
+        Direction direction;
+        uint8_t protocol;    // Port primitives: 6, 17 or 0 for either
+        uint32_t a;
+        uint32_t b;
+        int left;
+        int right;
+    };
+
+    static std::vector<std::string> Tokenize(const std::string& text) {
+        std::vector<std::string> tokens;
+        size_t i = 0;
+        while (i < text.size()) {
+            char c = text[i];
+            if (c == ' ' || c == '\t') {
+                ++i;
+            } else if (c == '(' || c == ')' || c == '!') {
+                tokens.push_back(std::string(1, c));
+                ++i;
+            } else if ((c == '&' || c == '|') && i + 1 < text.size() && text[i + 1] == c) {
+                tokens.push_back(c == '&' ? "and" : "or");
+                i += 2;
+            } else {
+                size_t start = i;
+                while (i < text.size() && text[i] != ' ' && text[i] != '\t' && text[i] != '(' && text[i] != ')' &&
+                       text[i] != '!' && text[i] != '&' && text[i] != '|') {
+                    ++i;
+                }
+                if (i == start) {
+                    tokens.push_back(std::string(1, text[i]));  // Lone '&' or '|', rejected by the parser
+                    ++i;
+                } else {
+                    tokens.push_back(text.substr(start, i - start));
+                }
+            }
+        }
+        return tokens;
+    }
+
+    int Fail(const std::string& message) {
+        if (m_error.empty()) {
+            m_error = message;
+        }
+        return -1;
+    }
+
+    bool Accept(const char* token) {
+        if (m_pos < m_tokens.size() && m_tokens[m_pos] == token) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    std::string Next() { return m_pos < m_tokens.size() ? m_tokens[m_pos++] : std::string(); }
+
+    int Add(NodeType type, int left = -1, int right = -1) {
+        m_nodes.push_back(Node{type, DIR_ANY, 0, 0, 0, left, right});
+        return static_cast<int>(m_nodes.size() - 1);
+    }
+
+    int ParseOr() {
+        int left = ParseAnd();
+        while (left >= 0 && Accept("or")) {
+            int right = ParseAnd();
+            left = right < 0 ? -1 : Add(NODE_OR, left, right);
+        }
+        return left;
+    }
+
+    int ParseAnd() {
+        int left = ParseNot();
+        while (left >= 0 && Accept("and")) {
+            int right = ParseNot();
+            left = right < 0 ? -1 : Add(NODE_AND, left, right);
+        }
+        return left;
+    }
+
+    int ParseNot() {
+        if (Accept("not") || Accept("!")) {
+            int operand = ParseNot();
+            return operand < 0 ? -1 : Add(NODE_NOT, operand);
+        }
+        if (Accept("(")) {
+            int inner = ParseOr();
+            if (inner >= 0 && !Accept(")")) {
+                return Fail("missing ')'");
+            }
+            return inner;
+        }
+        return ParsePrimitive();
+    }
+
+    int ParsePrimitive() {
+        uint8_t protocol = 0;
+        if (m_pos + 1 < m_tokens.size() && (m_tokens[m_pos] == "tcp" || m_tokens[m_pos] == "udp") &&
+            (m_tokens[m_pos + 1] == "src" || m_tokens[m_pos + 1] == "dst" || m_tokens[m_pos + 1] == "port" ||
+             m_tokens[m_pos + 1] == "portrange")) {
+            protocol = (Next() == "tcp") ? 6 : 17;
+        }
+        Direction direction = DIR_ANY;
+        if (Accept("src")) {
+            direction = DIR_SRC;
+        } else if (Accept("dst")) {
+            direction = DIR_DST;
+        }
+        std::string keyword = Next();
+        if (keyword.empty()) {
+            return Fail("expression ends early");
+        }
+        if (protocol != 0 && keyword != "port" && keyword != "portrange") {
+            return Fail("expected port after protocol");
+        }
+        int node = -1;
+        if (keyword == "host") {
+            uint32_t address;
+            std::string value = Next();
+            if (!AttackSchedule::ParseAddress(value.c_str(), address)) {
+                return Fail("invalid host '" + value + "'");
+            }
+            node = Add(NODE_HOST);
+            m_nodes[node].a = address;
+        } else if (keyword == "net") {
+            std::string value = Next();
+            size_t slash = value.find('/');
+            uint32_t address;
+            unsigned long bits = 32;
+            bool valid = true;
+            if (slash != std::string::npos) {
+                char* end = nullptr;
+                bits = std::strtoul(value.c_str() + slash + 1, &end, 10);
+                valid = slash + 1 < value.size() && *end == '\0' && bits <= 32;
+            }
+            if (!valid || !AttackSchedule::ParseAddress(value.substr(0, slash).c_str(), address)) {
+                return Fail("invalid net '" + value + "'");
+            }
+            node = Add(NODE_NET);
+            m_nodes[node].b = (bits == 0) ? 0 : ~uint32_t(0) << (32 - bits);
+            m_nodes[node].a = address & m_nodes[node].b;
+        } else if (keyword == "port" || keyword == "portrange") {
+            std::string value = Next();
+            char* end = nullptr;
+            unsigned long first = std::strtoul(value.c_str(), &end, 10);
+            unsigned long last = first;
+            if (keyword == "portrange" && end != value.c_str() && *end == '-') {
+                last = std::strtoul(end + 1, &end, 10);
+            } else if (keyword == "portrange") {
+                return Fail("invalid portrange '" + value + "'");
+            }
+            if (value.empty() || *end != '\0' || first > last || last > 65535) {
+                return Fail("invalid port '" + value + "'");
+            }
+            node = Add(NODE_PORT);
+            m_nodes[node].protocol = protocol;
+            m_nodes[node].a = static_cast<uint32_t>(first);
+            m_nodes[node].b = static_cast<uint32_t>(last);
+        } else if (direction != DIR_ANY) {
+            return Fail("expected host, net or port after src/dst");
+        } else if (keyword == "tcp" || keyword == "udp" || keyword == "icmp") {
+            node = Add(NODE_PROTOCOL);
+            m_nodes[node].a = (keyword == "tcp") ? 6 : (keyword == "udp") ? 17 : 1;
+        } else if (keyword == "ip" || keyword == "proto") {
+            if (keyword == "ip" && !Accept("proto")) {
+                return Add(NODE_IPV4);
+            }
+            std::string value = Next();
+            char* end = nullptr;
+            unsigned long number = std::strtoul(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || number > 255) {
+                return Fail("invalid protocol '" + value + "'");
+            }
+            node = Add(NODE_PROTOCOL);
+            m_nodes[node].a = static_cast<uint32_t>(number);
+        } else if (keyword == "label") {
+            std::string value = Next();
+            uint32_t label = ATTACK_LABEL_COUNT + 1;
+            if (value == "attack") {
+                label = ATTACK_LABEL_COUNT;
+            }
+            for (uint32_t l = 0; l < ATTACK_LABEL_COUNT && label > ATTACK_LABEL_COUNT; ++l) {
+                if (value == AttackLabelName(static_cast<uint8_t>(l))) {
+                    label = l;
+                }
+            }
+            if (label > ATTACK_LABEL_COUNT) {
+                return Fail("unknown label '" + value + "'");
+            }
+            node = Add(NODE_LABEL);
+            m_nodes[node].a = label;
+            m_usesLabels = true;
+        } else {
+            return Fail("unknown primitive '" + keyword + "'");
+        }
+        m_nodes[node].direction = direction;
+        return node;
+    }
+
+    bool Evaluate(int index, const PacketTuple* t, uint8_t label) const {
+        const Node& n = m_nodes[index];
+        switch (n.type) {
+            case NODE_AND:
+                return Evaluate(n.left, t, label) && Evaluate(n.right, t, label);
+            case NODE_OR:
+                return Evaluate(n.left, t, label) || Evaluate(n.right, t, label);
+            case NODE_NOT:
+                return !Evaluate(n.left, t, label);
+            case NODE_LABEL:
+                return n.a == ATTACK_LABEL_COUNT ? label != ATTACK_BENIGN : label == n.a;
+            default:
+                break;
+        }
+        if (t == nullptr) {
+            return false;
+        }
+        switch (n.type) {
+            case NODE_HOST:
+                return (n.direction != DIR_DST && t->src == n.a) || (n.direction != DIR_SRC && t->dst == n.a);
+            case NODE_NET:
+                return (n.direction != DIR_DST && (t->src & n.b) == n.a) ||
+                       (n.direction != DIR_SRC && (t->dst & n.b) == n.a);
+            case NODE_PORT:
+                if ((n.protocol != 0 && t->protocol != n.protocol) || (t->protocol != 6 && t->protocol != 17)) {
+                    return false;
+                }
+                return (n.direction != DIR_DST && t->srcPort >= n.a && t->srcPort <= n.b) ||
+                       (n.direction != DIR_SRC && t->dstPort >= n.a && t->dstPort <= n.b);
+            case NODE_PROTOCOL:
+                return t->protocol == n.a;
+            case NODE_IPV4:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::vector<Node> m_nodes;
+    int m_root;                       // Index of the root node, -1 for the empty filter
+    bool m_usesLabels;
+    std::string m_text;
+    // Parser state
+    std::vector<std::string> m_tokens;
+    size_t m_pos;
+    std::string m_error;
+};
+
+} // namespace ns3
+
+#endif // IDS_CAPTURE_FILTER_H
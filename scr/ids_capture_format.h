@@ -0,0 +1,118 @@
+// Capture File Formats for the IDS Dataset Simulation
+//
+// Link types, pcap and pcapng structures and the link-layer parsing shared by the capture manager
+// (ids_capture_manager.h), which writes the files during the run, and the offline capture splitter
+// (ids_capture_splitter.cc), which reads them back. Only depends on the C++ standard library, so
+// offline tools can include it without ns-3.
+
+#ifndef IDS_CAPTURE_FORMAT_H
+#define IDS_CAPTURE_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ns3 {
+
+constexpr uint32_t CAPTURE_LINKTYPE_ETHERNET = 1;   // DLT_EN10MB, CSMA devices
+constexpr uint32_t CAPTURE_LINKTYPE_PPP = 9;        // DLT_PPP, point-to-point devices
+constexpr uint32_t CAPTURE_LINKTYPE_80211 = 105;    // DLT_IEEE802_11, Wi-Fi devices
+constexpr uint32_t CAPTURE_SNAPLEN = 65535;         // Default bytes kept per packet (full packets)
+constexpr uint32_t CAPTURE_LABEL_BYTES = 128;       // Bytes read per packet to find its label
+
+/// Capture file format.
+enum CaptureFormat : uint8_t {
+    CAPTURE_FORMAT_PCAP = 0,    // libpcap, no labels
+    CAPTURE_FORMAT_PCAPNG       // pcapng with label options in every EPB
+};
+
+constexpr uint32_t PCAPNG_BLOCK_SHB = 0x0a0d0d0a;    // Section Header Block
+constexpr uint32_t PCAPNG_BLOCK_IDB = 1;             // Interface Description Block
+constexpr uint32_t PCAPNG_BLOCK_EPB = 6;             // Enhanced Packet Block
+constexpr uint16_t PCAPNG_OPT_END = 0;               // opt_endofopt
+constexpr uint16_t PCAPNG_OPT_COMMENT = 1;           // opt_comment
+constexpr uint16_t PCAPNG_OPT_SHB_USERAPPL = 4;      // shb_userappl
+constexpr uint16_t PCAPNG_OPT_IF_NAME = 2;           // if_name
+constexpr uint16_t PCAPNG_OPT_IF_DESCRIPTION = 3;    // if_description
+constexpr uint16_t PCAPNG_OPT_IF_TSRESOL = 9;        // if_tsresol
+constexpr uint16_t PCAPNG_OPT_CUSTOM_BINARY = 2989;  // Custom binary option, copied when a file is rewritten
+constexpr uint32_t PCAPNG_LABEL_PEN = 32473;         // Enterprise number of the label option (RFC 5612)
+
+/**
+ * Finds the IPv4 header inside a captured link-layer frame.
+ *
+ * @param linkType CAPTURE_LINKTYPE_* of the frame.
+ * @param frame The frame bytes.
+ * @param length Number of bytes captured.
+ * @param ipLength Receives the number of bytes from the IPv4 header to the end of the capture.
+ * @return The IPv4 header, or nullptr if the frame does not carry IPv4.
+ */
+inline const uint8_t* FindIpv4Header(uint32_t linkType, const uint8_t* frame, size_t length, size_t& ipLength) {
+    size_t offset = 0;
+    if (linkType == CAPTURE_LINKTYPE_PPP) {
+        // 2-byte PPP protocol field, 0x0021 for IPv4
+        if (length < 2 || frame[0] != 0x00 || frame[1] != 0x21) {
+            return nullptr;
+        }
+        offset = 2;
+    } else if (linkType == CAPTURE_LINKTYPE_ETHERNET) {
+        // DIX type field, or a length field followed by an LLC/SNAP header carrying the type
+        if (length < 14) {
+            return nullptr;
+        }
+        uint16_t type = static_cast<uint16_t>((frame[12] << 8) | frame[13]);
+        offset = 14;
+        if (type <= 1500 && length >= 22 && frame[14] == 0xaa && frame[15] == 0xaa) {
+            type = static_cast<uint16_t>((frame[20] << 8) | frame[21]);
+            offset = 22;
+        }
+        if (type != 0x0800) {
+            return nullptr;
+        }
+    } else if (linkType == CAPTURE_LINKTYPE_80211) {
+        // Data frames only: 24-byte MAC header, +6 with four addresses, +2 for QoS data, then LLC/SNAP
+        if (length < 24 || ((frame[0] >> 2) & 0x3) != 2) {
+            return nullptr;
+        }
+        offset = 24;
+        if ((frame[1] & 0x3) == 0x3) {
+            offset += 6;
+        }
+        if (frame[0] & 0x80) {
+            offset += 2;
+        }
+        if (length < offset + 8 || frame[offset] != 0xaa || frame[offset + 1] != 0xaa ||
+            frame[offset + 6] != 0x08 || frame[offset + 7] != 0x00) {
+            return nullptr;
+        }
+        offset += 8;
+    } else {
+        return nullptr;
+    }
+    ipLength = length - offset;
+    return frame + offset;
+}
+
+/// libpcap file header.
+struct PcapFileHeader {
+    uint32_t magic;          // 0xa1b2c3d4, microsecond timestamps
+    uint16_t versionMajor;   // 2
+    uint16_t versionMinor;   // 4
+    int32_t thisZone;        // GMT offset, always 0
+    uint32_t sigFigs;        // Always 0
+    uint32_t snapLen;        // Maximum bytes per record
+    uint32_t linkType;       // CAPTURE_LINKTYPE_*
+};
+static_assert(sizeof(PcapFileHeader) == 24, "PcapFileHeader must stay 24 bytes");
+
+/// libpcap record header.
+struct PcapRecordHeader {
+    uint32_t tsSec;          // Seconds
+    uint32_t tsUsec;         // Microseconds
+    uint32_t inclLen;        // Bytes stored
+    uint32_t origLen;        // Bytes on the wire
+};
+static_assert(sizeof(PcapRecordHeader) == 16, "PcapRecordHeader must stay 16 bytes");
+
+} // namespace ns3
+
+#endif // IDS_CAPTURE_FORMAT_H
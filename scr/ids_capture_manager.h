@@ -0,0 +1,821 @@
+// Deduplicated Capture Manager for the IDS Dataset Simulation
+//
+// The capture section of ids_dataset.cc used to call EnablePcap once per monitoring point. Several
+// points share a physical segment (both ends of a point-to-point link, every promiscuous device on
+// a CSMA bus, and twice the same FTP/SSH server device), so each packet was serialized and written
+// once per point. The capture manager registers each physical segment once:
+//
+// - A tap is one capture file per segment. Point-to-point and CSMA devices are keyed by their
+//   channel (a promiscuous sniffer on any device of the channel sees every frame); Wi-Fi devices
+//   are keyed by the device, since a station only hears part of the medium.
+// - A view is a named monitoring point on a tap ("ssh-server-traffic") with an optional BPF filter
+//   expression ("host 10.3.1.4 and tcp port 22"). Views are written to capture-index.csv, so a
+//   consumer can extract one with e.g. tcpdump -r <file> '<filter>'.
+//
+// The first view registered on a segment names the tap file, <view>-<node>-<device>.pcap, in the
+// same form as the ns-3 helpers. Files use the link type of the device: PPP for point-to-point,
+// Ethernet for CSMA and 802.11 for Wi-Fi.
+//
+// Records are serialized directly into the buffers of the AsyncOutputWriter (one reserved span per
+// record, filled with one packet copy), and the writer thread writes the batches. Memory is bounded
+// by the writer's buffer pool; when it is exhausted the simulator either waits for the writer
+// (block, the default) or drops the record (drop). Dropped records never leave a partial record in
+// the file; they are counted per tap and per shard.
+//
+// Two file formats are supported:
+// - pcap: classic libpcap with microsecond timestamps and no labels.
+// - pcapng: a Section Header Block, one Interface Description Block for the tap (if_name is the tap,
+//   if_description lists its views and filters, nanosecond timestamps) and one Enhanced Packet Block
+//   per packet. Every EPB carries the ground-truth label from the AttackSchedule in a custom binary
+//   option (code 2989, PEN 32473) holding the attack instance (uint32, the row of the window in
+//   attack-schedule.csv, 0 = benign) and the AttackLabel (uint8), both little-endian, padded to 8
+//   bytes. Attack packets also get an opt_comment "<label> #<instance>" that Wireshark shows as
+//   frame.comment. Packets are labelled from their AttackTag (see ids_attack_tag.h) or, with tag
+//   labels disabled, with the same window match as the columnar exporter.
+//
+// Taps can be given a write filter (see ids_capture_filter.h) on addresses, ports, protocol and
+// attack label, e.g. to keep only the FTP control and SSH traffic of the DMZ tap. The filter runs
+// on the first bytes of the packet before the record is serialized, so rejected packets cost
+// neither buffer space nor output; they are counted per tap. A write filter changes the contents of
+// every view on the tap, so it is set by tap name; a view name is only accepted for a view that has
+// its tap to itself.
+//
+// A label index (see ids_label_index.h) can be written next to the captures: one time-sorted
+// record per IPv4 packet written, with its flow hash, label, capture file and record offset, so
+// labels can be joined onto packets and flows without reading the captures again.
+//
+// The snaplen can be lowered for all taps or per tap (header-only capture, e.g. 96 bytes). Records
+// keep the original length, so packet counts and sizes stay exact; labels are still taken from the
+// first CAPTURE_LABEL_BYTES of the packet when the snaplen is shorter.
+//
+// Captures can be rotated into time shards: every rotation interval of simulated time and, optionally,
+// at the start and stop of every attack window, each tap closes its file and continues in the next
+// shard, <tap>-s<NNNN>.pcap. The shard manifest lists every shard with its time range, its packets
+// and the attack instances whose windows overlap it, so a consumer opens only the shards it needs
+// (e.g. the XSS window) and can process shards in parallel. Without rotation the index lists the
+// file of each view; with rotation it lists the shard pattern <tap>-s*.pcap.
+//
+// Index format (write_filter: the filter of the view's tap, empty if the tap keeps every packet):
+//   view,file,node,device,link_type,snaplen,filter,write_filter
+// Manifest format (attacks: space-separated <label>#<instance> of the overlapping windows):
+//   tap,shard,file,start_s,end_s,packets,attack_packets,dropped,attacks
+
+#ifndef IDS_CAPTURE_MANAGER_H
+#define IDS_CAPTURE_MANAGER_H
+
+#include "ns3/csma-net-device.h"
+#include "ns3/fatal-error.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy-state-helper.h"
+#include "ns3/wifi-phy.h"
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+#include "ids_attack_tag.h"
+#include "ids_capture_filter.h"
+#include "ids_capture_format.h"
+#include "ids_label_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Owns the physical capture taps and the logical views registered on them.
+ */
+class CaptureManager {
+public:
+    CaptureManager()
+        : m_format(CAPTURE_FORMAT_PCAP), m_schedule(nullptr), m_snapLen(CAPTURE_SNAPLEN),
+          m_compression(OUTPUT_COMPRESSION_NONE), m_overflow(OUTPUT_OVERFLOW_BLOCK), m_tagLabels(false),
+          m_labelIndex(nullptr), m_writer(nullptr), m_rotationInterval(0.0), m_rotateOnAttacks(false),
+          m_openFailures(0) {}
+
+    ~CaptureManager() { Close(); }
+
+    CaptureManager(const CaptureManager&) = delete;
+    CaptureManager& operator=(const CaptureManager&) = delete;
+
+    /**
+     * Registers a monitoring point. The first view on a segment creates its tap and names the file;
+     * later views on the same segment only add an index entry.
+     *
+     * @param name View name, e.g. "ftp-server-traffic".
+     * @param device Any device on the segment to capture.
+     * @param filter BPF expression selecting the view's packets, empty for the whole segment.
+     * @return false if the device type cannot be captured (e.g. loopback).
+     */
+    bool AddView(const std::string& name, Ptr<NetDevice> device, const std::string& filter = "") {
+        uint32_t linkType;
+        Ptr<Object> segment;
+        if (DynamicCast<PointToPointNetDevice>(device)) {
+            linkType = CAPTURE_LINKTYPE_PPP;
+            segment = device->GetChannel();
+        } else if (DynamicCast<CsmaNetDevice>(device)) {
+            linkType = CAPTURE_LINKTYPE_ETHERNET;
+            segment = device->GetChannel();
+        } else if (DynamicCast<WifiNetDevice>(device)) {
+            linkType = CAPTURE_LINKTYPE_80211;
+            segment = device;
+        } else {
+            return false;
+        }
+
+        uint32_t tap = 0;
+        while (tap < m_taps.size() && m_taps[tap].segment != segment) {
+            ++tap;
+        }
+        if (tap == m_taps.size()) {
+            Tap t;
+            t.segment = segment;
+            t.device = device;
+            t.linkType = linkType;
+            t.name = name + "-" + std::to_string(device->GetNode()->GetId()) + "-" +
+                     std::to_string(device->GetIfIndex());
+            t.path = t.name + ".pcap";
+            m_taps.push_back(t);
+        }
+        m_views.push_back(View{name, filter, tap});
+        return true;
+    }
+
+    /**
+     * Sets the snaplen of all taps without a snaplen of their own. Call before Open.
+     *
+     * @param snapLen Bytes kept per packet, 0 for full packets.
+     */
+    void SetSnapLen(uint32_t snapLen) { m_snapLen = (snapLen == 0) ? CAPTURE_SNAPLEN : snapLen; }
+
+    /**
+     * Sets the snaplen of individual taps from a list of view=bytes pairs, e.g.
+     * "wifi-ap-traffic=256,vpn-server-traffic=0". The snaplen applies to the tap holding the view,
+     * and 0 keeps full packets. Call before Open.
+     *
+     * @param spec Comma-separated view=bytes pairs.
+     * @return false if an entry is malformed or names an unknown view.
+     */
+    bool SetSnapLens(const std::string& spec) {
+        size_t start = 0;
+        while (start < spec.size()) {
+            size_t end = spec.find(',', start);
+            if (end == std::string::npos) {
+                end = spec.size();
+            }
+            std::string entry = spec.substr(start, end - start);
+            size_t equals = entry.find('=');
+            if (equals == std::string::npos || equals + 1 == entry.size()) {
+                return false;
+            }
+            std::string name = entry.substr(0, equals);
+            char* last = nullptr;
+            unsigned long snapLen = std::strtoul(entry.c_str() + equals + 1, &last, 10);
+            if (*last != '\0') {
+                return false;
+            }
+            bool found = false;
+            for (const View& view : m_views) {
+                if (view.name == name) {
+                    m_taps[view.tap].snapLen = (snapLen == 0 || snapLen > CAPTURE_SNAPLEN)
+                                                   ? CAPTURE_SNAPLEN : static_cast<uint32_t>(snapLen);
+                    found = true;
+                }
+            }
+            if (!found) {
+                return false;
+            }
+            start = end + 1;
+        }
+        return true;
+    }
+
+    /**
+     * Sets tap write filters from a list of tap=expression pairs separated by ';', e.g.
+     * "http-https-server-traffic-N-1=host 10.3.1.4 and (tcp port 21 or tcp port 22);wifi-ap-traffic=
+     * label attack". An entry names a tap (its file name without shard suffix and extension, as in
+     * the capture index) or a view that is the only view on its tap; naming a view that shares its
+     * tap is an error, since the filter would also drop packets of the other views. A tap named by
+     * several entries keeps the packets that match any of them. Call before Open.
+     *
+     * @param spec Semicolon-separated tap=expression pairs.
+     * @param error Receives a description of the first error, may be null.
+     * @return false if an entry names an unknown tap, a shared view, or its expression is malformed.
+     */
+    bool SetWriteFilters(const std::string& spec, std::string* error = nullptr) {
+        std::vector<std::string> expressions(m_taps.size());
+        size_t start = 0;
+        while (start < spec.size()) {
+            size_t end = spec.find(';', start);
+            if (end == std::string::npos) {
+                end = spec.size();
+            }
+            std::string entry = spec.substr(start, end - start);
+            start = end + 1;
+            if (entry.find_first_not_of(' ') == std::string::npos) {
+                continue;
+            }
+            size_t equals = entry.find('=');
+            std::string name = Trim(entry.substr(0, equals));
+            std::string expression = (equals == std::string::npos) ? "" : Trim(entry.substr(equals + 1));
+            uint32_t tap = 0;
+            while (tap < m_taps.size() && m_taps[tap].name != name) {
+                ++tap;
+            }
+            std::string shared;
+            for (const View& v : m_views) {
+                if (v.name == name) {
+                    tap = v.tap;
+                }
+            }
+            for (const View& v : m_views) {
+                if (tap < m_taps.size() && v.tap == tap && v.name != name && name != m_taps[tap].name) {
+                    shared += (shared.empty() ? "" : ", ") + v.name;
+                }
+            }
+            CaptureFilter check;
+            std::string message;
+            if (equals == std::string::npos || tap == m_taps.size()) {
+                message = "unknown tap or view '" + name + "'";
+            } else if (!shared.empty()) {
+                message = "view " + name + " shares tap " + m_taps[tap].name + " with " + shared +
+                          "; name the tap to filter all of them";
+            } else if (!check.Parse(expression, &message) || check.IsEmpty()) {
+                message = name + ": " + (message.empty() ? "empty filter" : message);
+            } else {
+                std::string& combined = expressions[tap];
+                combined += (combined.empty() ? "(" : " or (") + expression + ")";
+                continue;
+            }
+            if (error != nullptr) {
+                *error = message;
+            }
+            return false;
+        }
+        for (size_t i = 0; i < m_taps.size(); ++i) {
+            m_taps[i].filter.Parse(expressions[i]);
+        }
+        return true;
+    }
+
+    /**
+     * Compresses the capture files on the writer thread (file names get the suffix .lz4). Call
+     * before Open.
+     *
+     * @param compression Compression of all capture files.
+     */
+    void SetCompression(OutputCompression compression) { m_compression = compression; }
+
+    /**
+     * Sets what happens to a packet when the output writer has no free buffer. Call before Open.
+     *
+     * @param overflow Block the simulation until a buffer is free, or drop the packet.
+     */
+    void SetOverflow(OutputOverflow overflow) { m_overflow = overflow; }
+
+    /**
+     * Selects where packet labels come from. Call before Open.
+     *
+     * @param tags Read the AttackTag of each packet (untagged packets are benign) instead of
+     *             matching the packet against the windows of the schedule.
+     */
+    void SetTagLabels(bool tags) { m_tagLabels = tags; }
+
+    /**
+     * Records every IPv4 packet written (or every attack packet, depending on the index) in a
+     * label index. Call before Open; the index must stay open until Close.
+     *
+     * @param index The open label index, or nullptr for none.
+     */
+    void SetLabelIndex(LabelIndexWriter* index) { m_labelIndex = index; }
+
+    /**
+     * Enables time-sharded files. Call before Open; boundaries are taken from the schedule passed
+     * to Open.
+     *
+     * @param interval Simulated seconds per shard, 0 for no periodic rotation.
+     * @param attackBoundaries Also rotate at the start and stop of every attack window.
+     */
+    void SetRotation(double interval, bool attackBoundaries) {
+        m_rotationInterval = interval;
+        m_rotateOnAttacks = attackBoundaries;
+    }
+
+    /**
+     * Creates one file per tap, writes the file headers and connects the device traces.
+     *
+     * @param writer The output writer that creates and writes the capture files.
+     * @param format File format of all taps.
+     * @param schedule Attack schedule labelling pcapng packets and placing attack shard boundaries,
+     *                 or nullptr.
+     * @param stopTime Simulated second at which the run stops; no shards start after it.
+     * @return false if a file cannot be created.
+     */
+    bool Open(AsyncOutputWriter& writer, CaptureFormat format, const AttackSchedule* schedule, double stopTime) {
+        m_writer = &writer;
+        m_format = format;
+        m_schedule = schedule;
+        for (uint32_t i = 0; i < m_taps.size(); ++i) {
+            Tap& tap = m_taps[i];
+            if (tap.snapLen == 0) {
+                tap.snapLen = m_snapLen;
+            }
+            if (!OpenShard(i)) {
+                return false;
+            }
+
+            if (tap.linkType == CAPTURE_LINKTYPE_80211) {
+                Ptr<WifiPhyStateHelper> state = DynamicCast<WifiNetDevice>(tap.device)->GetPhy()->GetState();
+                state->TraceConnectWithoutContext("Tx", MakeBoundCallback(&CaptureManager::OnWifiTx, this, i));
+                state->TraceConnectWithoutContext("RxOk", MakeBoundCallback(&CaptureManager::OnWifiRx, this, i));
+            } else {
+                tap.device->TraceConnectWithoutContext("PromiscSniffer",
+                                                       MakeBoundCallback(&CaptureManager::OnPacket, this, i));
+            }
+        }
+        ScheduleRotations(stopTime);
+        return true;
+    }
+
+    /// Closes the current shard of every tap.
+    void Close() {
+        double now = Simulator::Now().GetSeconds();
+        for (uint32_t i = 0; i < m_taps.size(); ++i) {
+            CloseShard(i, now);
+        }
+    }
+
+    /// Number of files written so far (one per tap without rotation).
+    size_t GetShardCount() const { return m_shards.size(); }
+
+    /**
+     * Writes the shard manifest and closes the file. Call after Close.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @return false if the file is invalid.
+     */
+    bool WriteManifest(AsyncOutputFile* file) const {
+        if (file == nullptr) {
+            return false;
+        }
+        std::string out = "tap,shard,file,start_s,end_s,packets,attack_packets,dropped,attacks\n";
+        char line[128];
+        for (const Shard& shard : m_shards) {
+            std::snprintf(line, sizeof(line), ",%u,", shard.index);
+            out += m_taps[shard.tap].name + line + shard.path;
+            std::snprintf(line, sizeof(line), ",%.6f,%.6f,%llu,%llu,%llu,", shard.start, shard.end,
+                          static_cast<unsigned long long>(shard.packets),
+                          static_cast<unsigned long long>(shard.attackPackets),
+                          static_cast<unsigned long long>(shard.dropped));
+            out += line;
+            if (m_schedule != nullptr) {
+                const std::vector<AttackWindow>& windows = m_schedule->GetWindows();
+                bool first = true;
+                for (size_t w = 0; w < windows.size(); ++w) {
+                    // A shard holds [start, end) (a rotation runs before the packets of its time), and
+                    // windows are closed, so a packet at a window's stop can open the next shard
+                    if (windows[w].start < shard.end && windows[w].stop >= shard.start) {
+                        std::snprintf(line, sizeof(line), "%s%s#%zu", first ? "" : " ", AttackLabelName(windows[w].label),
+                                      w + 1);
+                        out += line;
+                        first = false;
+                    }
+                }
+            }
+            out += '\n';
+        }
+        file->Write(out.data(), out.size());
+        file->Close();
+        return true;
+    }
+
+    /**
+     * Writes the view index and closes the file.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @return false if the file is invalid.
+     */
+    bool WriteIndex(AsyncOutputFile* file) const {
+        if (file == nullptr) {
+            return false;
+        }
+        std::string out = "view,file,node,device,link_type,snaplen,filter,write_filter\n";
+        for (const View& view : m_views) {
+            const Tap& tap = m_taps[view.tap];
+            std::string path = tap.name + (Rotating() ? "-s*" : "") + Extension();
+            out += view.name + "," + path + "," + std::to_string(tap.device->GetNode()->GetId()) + "," +
+                   std::to_string(tap.device->GetIfIndex()) + "," + std::to_string(tap.linkType) + "," +
+                   std::to_string(tap.snapLen) + "," + view.filter + "," + tap.filter.GetText() + "\n";
+        }
+        file->Write(out.data(), out.size());
+        file->Close();
+        return true;
+    }
+
+    /**
+     * Writes the number of views and taps and the packets written per tap.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        os << "Capture: " << m_views.size() << " views on " << m_taps.size() << " taps, " << m_shards.size()
+           << " files";
+        if (m_openFailures > 0) {
+            os << ", " << m_openFailures << " shards could not be opened";
+        }
+        os << std::endl;
+        for (const Tap& tap : m_taps) {
+            uint32_t views = 0;
+            for (const View& view : m_views) {
+                views += (&m_taps[view.tap] == &tap) ? 1 : 0;
+            }
+            os << "  " << tap.name << ": " << tap.packets << " packets, " << tap.bytes << " bytes ("
+               << tap.storedBytes << " stored, snaplen " << tap.snapLen << "), " << views << " views";
+            if (m_format == CAPTURE_FORMAT_PCAPNG) {
+                os << ", " << tap.attackPackets << " attack-labelled";
+            }
+            if (!tap.filter.IsEmpty()) {
+                os << ", " << tap.filtered << " filtered out";
+            }
+            if (tap.dropped > 0) {
+                os << ", " << tap.dropped << " dropped on overflow";
+            }
+            os << std::endl;
+        }
+    }
+
+private:
+    /// One physical capture point and its file.
+    struct Tap {
+        Ptr<Object> segment;              // Channel (point-to-point, CSMA) or device (Wi-Fi)
+        Ptr<NetDevice> device;            // Device whose traces are captured
+        uint32_t linkType = 0;            // CAPTURE_LINKTYPE_*
+        uint32_t snapLen = 0;             // Bytes kept per packet, 0 until Open applies the default
+        std::string name;                 // File name without extension, pcapng if_name
+        std::string path;                 // Capture file
+        AsyncOutputFile* file = nullptr;
+        uint64_t packets = 0;
+        uint64_t bytes = 0;               // Original packet bytes
+        uint64_t storedBytes = 0;         // Packet bytes written after the snaplen
+        uint64_t attackPackets = 0;       // pcapng packets labelled with an attack
+        uint32_t shards = 0;              // Shards opened so far
+        double shardStart = 0.0;          // Start of the current shard (seconds)
+        uint64_t shardPackets = 0;        // Packets in the current shard
+        uint64_t shardAttackPackets = 0;  // Attack-labelled packets in the current shard
+        uint64_t dropped = 0;             // Packets dropped on writer overflow
+        uint64_t shardDropped = 0;        // Packets dropped in the current shard
+        CaptureFilter filter;             // Write filter, empty to keep every packet
+        uint64_t filtered = 0;            // Packets rejected by the write filter
+        uint16_t indexFile = 0;           // Label index file ID of the current shard
+    };
+
+    /// One closed capture file.
+    struct Shard {
+        uint32_t tap;                     // Index into m_taps
+        uint32_t index;                   // Shard number within the tap
+        std::string path;
+        double start;                     // Seconds
+        double end;                       // Seconds
+        uint64_t packets;
+        uint64_t attackPackets;
+        uint64_t dropped;
+    };
+
+    /// One named monitoring point on a tap.
+    struct View {
+        std::string name;
+        std::string filter;               // BPF expression, empty for the whole tap
+        uint32_t tap;                     // Index into m_taps
+    };
+
+    /// Filters, labels and writes one packet seen by a tap.
+    void Write(uint32_t index, Ptr<const Packet> packet) {
+        Tap& tap = m_taps[index];
+        if (tap.file == nullptr) {
+            return;
+        }
+        int64_t ns = Simulator::Now().GetNanoSeconds();
+        bool pcapng = (m_format == CAPTURE_FORMAT_PCAPNG);
+        if (!pcapng && tap.filter.IsEmpty() && m_labelIndex == nullptr) {
+            WritePcapRecord(tap, ns, packet);
+            return;
+        }
+
+        // Label and filter from the first bytes of the packet, before anything is serialized
+        uint8_t head[CAPTURE_LABEL_BYTES];
+        uint32_t headLength = packet->CopyData(head, CAPTURE_LABEL_BYTES);
+        size_t ipLength = 0;
+        PacketTuple t;
+        const uint8_t* ip = FindIpv4Header(tap.linkType, head, headLength, ipLength);
+        bool ipv4 = ip != nullptr && ParseIpv4Tuple(ip, ipLength, t);
+        uint32_t instance = 0;
+        uint8_t label = ATTACK_BENIGN;
+        bool labelled = pcapng || tap.filter.UsesLabels() || m_labelIndex != nullptr;
+        if (labelled && m_tagLabels) {
+            ReadAttackTag(packet, instance, label);
+        } else if (labelled && ipv4 && m_schedule != nullptr) {
+            instance = m_schedule->Match(ns / 1e9, t.src, t.dst, t.protocol, t.srcPort, t.dstPort);
+            label = m_schedule->InstanceLabel(instance);
+        }
+        if (!tap.filter.Matches(ipv4 ? &t : nullptr, label)) {
+            ++tap.filtered;
+            return;
+        }
+        uint64_t offset = tap.file->GetBytesWritten();
+        bool written =
+            pcapng ? WriteEnhancedPacket(tap, ns, packet, instance, label) : WritePcapRecord(tap, ns, packet);
+        if (written && ipv4 && m_labelIndex != nullptr) {
+            m_labelIndex->Record(ns, t, instance, label, tap.indexFile, offset);
+        }
+    }
+
+    /// Writes one packet as a libpcap record; false if it was dropped on overflow.
+    bool WritePcapRecord(Tap& tap, int64_t ns, Ptr<const Packet> packet) {
+        uint32_t size = packet->GetSize();
+        PcapRecordHeader record;
+        record.tsSec = static_cast<uint32_t>(ns / 1000000000);
+        record.tsUsec = static_cast<uint32_t>((ns % 1000000000) / 1000);
+        record.inclLen = std::min(size, tap.snapLen);
+        record.origLen = size;
+        char* out = tap.file->Reserve(sizeof(record) + record.inclLen);
+        if (out == nullptr) {
+            ++tap.dropped;
+            ++tap.shardDropped;
+            return false;
+        }
+        std::memcpy(out, &record, sizeof(record));
+        packet->CopyData(reinterpret_cast<uint8_t*>(out + sizeof(record)), record.inclLen);
+        ++tap.packets;
+        ++tap.shardPackets;
+        tap.bytes += size;
+        tap.storedBytes += record.inclLen;
+        return true;
+    }
+
+    static std::string Trim(const std::string& text) {
+        size_t first = text.find_first_not_of(' ');
+        return (first == std::string::npos) ? "" : text.substr(first, text.find_last_not_of(' ') - first + 1);
+    }
+
+    bool Rotating() const { return m_rotationInterval > 0.0 || m_rotateOnAttacks; }
+
+    std::string Extension() const {
+        return std::string(m_format == CAPTURE_FORMAT_PCAPNG ? ".pcapng" : ".pcap") +
+               (m_compression == OUTPUT_COMPRESSION_LZ4 ? ".lz4" : "");
+    }
+
+    /// Opens the next file of a tap and writes its headers.
+    bool OpenShard(uint32_t index) {
+        Tap& tap = m_taps[index];
+        tap.path = tap.name;
+        if (Rotating()) {
+            char suffix[16];
+            std::snprintf(suffix, sizeof(suffix), "-s%04u", tap.shards);
+            tap.path += suffix;
+        }
+        tap.path += (m_format == CAPTURE_FORMAT_PCAPNG) ? ".pcapng" : ".pcap";
+        tap.shardStart = Simulator::Now().GetSeconds();
+        tap.shardPackets = 0;
+        tap.shardAttackPackets = 0;
+        tap.shardDropped = 0;
+        ++tap.shards;
+        tap.file = m_writer->Open(tap.path, false, m_compression);
+        if (tap.file == nullptr) {
+            ++m_openFailures;
+            return false;
+        }
+        tap.file->SetOverflow(m_overflow);
+        tap.path = tap.file->GetPath();
+        if (m_labelIndex != nullptr && !m_labelIndex->AddFile(tap.path, tap.indexFile)) {
+            NS_FATAL_ERROR("Label index holds at most " << LABEL_INDEX_MAX_FILES << " capture files, cannot add "
+                           << tap.path << "; use a longer capture-rotate interval");
+        }
+        if (m_format == CAPTURE_FORMAT_PCAPNG) {
+            WritePcapngHeader(index);
+        } else {
+            PcapFileHeader header = {0xa1b2c3d4, 2, 4, 0, 0, tap.snapLen, tap.linkType};
+            tap.file->Write(&header, sizeof(header));
+        }
+        return true;
+    }
+
+    /// Closes the current file of a tap and records it in the manifest.
+    void CloseShard(uint32_t index, double now) {
+        Tap& tap = m_taps[index];
+        if (tap.file == nullptr) {
+            return;
+        }
+        tap.file->Close();
+        tap.file = nullptr;
+        m_shards.push_back(Shard{index, tap.shards - 1, tap.path, tap.shardStart, now, tap.shardPackets,
+                                 tap.shardAttackPackets, tap.shardDropped});
+    }
+
+    /// Schedules a rotation at every interval and attack window boundary before the stop time.
+    void ScheduleRotations(double stopTime) {
+        if (!Rotating()) {
+            return;
+        }
+        double now = Simulator::Now().GetSeconds();
+        std::vector<double> boundaries;
+        if (m_rotationInterval > 0.0) {
+            for (double t = now + m_rotationInterval; t < stopTime; t += m_rotationInterval) {
+                boundaries.push_back(t);
+            }
+        }
+        if (m_rotateOnAttacks && m_schedule != nullptr) {
+            for (const AttackWindow& w : m_schedule->GetWindows()) {
+                boundaries.push_back(w.start);
+                boundaries.push_back(w.stop);
+            }
+        }
+        std::sort(boundaries.begin(), boundaries.end());
+        double last = now;
+        for (double t : boundaries) {
+            // Boundaries closer than a microsecond would only produce empty shards
+            if (t - last >= 1e-6 && t < stopTime) {
+                Simulator::Schedule(Seconds(t - now), &CaptureManager::Rotate, this);
+                last = t;
+            }
+        }
+    }
+
+    /// Continues every tap in a new shard.
+    void Rotate() {
+        double now = Simulator::Now().GetSeconds();
+        for (uint32_t i = 0; i < m_taps.size(); ++i) {
+            CloseShard(i, now);
+            OpenShard(i);
+        }
+    }
+
+    /// Writes the Section Header Block and the tap's Interface Description Block.
+    void WritePcapngHeader(uint32_t index) {
+        Tap& tap = m_taps[index];
+        BeginBlock(PCAPNG_BLOCK_SHB);
+        uint32_t byteOrder = 0x1a2b3c4d;
+        uint16_t version[2] = {1, 0};
+        int64_t sectionLength = -1;  // Not known while streaming
+        Append(&byteOrder, sizeof(byteOrder));
+        Append(version, sizeof(version));
+        Append(&sectionLength, sizeof(sectionLength));
+        AppendOption(PCAPNG_OPT_SHB_USERAPPL, "ids_dataset", 11);
+        EndBlock(tap.file);
+
+        std::string description = "views:";
+        for (const View& view : m_views) {
+            if (view.tap == index) {
+                description += " " + view.name + (view.filter.empty() ? "" : " [" + view.filter + "]") + ";";
+            }
+        }
+        BeginBlock(PCAPNG_BLOCK_IDB);
+        uint16_t linkType = static_cast<uint16_t>(tap.linkType);
+        uint16_t reserved = 0;
+        uint32_t snapLen = tap.snapLen;
+        uint8_t tsResol = 9;  // Nanoseconds
+        Append(&linkType, sizeof(linkType));
+        Append(&reserved, sizeof(reserved));
+        Append(&snapLen, sizeof(snapLen));
+        AppendOption(PCAPNG_OPT_IF_NAME, tap.name.data(), tap.name.size());
+        AppendOption(PCAPNG_OPT_IF_DESCRIPTION, description.data(), description.size());
+        AppendOption(PCAPNG_OPT_IF_TSRESOL, &tsResol, sizeof(tsResol));
+        EndBlock(tap.file);
+    }
+
+    /**
+     * Writes one packet as an Enhanced Packet Block with its label options, serialized in place in
+     * the file buffer.
+     *
+     * @param instance Attack instance of the packet (0 = benign).
+     * @param label AttackLabel of the instance.
+     * @return false if the packet was dropped on overflow.
+     */
+    bool WriteEnhancedPacket(Tap& tap, int64_t ns, Ptr<const Packet> packet, uint32_t instance, uint8_t label) {
+        uint32_t size = packet->GetSize();
+        uint32_t captured = std::min(size, tap.snapLen);
+        char comment[48];
+        size_t commentLength = 0;
+        if (instance != 0) {
+            commentLength = static_cast<size_t>(
+                std::snprintf(comment, sizeof(comment), "%s #%u", AttackLabelName(label), instance));
+        }
+
+        // Block header and fixed fields (28), data, label option (16), comment option, end of
+        // options (4) and trailing length (4)
+        uint32_t dataLength = (captured + 3) & ~3u;
+        uint32_t commentOption = commentLength > 0 ? 4 + ((static_cast<uint32_t>(commentLength) + 3) & ~3u) : 0;
+        uint32_t total = 28 + dataLength + 16 + commentOption + 8;
+        char* out = tap.file->Reserve(total);
+        if (out == nullptr) {
+            ++tap.dropped;
+            ++tap.shardDropped;
+            return false;
+        }
+        uint32_t fixed[7] = {PCAPNG_BLOCK_EPB, total, 0, static_cast<uint32_t>(static_cast<uint64_t>(ns) >> 32),
+                             static_cast<uint32_t>(ns), captured, size};
+        std::memcpy(out, fixed, sizeof(fixed));
+        out += sizeof(fixed);
+        packet->CopyData(reinterpret_cast<uint8_t*>(out), captured);
+        std::memset(out + captured, 0, dataLength - captured);
+        out += dataLength;
+
+        uint16_t optionHeader[2] = {PCAPNG_OPT_CUSTOM_BINARY, 12};
+        uint8_t option[12] = {0};
+        uint32_t pen = PCAPNG_LABEL_PEN;
+        std::memcpy(option, &pen, sizeof(pen));
+        std::memcpy(option + 4, &instance, sizeof(instance));
+        option[8] = label;
+        std::memcpy(out, optionHeader, sizeof(optionHeader));
+        std::memcpy(out + 4, option, sizeof(option));
+        out += 16;
+        if (commentLength > 0) {
+            optionHeader[0] = PCAPNG_OPT_COMMENT;
+            optionHeader[1] = static_cast<uint16_t>(commentLength);
+            std::memcpy(out, optionHeader, sizeof(optionHeader));
+            std::memset(out + 4, 0, commentOption - 4);
+            std::memcpy(out + 4, comment, commentLength);
+            out += commentOption;
+            ++tap.attackPackets;
+            ++tap.shardAttackPackets;
+        }
+        uint32_t trailer[2] = {PCAPNG_OPT_END, total};
+        std::memcpy(out, trailer, sizeof(trailer));
+        ++tap.packets;
+        ++tap.shardPackets;
+        tap.bytes += size;
+        tap.storedBytes += captured;
+        return true;
+    }
+
+    /// Starts a header block in m_block; the total length is filled in by EndBlock.
+    void BeginBlock(uint32_t type) {
+        m_block.clear();
+        uint32_t header[2] = {type, 0};
+        Append(header, sizeof(header));
+    }
+
+    /// Appends raw bytes to the current block.
+    void Append(const void* data, size_t length) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_block.insert(m_block.end(), bytes, bytes + length);
+    }
+
+    /// Appends an option (code, length, value padded to 4 bytes) to the current block.
+    void AppendOption(uint16_t code, const void* value, size_t length) {
+        uint16_t header[2] = {code, static_cast<uint16_t>(length)};
+        Append(header, sizeof(header));
+        Append(value, length);
+        m_block.resize((m_block.size() + 3) & ~size_t(3), 0);
+    }
+
+    /// Terminates the options, writes the total length at both ends and writes the block.
+    void EndBlock(AsyncOutputFile* file) {
+        uint32_t end = PCAPNG_OPT_END;
+        Append(&end, sizeof(end));
+        uint32_t total = static_cast<uint32_t>(m_block.size() + sizeof(uint32_t));
+        std::memcpy(&m_block[4], &total, sizeof(total));
+        Append(&total, sizeof(total));
+        file->Write(m_block.data(), m_block.size());
+    }
+
+    static void OnPacket(CaptureManager* self, uint32_t tap, Ptr<const Packet> packet) { self->Write(tap, packet); }
+
+    static void OnWifiTx(CaptureManager* self, uint32_t tap, Ptr<const Packet> packet, WifiMode /* mode */,
+                         WifiPreamble /* preamble */, uint8_t /* txPowerLevel */) {
+        self->Write(tap, packet);
+    }
+
+    static void OnWifiRx(CaptureManager* self, uint32_t tap, Ptr<const Packet> packet, double /* snr */,
+                         WifiMode /* mode */, WifiPreamble /* preamble */) {
+        self->Write(tap, packet);
+    }
+
+    CaptureFormat m_format;
+    const AttackSchedule* m_schedule;     // pcapng labels, may be null
+    uint32_t m_snapLen;                   // Snaplen of taps without their own
+    OutputCompression m_compression;      // Applied by the output writer
+    OutputOverflow m_overflow;            // Block or drop packets when the writer has no buffer
+    bool m_tagLabels;                     // Labels from AttackTags instead of schedule windows
+    LabelIndexWriter* m_labelIndex;       // Label index of the written packets, may be null
+    AsyncOutputWriter* m_writer;          // Creates the shard files
+    double m_rotationInterval;            // Simulated seconds per shard, 0 = no periodic rotation
+    bool m_rotateOnAttacks;               // Rotate at attack window boundaries
+    uint32_t m_openFailures;              // Shards whose file could not be created
+    std::vector<Tap> m_taps;
+    std::vector<View> m_views;
+    std::vector<Shard> m_shards;          // Closed files in closing order
+    std::vector<uint8_t> m_block;         // pcapng header block being assembled
+};
+
+} // namespace ns3
+
+#endif // IDS_CAPTURE_MANAGER_H
@@ -0,0 +1,511 @@
+// IDS Capture Splitter
+// Splits the PCAP captures written by ids_dataset.cc into one file per attack instance (or per
+// attack label) plus one file of benign traffic, using the attack-schedule.csv of the same run.
+// pcapng packets are assigned by the ground-truth label option of their EPB (code 2989, PEN 32473,
+// taken from the packet's AttackTag by default), the same label as the label index and the flow
+// CSVs. Classic pcap carries no labels, so its packets (and EPBs without the option) fall back to
+// the window and 5-tuple match of the schedule, which also puts benign traffic between attacker
+// and target during a window into the attack files; the summary line says which source was used.
+//
+// Each capture is memory-mapped and processed in three passes:
+// - index: one sequential walk over the records stores their offsets and timestamps;
+// - classify: the records are cut into one range per thread and every thread labels its range;
+// - write: every output file is written by one thread, copying its records straight from the
+//   mapping in capture order behind the original file header (pcap) or section and interface
+//   blocks (pcapng), so the output keeps the link type, snaplen and pcapng label options.
+//
+// Both pcap (microsecond or nanosecond) and pcapng captures are accepted. Compressed captures
+// (--output-compression=lz4) must be decompressed first (lz4 -d). Every output file is listed in
+// <out-dir>/split-index.csv:
+//   input,file,label,instances,packets,bytes
+// where instances lists the attack instances (rows of attack-schedule.csv) in the file, 0 for
+// benign traffic.
+//
+// The splitter only depends on ids_attack_schedule.h, ids_capture_format.h and the C++ standard
+// library, so it can be built inside the ns-3 scratch directory or on its own:
+//   g++ -O2 -std=c++17 -pthread -o ids_capture_splitter ids_capture_splitter.cc
+//
+// Usage:
+//   ids_capture_splitter --schedule=attack-schedule.csv [--out-dir=split] [--by=instance|label]
+//                        [--threads=N] <capture.pcap|capture.pcapng> ...
+
+#include "ids_attack_schedule.h"
+#include "ids_capture_format.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+static const uint32_t PCAP_MAGIC_USEC = 0xa1b2c3d4;
+static const uint32_t PCAP_MAGIC_NSEC = 0xa1b23c4d;
+static const uint32_t PCAPNG_BYTE_ORDER = 0x1a2b3c4d;
+static const uint32_t NO_LABEL_OPTION = 0xffffffff;
+
+/// Location and addressing data of one packet record in the mapping.
+struct CaptureRecord {
+    uint64_t offset;     // Start of the record (pcap record header or pcapng block)
+    uint32_t size;       // Whole record including headers and trailer
+    uint32_t captured;   // Packet bytes stored
+    uint32_t data;       // Offset of the packet bytes from the start of the record
+    uint32_t linkType;   // CAPTURE_LINKTYPE_* of the record's interface
+    double time;         // Seconds
+    uint32_t instance;   // Attack instance from the EPB label option, NO_LABEL_OPTION without one
+};
+
+/// A mapped capture file and its record index.
+struct MappedCapture {
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    bool pcapng = false;
+    size_t headerSize = 0;               // Bytes copied in front of every output file
+    std::vector<CaptureRecord> records;
+    uint64_t skippedBlocks = 0;          // pcapng blocks that are not packets (not copied)
+    uint64_t labelled = 0;               // Records with a label option
+    bool truncated = false;              // The last record is incomplete
+};
+
+/// One output file: the records of one attack instance or label.
+struct Partition {
+    uint32_t key;                        // Instance or label
+    std::vector<uint32_t> records;       // Indices into MappedCapture::records, in capture order
+    std::vector<uint32_t> instances;     // Attack instances present
+    uint64_t bytes = 0;                  // Packet bytes stored
+    std::string path;
+    bool ok = true;
+};
+
+static uint32_t ReadLe32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint16_t ReadLe16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/// Returns the value of a --name=value argument, or an empty string.
+static std::string OptionValue(const char* arg, const char* name) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return "";
+}
+
+static double Elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Indexes the records of a classic pcap file.
+static bool IndexPcap(MappedCapture& capture, std::string& error) {
+    PcapFileHeader header;
+    std::memcpy(&header, capture.base, sizeof(header));
+    double scale = (header.magic == PCAP_MAGIC_NSEC) ? 1e-9 : 1e-6;
+    capture.headerSize = sizeof(header);
+    size_t offset = sizeof(header);
+    while (offset + sizeof(PcapRecordHeader) <= capture.size) {
+        PcapRecordHeader record;
+        std::memcpy(&record, capture.base + offset, sizeof(record));
+        if (record.inclLen > std::max(header.snapLen, CAPTURE_SNAPLEN)) {
+            error = "record at offset " + std::to_string(offset) + " is corrupt";
+            return false;
+        }
+        if (offset + sizeof(record) + record.inclLen > capture.size) {
+            break;
+        }
+        capture.records.push_back(CaptureRecord{offset, static_cast<uint32_t>(sizeof(record) + record.inclLen),
+                                                record.inclLen, static_cast<uint32_t>(sizeof(record)),
+                                                header.linkType, record.tsSec + record.tsUsec * scale,
+                                                NO_LABEL_OPTION});
+        offset += sizeof(record) + record.inclLen;
+    }
+    capture.truncated = offset != capture.size;
+    return true;
+}
+
+/// Indexes the Enhanced Packet Blocks of a pcapng file with one section.
+static bool IndexPcapng(MappedCapture& capture, std::string& error) {
+    struct Interface {
+        uint32_t linkType;
+        double scale;    // Seconds per timestamp unit
+    };
+    std::vector<Interface> interfaces;
+    size_t offset = 0;
+    while (offset + 12 <= capture.size) {
+        uint32_t type = ReadLe32(capture.base + offset);
+        uint32_t length = ReadLe32(capture.base + offset + 4);
+        if (length < 12 || (length & 3) != 0) {
+            error = "block at offset " + std::to_string(offset) + " is corrupt";
+            return false;
+        }
+        if (offset + length > capture.size) {
+            break;
+        }
+        const uint8_t* block = capture.base + offset;
+        if (type == PCAPNG_BLOCK_SHB) {
+            if (offset != 0) {
+                error = "files with more than one section are not supported";
+                return false;
+            }
+        } else if (type == PCAPNG_BLOCK_IDB) {
+            if (!capture.records.empty()) {
+                error = "interfaces described after the first packet are not supported";
+                return false;
+            }
+            Interface iface{ReadLe16(block + 8), 1e-6};
+            size_t option = 16;
+            while (option + 4 <= length - 4) {
+                uint16_t code = ReadLe16(block + option);
+                uint16_t size = ReadLe16(block + option + 2);
+                if (code == PCAPNG_OPT_END) {
+                    break;
+                }
+                if (code == PCAPNG_OPT_IF_TSRESOL && size >= 1) {
+                    uint8_t resolution = block[option + 4];
+                    iface.scale = (resolution & 0x80) ? 1.0 / static_cast<double>(1ull << (resolution & 0x7f))
+                                                      : 1.0 / std::pow(10.0, resolution);
+                }
+                option += 4 + ((size + 3u) & ~3u);
+            }
+            interfaces.push_back(iface);
+        } else if (type == PCAPNG_BLOCK_EPB && length >= 32) {
+            uint32_t interface = ReadLe32(block + 8);
+            uint32_t captured = ReadLe32(block + 20);
+            if (interface >= interfaces.size() || 28 + captured > length - 4) {
+                error = "packet block at offset " + std::to_string(offset) + " is corrupt";
+                return false;
+            }
+            uint64_t ts = (static_cast<uint64_t>(ReadLe32(block + 12)) << 32) | ReadLe32(block + 16);
+            // Ground-truth label option written by the capture manager: PEN, instance, label
+            uint32_t instance = NO_LABEL_OPTION;
+            size_t option = 28 + ((captured + 3u) & ~3u);
+            while (option + 4 <= length - 4) {
+                uint16_t code = ReadLe16(block + option);
+                uint16_t size = ReadLe16(block + option + 2);
+                if (code == PCAPNG_OPT_END || option + 4 + size > length - 4) {
+                    break;
+                }
+                if (code == PCAPNG_OPT_CUSTOM_BINARY && size >= 9 && ReadLe32(block + option + 4) == PCAPNG_LABEL_PEN) {
+                    instance = ReadLe32(block + option + 8);
+                    ++capture.labelled;
+                    break;
+                }
+                option += 4 + ((size + 3u) & ~3u);
+            }
+            capture.records.push_back(CaptureRecord{offset, length, captured, 28, interfaces[interface].linkType,
+                                                    static_cast<double>(ts) * interfaces[interface].scale,
+                                                    instance});
+        } else {
+            ++capture.skippedBlocks;
+        }
+        if (capture.records.empty()) {
+            capture.headerSize = offset + length;
+        }
+        offset += length;
+    }
+    capture.truncated = offset != capture.size;
+    return true;
+}
+
+/// Writes one partition: the file header followed by its records, staged in large chunks.
+static void WritePartition(const MappedCapture& capture, Partition& partition) {
+    int fd = ::open(partition.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        partition.ok = false;
+        return;
+    }
+    std::vector<uint8_t> buffer;
+    buffer.reserve(4 << 20);
+    auto flush = [&]() {
+        const uint8_t* data = buffer.data();
+        size_t size = buffer.size();
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                partition.ok = false;
+                break;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        buffer.clear();
+    };
+    buffer.insert(buffer.end(), capture.base, capture.base + capture.headerSize);
+    for (uint32_t index : partition.records) {
+        const CaptureRecord& record = capture.records[index];
+        if (buffer.size() + record.size > buffer.capacity()) {
+            flush();
+        }
+        const uint8_t* data = capture.base + record.offset;
+        buffer.insert(buffer.end(), data, data + record.size);
+    }
+    flush();
+    if (::close(fd) != 0) {
+        partition.ok = false;
+    }
+}
+
+/// Name of a capture file without directory and capture extension.
+static std::string CaptureStem(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    for (const char* extension : {".pcapng", ".pcap"}) {
+        size_t length = std::strlen(extension);
+        if (name.size() > length && name.compare(name.size() - length, length, extension) == 0) {
+            return name.substr(0, name.size() - length);
+        }
+    }
+    return name;
+}
+
+/**
+ * Splits one capture file. Returns false on errors that leave the capture unprocessed.
+ */
+static bool SplitCapture(const std::string& path, const AttackSchedule& schedule, const std::string& outDir,
+                         bool byLabel, unsigned threads, std::string& indexCsv) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    MappedCapture capture;
+    capture.size = static_cast<size_t>(st.st_size);
+    if (capture.size < sizeof(PcapFileHeader)) {
+        std::fprintf(stderr, "%s is not a capture file\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    void* mapping = ::mmap(nullptr, capture.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::fprintf(stderr, "Cannot map %s\n", path.c_str());
+        return false;
+    }
+    capture.base = static_cast<const uint8_t*>(mapping);
+    ::madvise(mapping, capture.size, MADV_SEQUENTIAL);
+
+    // Pass 1: record index
+    auto start = std::chrono::steady_clock::now();
+    uint32_t magic = ReadLe32(capture.base);
+    std::string error;
+    bool indexed = false;
+    if (magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC) {
+        indexed = IndexPcap(capture, error);
+    } else if (magic == PCAPNG_BLOCK_SHB && ReadLe32(capture.base + 8) == PCAPNG_BYTE_ORDER) {
+        capture.pcapng = true;
+        indexed = IndexPcapng(capture, error);
+    } else if (magic == LZ4_FRAME_MAGIC) {
+        error = "compressed capture, decompress it first (lz4 -d)";
+    } else {
+        error = "not a little-endian pcap or pcapng file";
+    }
+    if (!indexed) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+        ::munmap(mapping, capture.size);
+        return false;
+    }
+    double indexMs = Elapsed(start);
+    uint32_t windows = static_cast<uint32_t>(schedule.GetWindows().size());
+    for (const CaptureRecord& record : capture.records) {
+        if (record.instance != NO_LABEL_OPTION && record.instance > windows) {
+            std::fprintf(stderr, "%s: packet labelled with attack instance %u, which is not in the schedule "
+                                 "(wrong attack-schedule.csv?)\n", path.c_str(), record.instance);
+            ::munmap(mapping, capture.size);
+            return false;
+        }
+    }
+
+    // Pass 2: label the records, one contiguous range per thread; label options win over windows
+    start = std::chrono::steady_clock::now();
+    ::madvise(mapping, capture.size, MADV_RANDOM);
+    size_t count = capture.records.size();
+    std::vector<uint32_t> instances(count, 0);
+    unsigned workers = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, count / 4096 + 1)));
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < workers; ++w) {
+        size_t begin = count * w / workers;
+        size_t end = count * (w + 1) / workers;
+        pool.emplace_back([&capture, &schedule, &instances, begin, end]() {
+            for (size_t i = begin; i < end; ++i) {
+                const CaptureRecord& record = capture.records[i];
+                if (record.instance != NO_LABEL_OPTION) {
+                    instances[i] = record.instance;
+                    continue;
+                }
+                size_t ipLength = 0;
+                PacketTuple t;
+                const uint8_t* ip = FindIpv4Header(record.linkType, capture.base + record.offset + record.data,
+                                                   record.captured, ipLength);
+                if (ip != nullptr && ParseIpv4Tuple(ip, ipLength, t)) {
+                    instances[i] = schedule.Match(record.time, t.src, t.dst, t.protocol, t.srcPort, t.dstPort);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    pool.clear();
+    double classifyMs = Elapsed(start);
+
+    // Group record indices by output file, keeping capture order
+    std::vector<Partition> partitions;
+    std::vector<int32_t> slot(schedule.GetWindows().size() + ATTACK_LABEL_COUNT + 1, -1);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t key = byLabel ? schedule.InstanceLabel(instances[i]) : instances[i];
+        if (slot[key] < 0) {
+            slot[key] = static_cast<int32_t>(partitions.size());
+            partitions.push_back(Partition());
+            partitions.back().key = key;
+        }
+        Partition& partition = partitions[slot[key]];
+        partition.records.push_back(static_cast<uint32_t>(i));
+        partition.bytes += capture.records[i].captured;
+        if (std::find(partition.instances.begin(), partition.instances.end(), instances[i]) ==
+            partition.instances.end()) {
+            partition.instances.push_back(instances[i]);
+        }
+    }
+    std::string stem = CaptureStem(path);
+    std::string extension = capture.pcapng ? ".pcapng" : ".pcap";
+    for (Partition& partition : partitions) {
+        uint8_t label = byLabel ? static_cast<uint8_t>(partition.key) : schedule.InstanceLabel(partition.key);
+        std::string name = stem + "." + AttackLabelName(label);
+        if (!byLabel && partition.key != 0) {
+            name += "-" + std::to_string(partition.key);
+        }
+        partition.path = outDir + "/" + name + extension;
+        std::sort(partition.instances.begin(), partition.instances.end());
+    }
+
+    // Pass 3: write the partitions, largest first so the threads finish together
+    start = std::chrono::steady_clock::now();
+    ::madvise(mapping, capture.size, MADV_WILLNEED);
+    std::vector<size_t> order(partitions.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&partitions](size_t a, size_t b) { return partitions[a].bytes > partitions[b].bytes; });
+    std::atomic<size_t> next(0);
+    workers = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, partitions.size())));
+    for (unsigned w = 0; w < workers; ++w) {
+        pool.emplace_back([&capture, &partitions, &order, &next]() {
+            size_t i;
+            while ((i = next++) < order.size()) {
+                WritePartition(capture, partitions[order[i]]);
+            }
+        });
+    }
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+    double writeMs = Elapsed(start);
+    ::munmap(mapping, capture.size);
+
+    bool ok = true;
+    for (const Partition& partition : partitions) {
+        if (!partition.ok) {
+            std::fprintf(stderr, "Cannot write %s\n", partition.path.c_str());
+            ok = false;
+        }
+        uint8_t label = byLabel ? static_cast<uint8_t>(partition.key) : schedule.InstanceLabel(partition.key);
+        indexCsv += path + "," + partition.path + "," + AttackLabelName(label) + ",";
+        for (size_t i = 0; i < partition.instances.size(); ++i) {
+            indexCsv += (i > 0 ? " " : "") + std::to_string(partition.instances[i]);
+        }
+        indexCsv += "," + std::to_string(partition.records.size()) + "," + std::to_string(partition.bytes) + "\n";
+    }
+    const char* labels = (capture.labelled == 0)       ? "schedule windows"
+                         : (capture.labelled == count) ? "label options"
+                                                       : "label options, schedule windows for the rest";
+    std::printf("%s: %zu packets into %zu files by %s (index %.1f ms, classify %.1f ms, write %.1f ms)%s\n",
+                path.c_str(), count, partitions.size(), labels, indexMs, classifyMs, writeMs,
+                capture.truncated ? ", last record incomplete" : "");
+    if (capture.skippedBlocks > 0) {
+        std::printf("  %llu non-packet blocks not copied\n", static_cast<unsigned long long>(capture.skippedBlocks));
+    }
+    return ok;
+}
+
+int main(int argc, char *argv[]) {
+    std::string schedulePath;
+    std::string outDir = "split";
+    std::string by = "instance";
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (!(value = OptionValue(argv[i], "--schedule")).empty()) {
+            schedulePath = value;
+        } else if (!(value = OptionValue(argv[i], "--out-dir")).empty()) {
+            outDir = value;
+        } else if (!(value = OptionValue(argv[i], "--by")).empty()) {
+            by = value;
+        } else if (!(value = OptionValue(argv[i], "--threads")).empty()) {
+            threads = std::max(1u, static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10)));
+        } else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (schedulePath.empty() || inputs.empty() || (by != "instance" && by != "label")) {
+        std::fprintf(stderr, "Usage: %s --schedule=attack-schedule.csv [--out-dir=DIR] [--by=instance|label] "
+                             "[--threads=N] <capture> ...\n", argv[0]);
+        return 1;
+    }
+    AttackSchedule schedule;
+    if (!schedule.ReadCsv(schedulePath)) {
+        std::fprintf(stderr, "Cannot read attack schedule %s\n", schedulePath.c_str());
+        return 1;
+    }
+    if (::mkdir(outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::fprintf(stderr, "Cannot create %s\n", outDir.c_str());
+        return 1;
+    }
+
+    std::string indexCsv = "input,file,label,instances,packets,bytes\n";
+    int failures = 0;
+    for (const std::string& input : inputs) {
+        if (!SplitCapture(input, schedule, outDir, by == "label", threads, indexCsv)) {
+            ++failures;
+        }
+    }
+    std::string indexPath = outDir + "/split-index.csv";
+    std::FILE* index = std::fopen(indexPath.c_str(), "w");
+    if (index == nullptr || std::fwrite(indexCsv.data(), 1, indexCsv.size(), index) != indexCsv.size()) {
+        std::fprintf(stderr, "Cannot write %s\n", indexPath.c_str());
+        ++failures;
+    }
+    if (index != nullptr) {
+        std::fclose(index);
+    }
+    return failures == 0 ? 0 : 1;
+}
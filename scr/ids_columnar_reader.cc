@@ -0,0 +1,177 @@
+// IDS Columnar Packet Record Reader
+// Reads the columnar packet record file written by ids_dataset.cc (--packet-export=columnar).
+// The file is mapped with mmap and only the column chunks that are requested are touched, which is
+// the access pattern training jobs are expected to use. By default the schema and row groups are
+// listed; with --columns the selected columns are printed as CSV.
+//
+// The reader only depends on ids_packet_export.h and the C++ standard library, so it can be built
+// inside the ns-3 scratch directory or on its own:
+//   g++ -O2 -std=c++17 -o ids_columnar_reader ids_columnar_reader.cc
+//
+// Usage:
+//   ids_columnar_reader <packet-records.col> [--columns time_ns,src_ip,dst_ip,label]
+
+#include "ids_packet_export.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/// Prints one value of a column chunk.
+static void PrintValue(const ColumnarColumnInfo& column, const uint8_t* chunk, uint64_t row) {
+    const uint8_t* p = chunk + row * column.width;
+    if (column.type == COLUMN_INT64) {
+        int64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        std::printf("%lld", static_cast<long long>(v));
+    } else if (column.type == COLUMN_UINT32) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if (std::strcmp(column.name, "src_ip") == 0 || std::strcmp(column.name, "dst_ip") == 0) {
+            std::printf("%s", AttackSchedule::FormatAddress(v).c_str());
+        } else {
+            std::printf("%u", v);
+        }
+    } else if (column.type == COLUMN_UINT16) {
+        uint16_t v;
+        std::memcpy(&v, p, sizeof(v));
+        std::printf("%u", v);
+    } else if (std::strcmp(column.name, "label") == 0) {
+        std::printf("%s", AttackLabelName(*p));
+    } else {
+        std::printf("%u", *p);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <packet-records.col> [--columns name,name,...]\n", argv[0]);
+        return 1;
+    }
+    std::string columnList = (argc > 3 && std::strcmp(argv[2], "--columns") == 0) ? argv[3] : "";
+
+    int fd = ::open(argv[1], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        std::fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < sizeof(ColumnarFileHeader) + sizeof(ColumnarFileTrailer)) {
+        std::fprintf(stderr, "%s is not an IDS columnar file\n", argv[1]);
+        ::close(fd);
+        return 1;
+    }
+    void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::fprintf(stderr, "Cannot map %s\n", argv[1]);
+        return 1;
+    }
+    const uint8_t* base = static_cast<const uint8_t*>(mapping);
+
+    // Validate header and trailer before trusting any offset in the file
+    ColumnarFileHeader header;
+    ColumnarFileTrailer trailer;
+    std::memcpy(&header, base, sizeof(header));
+    std::memcpy(&trailer, base + fileSize - sizeof(trailer), sizeof(trailer));
+    if (std::memcmp(header.magic, COLUMNAR_MAGIC, sizeof(header.magic)) != 0 ||
+        std::memcmp(trailer.magic, COLUMNAR_TRAILER_MAGIC, sizeof(trailer.magic)) != 0) {
+        std::fprintf(stderr, "%s is not a complete IDS columnar file\n", argv[1]);
+        ::munmap(mapping, fileSize);
+        return 1;
+    }
+    size_t entryWords = 3 + header.columnCount;
+    size_t schemaEnd = sizeof(header) + header.columnCount * sizeof(ColumnarColumnInfo);
+    if (header.version != COLUMNAR_VERSION || schemaEnd > trailer.footerOffset ||
+        trailer.footerOffset + trailer.rowGroupCount * entryWords * sizeof(uint64_t) + sizeof(trailer) != fileSize) {
+        std::fprintf(stderr, "Unsupported or corrupt columnar file (version %u)\n", header.version);
+        ::munmap(mapping, fileSize);
+        return 1;
+    }
+    std::vector<ColumnarColumnInfo> schema(header.columnCount);
+    std::memcpy(schema.data(), base + sizeof(header), schema.size() * sizeof(ColumnarColumnInfo));
+    for (ColumnarColumnInfo& column : schema) {
+        column.name[sizeof(column.name) - 1] = '\0';
+    }
+    std::vector<uint64_t> footer(trailer.rowGroupCount * entryWords);
+    std::memcpy(footer.data(), base + trailer.footerOffset, footer.size() * sizeof(uint64_t));
+
+    if (columnList.empty()) {
+        std::printf("Columns:\n");
+        for (const ColumnarColumnInfo& column : schema) {
+            std::printf("  %-12s width %u\n", column.name, column.width);
+        }
+        uint64_t rows = 0;
+        std::printf("Row groups: %u\n", trailer.rowGroupCount);
+        for (uint32_t g = 0; g < trailer.rowGroupCount; ++g) {
+            const uint64_t* entry = &footer[g * entryWords];
+            std::printf("  %u: %llu rows, %.6f s - %.6f s\n", g, static_cast<unsigned long long>(entry[0]),
+                        static_cast<int64_t>(entry[1]) / 1e9, static_cast<int64_t>(entry[2]) / 1e9);
+            rows += entry[0];
+        }
+        std::printf("Rows: %llu\n", static_cast<unsigned long long>(rows));
+        ::munmap(mapping, fileSize);
+        return 0;
+    }
+
+    // Resolve the requested column names to schema indices
+    std::vector<uint32_t> selected;
+    size_t start = 0;
+    while (start <= columnList.size()) {
+        size_t end = columnList.find(',', start);
+        std::string name = columnList.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        uint32_t c = 0;
+        while (c < schema.size() && name != schema[c].name) {
+            ++c;
+        }
+        if (c == schema.size()) {
+            std::fprintf(stderr, "Unknown column: %s\n", name.c_str());
+            ::munmap(mapping, fileSize);
+            return 1;
+        }
+        selected.push_back(c);
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    for (size_t i = 0; i < selected.size(); ++i) {
+        std::printf("%s%s", i > 0 ? "," : "", schema[selected[i]].name);
+    }
+    std::printf("\n");
+    for (uint32_t g = 0; g < trailer.rowGroupCount; ++g) {
+        const uint64_t* entry = &footer[g * entryWords];
+        uint64_t rowCount = entry[0];
+        std::vector<const uint8_t*> chunks;
+        for (uint32_t c : selected) {
+            uint64_t offset = entry[3 + c];
+            if (offset + rowCount * schema[c].width > trailer.footerOffset) {
+                std::fprintf(stderr, "Row group %u column %s is out of bounds\n", g, schema[c].name);
+                ::munmap(mapping, fileSize);
+                return 1;
+            }
+            chunks.push_back(base + offset);
+        }
+        for (uint64_t row = 0; row < rowCount; ++row) {
+            for (size_t i = 0; i < selected.size(); ++i) {
+                if (i > 0) {
+                    std::printf(",");
+                }
+                PrintValue(schema[selected[i]], chunks[i], row);
+            }
+            std::printf("\n");
+        }
+    }
+    ::munmap(mapping, fileSize);
+    return 0;
+}
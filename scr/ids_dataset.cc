@@ -81,9 +81,31 @@
 #include "ns3/internet-apps-module.h"   // Internet applications like Ping and Traceroute
 
 // Standard libraries
+#include <chrono>                       // Wall-clock timing of the simulation run
+#include <cstdio>                       // snprintf for the run summary
+#include <limits>                       // Unlimited NetAnim trace file size in stream mode
+#include <memory>                       // Smart pointers for optional output buffers
+#include <sstream>                      // Capture view filter expressions
 #include <string>                       // String manipulation
 #include <vector>                       // Dynamic arrays for managing data
 
+// IDS dataset helpers (header-only, located next to this file)
+#include "ids_async_output.h"           // Background writer thread shared by all output files
+#include "ids_anim_stream.h"            // Sampled, compressed NetAnim output through a pipe
+#include "ids_packet_tracer.h"          // Binary ring-buffer packet event tracer
+#include "ids_wifi_phy_stats.h"         // Aggregating per-station Wi-Fi PHY statistics
+#include "ids_log_profile.h"            // Named log profiles with per-component sampling
+#include "ids_attack_schedule.h"        // Attack windows and traffic labels
+#include "ids_packet_export.h"          // Columnar packet record exporter for ML pipelines
+#include "ids_sim_profiler.h"           // Events/sec and sim-to-wall timeline per attack phase
+#include "ids_app_attribution.h"        // Packets and events attributed to each application
+#include "ids_memory_tracker.h"         // RSS and object counts per scenario phase
+#include "ids_capture_manager.h"        // One PCAP file per physical tap, named views as filters
+#include "ids_attack_tag.h"             // Per-packet ground truth attached by the attack applications
+#include "ids_label_index.h"            // Time-sorted binary index of packet labels next to the captures
+#include "ids_flow_features.h"          // CIC-IDS2017-style labelled flow features computed during the run
+#include "ids_flowmon_export.h"         // Periodic FlowMonitor records of idle flows
+
 
 
 using namespace ns3;  // Importing the ns-3 namespace for easier access to its classes and functions
@@ -94,58 +116,251 @@ NS_LOG_COMPONENT_DEFINE("NetworkSimulation");
 // Callback functions for point-to-point devices
 
 /**
- * Callback for when a packet is transmitted on a point-to-point device.
- * Logs the size of the packet and the time of transmission.
+ * Callback for when a packet is transmitted on a point-to-point or CSMA device.
+ * Appends a binary record with the packet's attack label to the packet tracer, or logs the size
+ * of the packet and the time of transmission when no tracer is given (text mode).
  *
+ * @param tracer The binary packet tracer, or nullptr for text output.
+ * @param nodeId The ID of the node owning the device.
+ * @param deviceIndex The index of the device on the node.
  * @param packet A pointer to the packet being transmitted.
  */
-void TxCallback(Ptr<const Packet> packet) {
+void TxCallback(PacketTracer* tracer, uint32_t nodeId, uint32_t deviceIndex, Ptr<const Packet> packet) {
+    if (tracer != nullptr) {
+        tracer->Record(Simulator::Now().GetNanoSeconds(), nodeId, deviceIndex, packet->GetSize(), PACKET_TRACE_TX,
+                       AttackTagLabel(packet));
+        return;
+    }
     NS_LOG_UNCOND("Packet transmitted: Size = " << packet->GetSize()
                    << " bytes at " << Simulator::Now().GetSeconds() << " seconds");
 }
 
 /**
- * Callback for when a packet is received on a point-to-point device.
- * Logs the size of the packet and the time of reception.
+ * Callback for when a packet is received on a point-to-point or CSMA device.
+ * Appends a binary record with the packet's attack label to the packet tracer, or logs the size
+ * of the packet and the time of reception when no tracer is given (text mode).
  *
+ * @param tracer The binary packet tracer, or nullptr for text output.
+ * @param nodeId The ID of the node owning the device.
+ * @param deviceIndex The index of the device on the node.
  * @param packet A pointer to the packet being received.
  */
-void RxCallback(Ptr<const Packet> packet) {
+void RxCallback(PacketTracer* tracer, uint32_t nodeId, uint32_t deviceIndex, Ptr<const Packet> packet) {
+    if (tracer != nullptr) {
+        tracer->Record(Simulator::Now().GetNanoSeconds(), nodeId, deviceIndex, packet->GetSize(), PACKET_TRACE_RX,
+                       AttackTagLabel(packet));
+        return;
+    }
     NS_LOG_UNCOND("Packet received: Size = " << packet->GetSize()
                    << " bytes at " << Simulator::Now().GetSeconds() << " seconds");
 }
 
+/**
+ * Connects TxCallback and RxCallback to the PhyTxEnd/PhyRxEnd traces of every point-to-point
+ * and CSMA device in the simulation.
+ *
+ * @param tracer The binary packet tracer, or nullptr for text output.
+ */
+void ConnectPacketTrace(PacketTracer* tracer) {
+    for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+        Ptr<Node> node = *it;
+        for (uint32_t d = 0; d < node->GetNDevices(); ++d) {
+            Ptr<NetDevice> device = node->GetDevice(d);
+            if (!DynamicCast<PointToPointNetDevice>(device) && !DynamicCast<CsmaNetDevice>(device)) {
+                continue;  // Loopback and Wi-Fi devices are traced elsewhere
+            }
+            device->TraceConnectWithoutContext("PhyTxEnd", MakeBoundCallback(&TxCallback, tracer, node->GetId(), d));
+            device->TraceConnectWithoutContext("PhyRxEnd", MakeBoundCallback(&RxCallback, tracer, node->GetId(), d));
+        }
+    }
+}
+
 // Callback functions for Wi-Fi devices
 
 /**
- * Callback for when a Wi-Fi packet is transmitted.
- * Logs the size of the packet, time of transmission, and the transmission power.
+ * Callback for when a Wi-Fi frame is transmitted (WifiPhyStateHelper "Tx" trace).
+ * Aggregates the frame into the per-station statistics, or logs the size of the packet, time of
+ * transmission, Wi-Fi mode and transmission power level when no statistics sink is given (text mode).
  *
+ * @param stats The aggregating Wi-Fi statistics sink, or nullptr for text output.
+ * @param station The station slot in the statistics sink.
  * @param packet A pointer to the packet being transmitted.
- * @param txPowerW The transmission power in watts.
+ * @param mode The Wi-Fi mode used for the transmission.
+ * @param preamble The preamble type used in the transmission.
+ * @param txPowerLevel The transmission power level.
  */
-void WifiTxCallback(Ptr<const Packet> packet, double txPowerW) {
+void WifiTxCallback(WifiPhyStats* stats, uint32_t station, Ptr<const Packet> packet, WifiMode mode,
+                    WifiPreamble preamble, uint8_t txPowerLevel) {
+    if (stats != nullptr) {
+        stats->RecordTx(station, stats->GetModeSlot(mode), packet->GetSize());
+        return;
+    }
     NS_LOG_UNCOND("Wi-Fi Packet transmitted: Size = " << packet->GetSize()
                    << " bytes at " << Simulator::Now().GetSeconds() << " seconds"
-                   << ", TxPower: " << txPowerW << " W");
+                   << ", Mode: " << mode << ", Preamble: " << preamble
+                   << ", TxPowerLevel: " << static_cast<uint32_t>(txPowerLevel));
 }
 
 /**
- * Callback for when a Wi-Fi packet is received.
- * Logs the size of the packet, time of reception, signal-to-noise ratio (SNR), 
- * Wi-Fi mode, and preamble type.
+ * Callback for when a Wi-Fi frame is received (WifiPhyStateHelper "RxOk" trace).
+ * Aggregates the frame into the per-station statistics, or logs the size of the packet, time of
+ * reception, signal-to-noise ratio (SNR), Wi-Fi mode, and preamble type when no statistics sink is
+ * given (text mode).
  *
+ * @param stats The aggregating Wi-Fi statistics sink, or nullptr for text output.
+ * @param station The station slot in the statistics sink.
  * @param packet A pointer to the packet being received.
  * @param snr The signal-to-noise ratio of the received packet.
  * @param mode The Wi-Fi mode of the received packet (e.g., 802.11b, 802.11n).
  * @param preamble The preamble type used in the transmission (short or long).
  */
-void WifiRxCallback(Ptr<const Packet> packet, double snr, WifiMode mode, WifiPreamble preamble) {
+void WifiRxCallback(WifiPhyStats* stats, uint32_t station, Ptr<const Packet> packet, double snr, WifiMode mode,
+                    WifiPreamble preamble) {
+    if (stats != nullptr) {
+        stats->RecordRx(station, stats->GetModeSlot(mode), packet->GetSize(), snr);
+        return;
+    }
     NS_LOG_UNCOND("Wi-Fi Packet received: Size = " << packet->GetSize()
                    << " bytes at " << Simulator::Now().GetSeconds() << " seconds"
                    << ", SNR: " << snr << ", Mode: " << mode << ", Preamble: " << preamble);
 }
 
+/**
+ * Connects WifiTxCallback and WifiRxCallback to the PHY state traces of a Wi-Fi device.
+ *
+ * @param stats The aggregating Wi-Fi statistics sink, or nullptr for text output.
+ * @param device The Wi-Fi device to trace.
+ * @param name Label of the station in the summary output.
+ */
+void ConnectWifiTrace(WifiPhyStats* stats, Ptr<NetDevice> device, const std::string& name) {
+    Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice>(device);
+    uint32_t station = (stats != nullptr) ? stats->AddStation(name) : 0;
+    Ptr<WifiPhyStateHelper> state = wifiDevice->GetPhy()->GetState();
+    state->TraceConnectWithoutContext("Tx", MakeBoundCallback(&WifiTxCallback, stats, station));
+    state->TraceConnectWithoutContext("RxOk", MakeBoundCallback(&WifiRxCallback, stats, station));
+}
+
+/**
+ * Writes the Wi-Fi summary for the elapsed window and reschedules itself.
+ *
+ * @param stats The aggregating Wi-Fi statistics sink.
+ * @param interval Length of one summary window.
+ */
+void FlushWifiStats(WifiPhyStats* stats, Time interval) {
+    stats->Flush(Simulator::Now().GetSeconds());
+    Simulator::Schedule(interval, &FlushWifiStats, stats, interval);
+}
+
+// Packet record export
+
+/**
+ * Callback for an IPv4 packet sent or received by a node (Ipv4L3Protocol "Tx"/"Rx" traces).
+ * Copies the leading bytes of the packet, which start with the IPv4 header, and appends one row
+ * to the columnar exporter with the ground truth of the packet's AttackTag (ignored when the
+ * exporter labels rows from the attack schedule).
+ *
+ * @param exporter The columnar packet exporter.
+ * @param nodeId The ID of the node.
+ * @param direction PACKET_TRACE_TX or PACKET_TRACE_RX.
+ * @param packet A pointer to the packet, including its IPv4 header.
+ * @param ipv4 The IPv4 stack of the node.
+ * @param interface The IPv4 interface index.
+ */
+void PacketExportCallback(ColumnarPacketExporter* exporter, uint32_t nodeId, uint8_t direction,
+                          Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface) {
+    uint8_t bytes[80];  // Largest IPv4 header (60 bytes) plus the fixed part of the TCP header
+    uint32_t length = packet->CopyData(bytes, sizeof(bytes));
+    uint32_t instance;
+    uint8_t label;
+    ReadAttackTag(packet, instance, label);
+    exporter->RecordIpv4(Simulator::Now().GetNanoSeconds(), nodeId, interface, direction, bytes, length,
+                         packet->GetSize(), instance, label);
+}
+
+/**
+ * Connects PacketExportCallback to the IPv4 Tx and Rx traces of every node in the simulation.
+ *
+ * @param exporter The columnar packet exporter.
+ */
+void ConnectPacketExport(ColumnarPacketExporter* exporter) {
+    for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+        Ptr<Node> node = *it;
+        Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol>();
+        if (!ipv4) {
+            continue;
+        }
+        ipv4->TraceConnectWithoutContext("Tx", MakeBoundCallback(&PacketExportCallback, exporter, node->GetId(),
+                                                                 static_cast<uint8_t>(PACKET_TRACE_TX)));
+        ipv4->TraceConnectWithoutContext("Rx", MakeBoundCallback(&PacketExportCallback, exporter, node->GetId(),
+                                                                 static_cast<uint8_t>(PACKET_TRACE_RX)));
+    }
+}
+
+/**
+ * Returns the address of a node on its first non-loopback interface in host byte order, as used
+ * by the attack schedule.
+ *
+ * @param node The node.
+ */
+uint32_t ScheduleAddress(Ptr<Node> node) {
+    return node->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal().Get();
+}
+
+/**
+ * Returns the schedule addresses of the first nodes of a container.
+ *
+ * @param nodes The container holding the attacking nodes.
+ * @param count The number of attacking nodes (capped at the size of the container).
+ */
+std::vector<uint32_t> ScheduleAddresses(const NodeContainer& nodes, uint32_t count) {
+    std::vector<uint32_t> addresses;
+    for (uint32_t i = 0; i < count && i < nodes.GetN(); ++i) {
+        addresses.push_back(ScheduleAddress(nodes.Get(i)));
+    }
+    return addresses;
+}
+
+/**
+ * Builds the capture view filter for one server, e.g. "host 10.3.1.4 and (tcp port 22)".
+ *
+ * @param server The server address.
+ * @param ports BPF expression selecting the server's ports.
+ */
+std::string ServerFilter(Ipv4Address server, const std::string& ports) {
+    std::ostringstream filter;
+    filter << "host " << server << " and (" << ports << ")";
+    return filter.str();
+}
+
+/**
+ * Restricts the client traffic to one class for shortened benchmark variants. Clients outside the
+ * class get a start time after the end of the run, so they are installed but never start; servers
+ * always run.
+ *
+ * @param mix all, benign (no attack clients) or attack (no benign clients).
+ * @param schedule Attack schedule used to classify the clients.
+ * @param never A start time after the end of the run.
+ * @return The number of clients disabled.
+ */
+uint32_t ApplyTrafficMix(const std::string& mix, const AttackSchedule* schedule, Time never) {
+    uint32_t disabled = 0;
+    for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+        Ptr<Node> node = *it;
+        for (uint32_t a = 0; a < node->GetNApplications(); ++a) {
+            std::string role = DeriveAppRole(node, node->GetApplication(a), schedule);
+            if (role.compare(0, 7, "server-") == 0 || role == "other") {
+                continue;
+            }
+            bool benign = role.compare(0, 7, "benign-") == 0;
+            if ((mix == "benign" && !benign) || (mix == "attack" && benign)) {
+                node->GetApplication(a)->SetStartTime(never);
+                ++disabled;
+            }
+        }
+    }
+    return disabled;
+}
+
 
 
 int main(int argc, char *argv[]) {
@@ -153,29 +368,276 @@ int main(int argc, char *argv[]) {
     // CommandLine is an ns-3 utility for parsing command-line arguments.
     // It allows the user to configure simulation parameters without modifying the code.
     CommandLine cmd;
-    cmd.Parse(argc, argv);  // Parses the command-line arguments provided by the user.
-        
-    // Enable logging for specific components
-    // These LogComponentEnable statements enable logging for various ns-3 components at the specified log level.
-    // LOG_LEVEL_INFO ensures that informative messages are displayed during the simulation.
 
-    LogComponentEnable("BulkSendApplication", LOG_LEVEL_INFO); 
-    // Enables logging for the BulkSendApplication, which sends bulk data over a TCP connection.
+    // Packet event tracing on point-to-point and CSMA devices:
+    // off (default), text (one NS_LOG line per packet) or binary (ring-buffer tracer, see ids_packet_tracer.h).
+    std::string packetTraceMode = "off";
+    std::string packetTraceFile = "packet-trace.bin";
+    uint32_t packetTraceBuffer = 1 << 16;  // Records buffered in memory before a bulk drain (24 bytes each)
+    cmd.AddValue("packet-trace", "Packet event tracing: off, text or binary", packetTraceMode);
+    cmd.AddValue("packet-trace-file", "Output file for binary packet tracing", packetTraceFile);
+    cmd.AddValue("packet-trace-buffer", "Ring buffer capacity (records) for binary packet tracing", packetTraceBuffer);
+
+    // Wi-Fi PHY tracing on the AP and stations:
+    // off (default), text (one NS_LOG line per frame) or summary (aggregated, see ids_wifi_phy_stats.h).
+    std::string wifiTraceMode = "off";
+    std::string wifiTraceFile = "wifi-phy-summary.csv";
+    double wifiTraceInterval = 10.0;  // Simulated seconds between summary flushes
+    cmd.AddValue("wifi-trace", "Wi-Fi PHY tracing: off, text or summary", wifiTraceMode);
+    cmd.AddValue("wifi-trace-file", "Output file for the Wi-Fi PHY summary", wifiTraceFile);
+    cmd.AddValue("wifi-trace-interval", "Simulated seconds between Wi-Fi PHY summary flushes", wifiTraceInterval);
+
+    // Logging profile (see ids_log_profile.h): none, summary (default) or debug.
+    // In the debug profile, --log-sample and --log-rate take "Component=value" lists ("*" sets the default).
+    std::string logProfileName = "summary";
+    std::string logSample = "";
+    std::string logRate = "";
+    cmd.AddValue("log-profile", "Logging profile: none, summary or debug", logProfileName);
+    cmd.AddValue("log-sample", "Debug profile 1-in-N sampling per component, e.g. PacketSink=100,*=10", logSample);
+    cmd.AddValue("log-rate", "Debug profile max lines per simulated second per component, e.g. *=200", logRate);
+
+    // NetAnim output: off, full (single XML file of the whole run) or stream (windowed, sampled and
+    // optionally LZ4-compressed)
+    std::string netanimMode = "full";
+    std::string netanimFile = "network-visualization.xml";
+    double netanimStart = 0.0;
+    double netanimStop = 0.0;
+    uint32_t netanimSample = 1;
+    bool netanimCompress = true;
+    bool netanimMetadata = true;
+    cmd.AddValue("netanim", "NetAnim output: off, full or stream", netanimMode);
+    cmd.AddValue("netanim-file", "NetAnim XML file (stream mode appends .lz4 when compressing)", netanimFile);
+    cmd.AddValue("netanim-start", "Start of the animation window in seconds", netanimStart);
+    cmd.AddValue("netanim-stop", "End of the animation window in seconds (0 = end of the run)", netanimStop);
+    cmd.AddValue("netanim-sample", "Stream mode: keep one packet in N", netanimSample);
+    cmd.AddValue("netanim-compress", "Stream mode: LZ4-compress the animation XML", netanimCompress);
+    cmd.AddValue("netanim-metadata", "Record packet metadata in the animation", netanimMetadata);
+
+    // Output subsystem (see ids_async_output.h): file writes, fsync and close run on a background
+    // writer thread; memory for pending output is bounded by async-buffers * async-buffer-kb.
+    bool asyncOutput = true;
+    uint32_t asyncBufferKb = 1024;
+    uint32_t asyncBuffers = 32;
+    cmd.AddValue("async-output", "Write output files and log output from a background writer thread", asyncOutput);
+    cmd.AddValue("async-buffer-kb", "Size of one output buffer in KiB", asyncBufferKb);
+    cmd.AddValue("async-buffers", "Number of output buffers (bounds memory used by pending output)", asyncBuffers);
+
+    // Streaming compression of the large outputs (PCAP captures, FlowMonitor XML, NetAnim stream),
+    // done by the writer thread; the report lists compressed size and compression time per file.
+    std::string outputCompression = "none";
+    cmd.AddValue("output-compression", "Compress captures and XML results: none or lz4 (adds .lz4)",
+                 outputCompression);
+
+    // FlowMonitor results (see ids_flowmon_export.h): incremental writes a CSV record for every
+    // flow once it has been idle for flowmon-idle-timeout, checked every flowmon-interval simulated
+    // seconds, and keeps the per-flow histograms at one bin; xml writes the former end-of-run
+    // flowmon-results.xml with full histograms and probes.
+    std::string flowmonMode = "incremental";
+    std::string flowmonExportFile = "flowmon-flows.csv";
+    double flowmonInterval = FLOWMON_EXPORT_INTERVAL;
+    double flowmonIdleTimeout = FLOWMON_EXPORT_IDLE_TIMEOUT;
+    cmd.AddValue("flowmon", "FlowMonitor results: incremental (CSV of idle flows during the run) or xml", flowmonMode);
+    cmd.AddValue("flowmon-file", "Output file for the incremental FlowMonitor records", flowmonExportFile);
+    cmd.AddValue("flowmon-interval", "Simulated seconds between FlowMonitor exports", flowmonInterval);
+    cmd.AddValue("flowmon-idle-timeout", "Seconds without packets before a flow is exported", flowmonIdleTimeout);
+
+    // Packet record export for ML pipelines (see ids_packet_export.h): off (default) or columnar.
+    // The attack schedule used for the label column is written next to it as CSV.
+    std::string packetExportMode = "off";
+    std::string packetExportFile = "packet-records.col";
+    std::string attackScheduleFile = "attack-schedule.csv";
+    uint32_t packetExportRows = 1 << 16;  // Rows per row group
+    cmd.AddValue("packet-export", "Packet record export: off or columnar", packetExportMode);
+    cmd.AddValue("packet-export-file", "Output file for the columnar packet records", packetExportFile);
+    cmd.AddValue("packet-export-rows", "Rows per row group in the columnar packet records", packetExportRows);
+    cmd.AddValue("attack-schedule-file", "Output file for the attack schedule written with captures and labelled output",
+                 attackScheduleFile);
+
+    // Ground truth of the labelled outputs (packet records, pcapng captures, binary packet trace):
+    // tag reads the AttackTag the attack applications attach to their packets (ids_attack_tag.h),
+    // window matches packets against the attack windows, which also labels benign traffic between
+    // an attacker and its target during the window.
+    std::string labelSource = "tag";
+    cmd.AddValue("label-source", "Packet labels: tag (per-packet ground truth) or window (attack schedule)",
+                 labelSource);
+
+    // Scenario size and length. The defaults reproduce the dataset scenario; the benchmark
+    // (ids_benchmark.cc) uses them for shortened and scaled variants together with --RngSeed.
+    uint32_t numEnterpriseClients = 10;
+    uint32_t numWifiStations = 10;
+    uint32_t numRemoteClients = 10;
+    uint32_t clientScale = 1;
+    double runTime = 0.0;
+    std::string trafficMix = "all";
+    std::string runSummaryFile = "";
+    cmd.AddValue("enterprise-clients", "Number of enterprise client nodes", numEnterpriseClients);
+    cmd.AddValue("wifi-stations", "Number of Wi-Fi station nodes", numWifiStations);
+    cmd.AddValue("remote-clients", "Number of remote (VPN) client nodes", numRemoteClients);
+    cmd.AddValue("client-scale", "Multiplier applied to all three client counts", clientScale);
+    cmd.AddValue("run-time", "Simulated seconds to run (0 = until the applications stop)", runTime);
+    cmd.AddValue("traffic", "Client traffic: all, benign or attack", trafficMix);
+    cmd.AddValue("run-summary", "Write a one-line JSON summary of the run to this file", runSummaryFile);
+
+    // Simulation throughput profiler (see ids_sim_profiler.h): samples executed events, wall-clock
+    // time and event queue depth every profile-interval simulated seconds.
+    bool profile = false;
+    std::string profileFile = "sim-profile.csv";
+    double profileInterval = 1.0;
+    cmd.AddValue("profile", "Write an events/sec and sim-to-wall timeline of the run", profile);
+    cmd.AddValue("profile-file", "Output file for the profiler timeline", profileFile);
+    cmd.AddValue("profile-interval", "Simulated seconds between profiler samples", profileInterval);
+
+    // Application attribution report (see ids_app_attribution.h): packets and estimated scheduler
+    // events per application instance and per role.
+    bool appReport = false;
+    std::string appReportFile = "app-attribution.csv";
+    cmd.AddValue("app-report", "Attribute packets and events to each application at the end of the run", appReport);
+    cmd.AddValue("app-report-file", "Output file for the per-application report", appReportFile);
+
+    // Memory tracker (see ids_memory_tracker.h): RSS and object counts at setup checkpoints, attack
+    // window boundaries and every mem-interval simulated seconds. mem-track-packets also samples the
+    // packet UID counter, which allocates a probe packet per sample and so shifts later packet UIDs.
+    bool memTrack = false;
+    std::string memTrackFile = "memory-profile.csv";
+    double memTrackInterval = 10.0;
+    bool memTrackPackets = false;
+    cmd.AddValue("mem-track", "Sample RSS and object counts per scenario phase", memTrack);
+    cmd.AddValue("mem-track-file", "Output file for the memory samples", memTrackFile);
+    cmd.AddValue("mem-track-interval", "Simulated seconds between memory samples", memTrackInterval);
+    cmd.AddValue("mem-track-packets", "Also sample packets allocated (shifts packet UIDs)", memTrackPackets);
+
+    // PCAP capture (see ids_capture_manager.h): one file per physical tap; the monitoring points
+    // are views on the taps, listed with their filters in the capture index. The pcapng format
+    // labels every packet with its attack and attack instance (the row in the attack schedule).
+    // A snaplen such as 96 keeps only the headers; original packet lengths are still recorded.
+    // Write filters drop irrelevant packets (e.g. FTP transfers on the DMZ tap) before they are
+    // serialized; they apply to every view of a tap, so they are set per tap. See
+    // ids_capture_filter.h for the syntax.
+    // Rotation splits every tap into time shards listed in the capture manifest. Records are
+    // serialized into the output writer's buffers; capture-overflow=drop trades packets for never
+    // stalling the simulation when the buffers are full (drops are counted in the manifest).
+    // After the run, ids_capture_splitter splits the captures into per-attack files using the
+    // attack schedule written next to them.
+    // The label index (see ids_label_index.h) records time, flow hash, label, capture file and
+    // record offset of every captured IPv4 packet, sorted by time; ids_label_lookup queries it.
+    bool capture = true;
+    std::string captureFormat = "pcap";
+    std::string captureIndexFile = "capture-index.csv";
+    uint32_t captureSnapLen = 0;
+    std::string captureSnapLens = "";
+    std::string captureWriteFilters = "";
+    double captureRotate = 0.0;
+    bool captureRotateAttacks = false;
+    std::string captureManifestFile = "capture-manifest.csv";
+    std::string captureOverflow = "block";
+    std::string captureLabelIndex = "off";
+    std::string captureLabelIndexFile = "label-index.bin";
+    cmd.AddValue("capture", "Write PCAP files for the monitoring points", capture);
+    cmd.AddValue("capture-format", "Capture file format: pcap or pcapng (with per-packet labels)", captureFormat);
+    cmd.AddValue("capture-snaplen", "Bytes captured per packet on all taps (0 = full packets)", captureSnapLen);
+    cmd.AddValue("capture-snaplen-views", "Per-tap snaplen as view=bytes pairs, e.g. wifi-ap-traffic=256",
+                 captureSnapLens);
+    cmd.AddValue("capture-write-filters",
+                 "Tap write filters as tap=expression pairs separated by ';' (a tap file name, or a view "
+                 "alone on its tap), e.g. 'wifi-ap-traffic=tcp port 22 or label attack'",
+                 captureWriteFilters);
+    cmd.AddValue("capture-rotate", "Start a new capture shard every this many simulated seconds (0 = off)",
+                 captureRotate);
+    cmd.AddValue("capture-rotate-attacks", "Start a new capture shard at every attack start and stop",
+                 captureRotateAttacks);
+    cmd.AddValue("capture-manifest-file", "Output file listing the capture shards, their time ranges and attacks",
+                 captureManifestFile);
+    cmd.AddValue("capture-overflow", "When the output buffers are full: block the simulation or drop packets",
+                 captureOverflow);
+    cmd.AddValue("capture-index-file", "Output file listing the capture views, their files and filters",
+                 captureIndexFile);
+    cmd.AddValue("capture-label-index",
+                 "Time-sorted binary label index of the captured packets: off, all or attack (attack packets only)",
+                 captureLabelIndex);
+    cmd.AddValue("capture-label-index-file", "Output file for the capture label index", captureLabelIndexFile);
+
+    // Flow features (see ids_flow_features.h): CICFlowMeter-style features of every flow seen on
+    // the core router and DMZ taps, written as labelled CIC-IDS2017 rows when the flow ends
+    // (core-router-flows.csv, dmz-flows.csv), so no flow meter has to read the captures back.
+    // Open flows are held in a fixed-capacity table per tap (ids_flow_table.h): idle flows are
+    // written after flow-idle-timeout, and the least recently used flow when the table is full.
+    // With flow-feature-threads > 0 the trace callbacks only queue parsed packets and worker threads,
+    // each owning a 5-tuple hash shard of the flows, compute the features; rows of different workers
+    // then interleave, so the row order is not reproducible. The rows themselves are reproducible
+    // only while no table fills; each worker's shard holds its share of flow-table-capacity and
+    // evicts on its own.
+    bool flowFeatures = true;
+    double flowTimeout = FLOW_FEATURES_TIMEOUT;
+    double flowIdleTimeout = FLOW_FEATURES_IDLE_TIMEOUT;
+    double flowActivityTimeout = FLOW_FEATURES_ACTIVITY_TIMEOUT;
+    uint32_t flowTableCapacity = FLOW_FEATURES_TABLE_CAPACITY;
+    uint32_t flowFeatureThreads = 0;
+    cmd.AddValue("flow-features", "Write labelled CIC-IDS2017-style flow features of the core router and DMZ taps",
+                 flowFeatures);
+    cmd.AddValue("flow-timeout", "Seconds after its first packet at which a flow ends", flowTimeout);
+    cmd.AddValue("flow-idle-timeout", "Seconds without a packet after which a flow ends", flowIdleTimeout);
+    cmd.AddValue("flow-table-capacity", "Open flows kept per flow feature tap (least recently used evicted)",
+                 flowTableCapacity);
+    cmd.AddValue("flow-activity-timeout", "Idle seconds that end an active period of a flow", flowActivityTimeout);
+    cmd.AddValue("flow-feature-threads", "Worker threads computing flow features (0 = in the trace callbacks)",
+                 flowFeatureThreads);
 
-    LogComponentEnable("PacketSink", LOG_LEVEL_INFO); 
-    // Enables logging for the PacketSink application, which acts as a receiver for bulk data or other network traffic.
-
-    LogComponentEnable("UdpEchoClientApplication", LOG_LEVEL_INFO); 
-    // Enables logging for the UDP Echo Client application, which generates UDP packets for an echo server.
+    cmd.Parse(argc, argv);  // Parses the command-line arguments provided by the user.
 
-    LogComponentEnable("UdpEchoServerApplication", LOG_LEVEL_INFO); 
-    // Enables logging for the UDP Echo Server application, which responds to packets sent by the echo client.
+    // The profiler and the application report read event counts from a counting scheduler,
+    // installed before any event is scheduled
+    if (profile || appReport) {
+        CountingMapScheduler::Install();
+    }
 
-    LogComponentEnable("TcpL4Protocol", LOG_LEVEL_INFO); 
-    // Enables logging for the TCP Layer 4 Protocol, providing detailed logs about TCP operations.
+    // Shared output writer. NS_LOG output (std::clog) is routed through it to stderr, so the log
+    // writes happen off the simulator thread together with the trace and result files. Every line
+    // (std::endl) is handed to the writer thread at once, so progress lines appear as they are
+    // logged and are not held back in a 1 MiB buffer until exit or lost on NS_FATAL_ERROR.
+    AsyncOutputWriter output(asyncOutput, static_cast<size_t>(asyncBufferKb) * 1024, asyncBuffers);
+    if (outputCompression != "none" && outputCompression != "lz4") {
+        NS_FATAL_ERROR("Unknown --output-compression: " << outputCompression);
+    }
+    OutputCompression compression = (outputCompression == "lz4") ? OUTPUT_COMPRESSION_LZ4 : OUTPUT_COMPRESSION_NONE;
+    if (labelSource != "tag" && labelSource != "window") {
+        NS_FATAL_ERROR("Unknown --label-source: " << labelSource);
+    }
+    bool tagLabels = (labelSource == "tag");
+    std::streambuf* clogOriginal = std::clog.rdbuf();
+    std::unique_ptr<AsyncOutputStreamBuf> asyncLog;
+    if (asyncOutput) {
+        asyncLog.reset(new AsyncOutputStreamBuf(output.OpenDescriptor(STDERR_FILENO, "stderr"), true));
+        std::clog.rdbuf(asyncLog.get());
+    }
+        
+    // Enable logging for specific components
+    // The selected profile decides which ns-3 components log. Production dataset runs use none or
+    // summary, which keeps the application and transport components (BulkSendApplication, PacketSink,
+    // UdpEcho client/server, TCP/UDP L4) silent; the debug profile enables them at LOG_LEVEL_INFO and
+    // routes std::clog through the sampling buffer so the floods cannot flood the output.
+    LogProfile logProfile;
+    if (!ParseLogProfile(logProfileName, logProfile)) {
+        NS_FATAL_ERROR("Unknown --log-profile: " << logProfileName);
+    }
+    ApplyLogProfile(logProfile);
+
+    MemoryTracker memoryTracker;
+    if (memTrack) {
+        if (!memoryTracker.Open(output.Open(memTrackFile))) {
+            NS_FATAL_ERROR("Cannot open memory samples file " << memTrackFile);
+        }
+        memoryTracker.SetCountPackets(memTrackPackets);
+        memoryTracker.Checkpoint("start");
+    }
 
-    LogComponentEnable("UdpL4Protocol", LOG_LEVEL_INFO); 
-    // Enables logging for the UDP Layer 4 Protocol, providing insights into UDP operations.
+    std::streambuf* clogTarget = std::clog.rdbuf();
+    SampledLogBuffer sampledLog(clogTarget);
+    if (logProfile == LOG_PROFILE_DEBUG) {
+        if (!sampledLog.SetSampling(logSample) || !sampledLog.SetRateLimit(logRate)) {
+            NS_FATAL_ERROR("Invalid --log-sample or --log-rate specification");
+        }
+        std::clog.rdbuf(&sampledLog);
+    }
 
 // Node Container Declarations
 // A NodeContainer is used to manage collections of nodes in ns-3 simulations.
@@ -192,7 +654,7 @@ distributionSwitches.Create(2);      // Creates 2 distribution switches (Nodes 1
 accessSwitchesHR.Create(1);          // Creates 1 access switch (Node 3)
 
 // enterpriseClients.Create(3);       // (Commented out) Creates 3 enterprise client nodes (Nodes 4 to 6)
-enterpriseClients.Create(10);        // Creates 10 enterprise client nodes
+enterpriseClients.Create(numEnterpriseClients * clientScale);  // Creates 10 enterprise client nodes by default
 
 dmzServers.Create(5);                // Creates 5 DMZ (Demilitarized Zone) servers (Nodes 7 to 11)
 
@@ -201,10 +663,10 @@ vpnServer.Create(1);                 // Creates 1 VPN server (Node 12)
 wifiApNode.Create(1);                // Creates 1 Wi-Fi Access Point node (Node 13)
 
 // wifiStaNodes.Create(5);            // (Commented out) Creates 5 Wi-Fi station nodes (Nodes 14 to 18)
-wifiStaNodes.Create(10);             // Creates 10 Wi-Fi station nodes
+wifiStaNodes.Create(numWifiStations * clientScale);            // Creates 10 Wi-Fi station nodes by default
 
 // remoteClients.Create(4);           // (Commented out) Creates 4 remote client nodes (Nodes 19 to 22)
-remoteClients.Create(10);            // Creates 10 remote client nodes
+remoteClients.Create(numRemoteClients * clientScale);          // Creates 10 remote client nodes by default
 
 // Notes:
 // - Adjust the number of nodes in each category based on the simulation requirements.
@@ -423,51 +885,85 @@ address.NewNetwork();
 NS_LOG_INFO("Assigning IP addresses to VPN Devices...");
 for (uint32_t i = 0; i < vpnDevices.size(); ++i) {
     std::ostringstream subnet;
-    subnet << "10.1.0." << (i * 4 + 20);  // Start from 10.1.0.20, increment by 4 for each /30 subnet
+    if (i * 4 + 20 < 256) {
+        subnet << "10.1.0." << (i * 4 + 20);  // Start from 10.1.0.20, increment by 4 for each /30 subnet
+    } else {
+        subnet << "10.4." << (i * 4 / 256) << "." << (i * 4 % 256);  // Scaled variants: continue in 10.4.0.0/16
+    }
     address.SetBase(subnet.str().c_str(), "255.255.255.252");
     address.Assign(vpnDevices[i]);
     address.NewNetwork();
 }
+memoryTracker.Checkpoint("topology");
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Initialize NetAnim for visualization
-AnimationInterface anim("network-visualization.xml");
-
-// Set Positions for Nodes (including labels and colors)
-anim.SetConstantPosition(coreRouters.Get(0), 50.0, 50.0);
-anim.UpdateNodeDescription(coreRouters.Get(0), "Core Router");
-anim.UpdateNodeColor(coreRouters.Get(0), 255, 0, 0);
+// full writes the original single XML file; stream passes the XML through AnimationStream, which
+// samples packet elements and compresses the output (see ids_anim_stream.h). Both honour the
+// animation time window.
+std::unique_ptr<AnimationInterface> anim;
+AnimationStream animStream;
+if (netanimMode == "full" || netanimMode == "stream") {
+    std::string animPath = netanimFile;
+    if (netanimMode == "stream") {
+        animPath = netanimFile + ".fifo";
+        OutputCompression animCompression = netanimCompress ? OUTPUT_COMPRESSION_LZ4 : compression;
+        if (!animStream.Start(animPath, output.Open(netanimFile, false, animCompression), netanimSample)) {
+            NS_FATAL_ERROR("Cannot create NetAnim stream " << animPath << " -> " << netanimFile);
+        }
+    }
+    anim.reset(new AnimationInterface(animPath));
+    if (netanimMode == "stream") {
+        // AnimationInterface moves to a new trace file after 100000 packets (counted before
+        // sampling), which would close the pipe and send the rest of the run to plain
+        // <file>.fifo-N files; the stream is a single file however many packets it carries
+        anim->SetMaxPktsPerTraceFile(std::numeric_limits<uint64_t>::max());
+    }
+    anim->SetStartTime(Seconds(netanimStart));
+    if (netanimStop > netanimStart) {
+        anim->SetStopTime(Seconds(netanimStop));
+    }
+} else if (netanimMode != "off") {
+    NS_FATAL_ERROR("Unknown --netanim mode: " << netanimMode);
+}
 
-// Position and label Distribution Switches
-anim.SetConstantPosition(distributionSwitches.Get(0), 30.0, 30.0);
-anim.UpdateNodeDescription(distributionSwitches.Get(0), "Dist Switch 0");
-anim.SetConstantPosition(distributionSwitches.Get(1), 70.0, 30.0);
-anim.UpdateNodeDescription(distributionSwitches.Get(1), "Dist Switch 1");
+if (anim) {
+    // Set Positions for Nodes (including labels and colors)
+    anim->SetConstantPosition(coreRouters.Get(0), 50.0, 50.0);
+    anim->UpdateNodeDescription(coreRouters.Get(0), "Core Router");
+    anim->UpdateNodeColor(coreRouters.Get(0), 255, 0, 0);
+
+    // Position and label Distribution Switches
+    anim->SetConstantPosition(distributionSwitches.Get(0), 30.0, 30.0);
+    anim->UpdateNodeDescription(distributionSwitches.Get(0), "Dist Switch 0");
+    anim->SetConstantPosition(distributionSwitches.Get(1), 70.0, 30.0);
+    anim->UpdateNodeDescription(distributionSwitches.Get(1), "Dist Switch 1");
+
+    // Enterprise Clients with labeling
+    for (uint32_t i = 0; i < enterpriseClients.GetN(); ++i) {
+        anim->SetConstantPosition(enterpriseClients.Get(i), 20.0 + i * 10.0, 20.0);
+        anim->UpdateNodeDescription(enterpriseClients.Get(i), "Enterprise Client " + std::to_string(i));
+    }
 
-// Enterprise Clients with labeling
-for (uint32_t i = 0; i < enterpriseClients.GetN(); ++i) {
-    anim.SetConstantPosition(enterpriseClients.Get(i), 20.0 + i * 10.0, 20.0);
-    anim.UpdateNodeDescription(enterpriseClients.Get(i), "Enterprise Client " + std::to_string(i));
-}
+    // Position for Wi-Fi STA Nodes (spread horizontally below enterprise clients)
+    for (uint32_t i = 0; i < wifiStaNodes.GetN(); ++i) {
+        anim->SetConstantPosition(wifiStaNodes.Get(i), 20.0 + i * 10.0, 10.0); // Adjusted X positions for each STA node
+        anim->UpdateNodeDescription(wifiStaNodes.Get(i), "Wi-Fi STA " + std::to_string(i));
+        anim->UpdateNodeColor(wifiStaNodes.Get(i), 0, 0, 255); // Color Wi-Fi STAs blue
+    }
 
-// Position for Wi-Fi STA Nodes (spread horizontally below enterprise clients)
-for (uint32_t i = 0; i < wifiStaNodes.GetN(); ++i) {
-    anim.SetConstantPosition(wifiStaNodes.Get(i), 20.0 + i * 10.0, 10.0); // Adjusted X positions for each STA node
-    anim.UpdateNodeDescription(wifiStaNodes.Get(i), "Wi-Fi STA " + std::to_string(i));
-    anim.UpdateNodeColor(wifiStaNodes.Get(i), 0, 0, 255); // Color Wi-Fi STAs blue
-}
+    // Position for Remote Clients (spread horizontally, positioned below the VPN server)
+    for (uint32_t i = 0; i < remoteClients.GetN(); ++i) {
+        anim->SetConstantPosition(remoteClients.Get(i), 60.0 + i * 10.0, 90.0); // Adjust X positions for each remote client
+        anim->UpdateNodeDescription(remoteClients.Get(i), "Remote Client " + std::to_string(i));
+        anim->UpdateNodeColor(remoteClients.Get(i), 0, 255, 0); // Color Remote Clients green
+    }
 
-// Position for Remote Clients (spread horizontally, positioned below the VPN server)
-for (uint32_t i = 0; i < remoteClients.GetN(); ++i) {
-    anim.SetConstantPosition(remoteClients.Get(i), 60.0 + i * 10.0, 90.0); // Adjust X positions for each remote client
-    anim.UpdateNodeDescription(remoteClients.Get(i), "Remote Client " + std::to_string(i));
-    anim.UpdateNodeColor(remoteClients.Get(i), 0, 255, 0); // Color Remote Clients green
+    // Enable packet metadata for all nodes for a detailed view of traffic
+    anim->EnablePacketMetadata(netanimMetadata);
 }
 
-// Enable packet metadata for all nodes for a detailed view of traffic
-anim.EnablePacketMetadata(true);
-
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Server Setup in the DMZ
 //
@@ -505,6 +1001,7 @@ anim.EnablePacketMetadata(true);
 
 double appStartTime = 1.0;
 double appStopTime = 1500.0;
+double stopTime = (runTime > 0.0) ? runTime : appStopTime;  // Simulation end, shortened by --run-time
 
 NS_LOG_INFO("Setting up Web Server in DMZ...");
 
@@ -1271,6 +1768,12 @@ for (uint32_t i = 0; i < remoteClients.GetN(); ++i) {
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
  
+// Every attack below is also registered in the attack schedule, which is written as
+// attack-schedule.csv (see ids_attack_schedule.h), and its applications are registered with the
+// attack tagger under the instance of their window, so their packets carry the ground truth.
+AttackSchedule attackSchedule;
+AttackTagger attackTagger;
+
  // SYN Flood Attack on HTTP Server
 NS_LOG_INFO("Starting SYN Flood Attack on HTTP Server...");
 
@@ -1280,6 +1783,7 @@ double attackInterval = 0.001;    // Interval between SYN packets
 uint32_t numClients = 3;          // Number of attacking clients (use a subset of remoteClients)
 
 // Configure SYN flood attack on HTTP server
+ApplicationContainer synFloodApps;  // All SYN flood clients, tagged as one attack instance
 for (uint32_t i = 0; i < numClients && i < remoteClients.GetN(); ++i) {
     Ptr<Node> attackerNode = remoteClients.Get(i);
 
@@ -1291,7 +1795,12 @@ for (uint32_t i = 0; i < numClients && i < remoteClients.GetN(); ++i) {
     ApplicationContainer synFloodApp = synFlood.Install(attackerNode);
     synFloodApp.Start(Seconds(attackStartTime + i * 0.1));  // Stagger start slightly for each client
     synFloodApp.Stop(Seconds(attackStopTime));
+    synFloodApps.Add(synFloodApp);
 }
+uint32_t synFloodInstance =
+    attackSchedule.Add(ATTACK_SYN_FLOOD, attackStartTime, attackStopTime, webServerIp.Get(), httpPort, 6,
+                      ScheduleAddresses(remoteClients, numClients));
+attackTagger.Register(synFloodApps, synFloodInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1304,6 +1813,7 @@ uint32_t floodClients = 3;          // Number of attacking clients (subset of en
 DataRate floodDataRate("100Mbps");   // High data rate for flood
 
 // Configure UDP flood on DNS server
+ApplicationContainer udpFloodApps;  // All UDP flood clients, tagged as one attack instance
 for (uint32_t i = 0; i < floodClients && i < enterpriseClients.GetN(); ++i) {
     Ptr<Node> attackerNode = enterpriseClients.Get(i);
 
@@ -1315,7 +1825,12 @@ for (uint32_t i = 0; i < floodClients && i < enterpriseClients.GetN(); ++i) {
     ApplicationContainer udpFloodApp = udpFlood.Install(attackerNode);
     udpFloodApp.Start(Seconds(udpFloodStartTime + i * 0.1));  // Slightly stagger each start time
     udpFloodApp.Stop(Seconds(udpFloodStopTime));
+    udpFloodApps.Add(udpFloodApp);
 } 
+uint32_t udpFloodInstance =
+    attackSchedule.Add(ATTACK_UDP_FLOOD, udpFloodStartTime, udpFloodStopTime, dnsServerIp.Get(), dnsPort, 17,
+                      ScheduleAddresses(enterpriseClients, floodClients));
+attackTagger.Register(udpFloodApps, udpFloodInstance);
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1329,6 +1844,7 @@ uint32_t icmpFloodClients = 3;       // Number of clients initiating the ICMP fl
 // ICMP flood targeting the core router
 Ipv4Address coreRouterIp = coreRouters.Get(0)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();  // Get the IP of core router
 
+ApplicationContainer icmpFloodApps;  // All ICMP flood clients, tagged as one attack instance
 for (uint32_t i = 0; i < icmpFloodClients && i < wifiStaNodes.GetN(); ++i) {
     Ptr<Node> attackerNode = wifiStaNodes.Get(i);
 
@@ -1342,7 +1858,12 @@ for (uint32_t i = 0; i < icmpFloodClients && i < wifiStaNodes.GetN(); ++i) {
     ApplicationContainer icmpFloodApp = icmpFloodHelper.Install(attackerNode);
     icmpFloodApp.Start(Seconds(icmpFloodStartTime + i * 0.1));  // Slightly stagger each start time
     icmpFloodApp.Stop(Seconds(icmpFloodStopTime));
+    icmpFloodApps.Add(icmpFloodApp);
 } 
+uint32_t icmpFloodInstance =
+    attackSchedule.Add(ATTACK_ICMP_FLOOD, icmpFloodStartTime, icmpFloodStopTime, coreRouterIp.Get(), 0, 0,
+                      ScheduleAddresses(wifiStaNodes, icmpFloodClients));
+attackTagger.Register(icmpFloodApps, icmpFloodInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Port Scanning Attack on HTTP/HTTPS Server in DMZ
@@ -1357,6 +1878,7 @@ Ipv4Address targetServerIp = dmzInterfaces.GetAddress(0);
 std::vector<uint16_t> portsToScan = {21, 22, 25, 53, 80, 110, 123, 143, 179, 443, 500, 587};  // Removed duplicate 80
 
 // Set up a scan from multiple clients
+ApplicationContainer portScanApps;  // All port scan connections, tagged as one attack instance
 for (uint32_t i = 0; i < numScanClients && i < wifiStaNodes.GetN(); ++i) {
     Ptr<Node> attackerNode = wifiStaNodes.Get(i);
 
@@ -1369,8 +1891,13 @@ for (uint32_t i = 0; i < numScanClients && i < wifiStaNodes.GetN(); ++i) {
         ApplicationContainer portScanApp = portScanHelper.Install(attackerNode);
         portScanApp.Start(Seconds(scanStartTime + i * 0.1 + port * 0.01));  // Stagger slightly for each port
         portScanApp.Stop(Seconds(scanStopTime));
+        portScanApps.Add(portScanApp);
     }
 }
+uint32_t portScanInstance =
+    attackSchedule.Add(ATTACK_PORT_SCAN, scanStartTime, scanStopTime, targetServerIp.Get(), 0, 6,
+                      ScheduleAddresses(wifiStaNodes, numScanClients));  // Every scanned port
+attackTagger.Register(portScanApps, portScanInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Man-in-the-Middle (MitM) Simulation: Redirect HTTP Traffic to a Fake Server
@@ -1398,6 +1925,7 @@ double redirectStopTime = 313.0;    // Stop time for redirection (revised from 6
 uint32_t numMitmClients = 2;        // Number of clients affected by the MitM attack
 
 // Configure clients to connect to the fake server
+ApplicationContainer mitmHttpClientApps;  // All redirected clients, tagged as one attack instance
 for (uint32_t i = 0; i < numMitmClients && i < enterpriseClients.GetN(); ++i) {
     Ptr<Node> mitmClientNode = enterpriseClients.Get(i);
 
@@ -1409,7 +1937,12 @@ for (uint32_t i = 0; i < numMitmClients && i < enterpriseClients.GetN(); ++i) {
     ApplicationContainer mitmHttpClientApp = mitmHttpClientHelper.Install(mitmClientNode);
     mitmHttpClientApp.Start(Seconds(redirectStartTime + i * 0.1));  // Slight stagger for each client
     mitmHttpClientApp.Stop(Seconds(redirectStopTime));
+    mitmHttpClientApps.Add(mitmHttpClientApp);
 }
+uint32_t mitmInstance =
+    attackSchedule.Add(ATTACK_MITM, redirectStartTime, redirectStopTime, fakeServerIp.Get(), fakeHttpPort, 6,
+                      ScheduleAddresses(enterpriseClients, numMitmClients));
+attackTagger.Register(mitmHttpClientApps, mitmInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Brute Force Attack on FTP Server
@@ -1423,6 +1956,7 @@ uint32_t numAttackClients = 3;        // Number of clients involved in brute for
 // Configure brute force attack on FTP server
 //Ipv4Address ftpServerIp = dmzInterfaces.GetAddress(3);  // IP of the FTP server in DMZ
 
+ApplicationContainer bruteForceApps;  // All FTP brute force attempts, tagged as one attack instance
 for (uint32_t i = 0; i < numAttackClients && i < remoteClients.GetN(); ++i) {
     Ptr<Node> attackerNode = remoteClients.Get(i);
 
@@ -1435,8 +1969,13 @@ for (uint32_t i = 0; i < numAttackClients && i < remoteClients.GetN(); ++i) {
         ApplicationContainer bruteForceApp = bruteForceHelper.Install(attackerNode);
         bruteForceApp.Start(Seconds(bruteForceStartTime + i * 0.1 + attempt * 0.5));  // Staggered timing for each attempt
         bruteForceApp.Stop(Seconds(bruteForceStopTime));
+        bruteForceApps.Add(bruteForceApp);
     }
 }
+uint32_t bruteForceInstance =
+    attackSchedule.Add(ATTACK_FTP_BRUTE_FORCE, bruteForceStartTime, bruteForceStopTime, ftpServerIp.Get(), ftpPort, 6,
+                      ScheduleAddresses(remoteClients, numAttackClients));
+attackTagger.Register(bruteForceApps, bruteForceInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // SQL Injection Simulation on HTTP Server
@@ -1460,6 +1999,7 @@ std::vector<std::string> sqlPayloads = {
 // Configure SQL injection attempts on HTTP server
 Ipv4Address httpServerIp = dmzInterfaces.GetAddress(0);  // IP of the HTTP server in DMZ
 
+ApplicationContainer sqlInjectionApps;  // All SQL injection payloads, tagged as one attack instance
 for (uint32_t i = 0; i < sqlInjectionClients && i < enterpriseClients.GetN(); ++i) {
     Ptr<Node> attackerNode = enterpriseClients.Get(i);
 
@@ -1477,8 +2017,13 @@ for (uint32_t i = 0; i < sqlInjectionClients && i < enterpriseClients.GetN(); ++
         ApplicationContainer sqlInjectionApp = sqlInjectionHelper.Install(attackerNode);
         sqlInjectionApp.Start(Seconds(sqlInjectionStartTime + i * 0.1 + payloadIndex * 0.5));  // Staggered payload delivery
         sqlInjectionApp.Stop(Seconds(sqlInjectionStopTime));
+        sqlInjectionApps.Add(sqlInjectionApp);
     }
 } 
+uint32_t sqlInjectionInstance =
+    attackSchedule.Add(ATTACK_SQL_INJECTION, sqlInjectionStartTime, sqlInjectionStopTime, httpServerIp.Get(), httpPort, 6,
+                      ScheduleAddresses(enterpriseClients, sqlInjectionClients));
+attackTagger.Register(sqlInjectionApps, sqlInjectionInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Brute Force Attack on SSH Server
@@ -1492,6 +2037,7 @@ uint32_t sshAttackClients = 3;           // Number of clients involved in SSH br
 // Configure brute force attack on SSH server
 Ipv4Address sshServerIp = dmzInterfaces.GetAddress(3);  // Assume the SSH server is on dmzServers.Get(3)
 
+ApplicationContainer sshBruteForceApps;  // All SSH brute force attempts, tagged as one attack instance
 for (uint32_t i = 0; i < sshAttackClients && i < remoteClients.GetN(); ++i) {
     Ptr<Node> attackerNode = remoteClients.Get(i);
 
@@ -1502,8 +2048,13 @@ for (uint32_t i = 0; i < sshAttackClients && i < remoteClients.GetN(); ++i) {
         ApplicationContainer sshBruteForceApp = sshBruteForceHelper.Install(attackerNode);
         sshBruteForceApp.Start(Seconds(sshBruteForceStartTime + i * 0.2 + attempt * 0.2));  // Staggered attempts
         sshBruteForceApp.Stop(Seconds(sshBruteForceStopTime));
+        sshBruteForceApps.Add(sshBruteForceApp);
     }
 }
+uint32_t sshBruteForceInstance =
+    attackSchedule.Add(ATTACK_SSH_BRUTE_FORCE, sshBruteForceStartTime, sshBruteForceStopTime, sshServerIp.Get(), sshPort, 6,
+                      ScheduleAddresses(remoteClients, sshAttackClients));
+attackTagger.Register(sshBruteForceApps, sshBruteForceInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // FTP Login Attempt Flood on FTP Server
@@ -1517,6 +2068,7 @@ uint32_t ftpAttackClients = 2;           // Number of clients involved in FTP br
 // Configure brute force attack on FTP server
 //Ipv4Address ftpServerIp = dmzInterfaces.GetAddress(3);  // Assume the FTP server is also on dmzServers.Get(3)
 
+ApplicationContainer ftpBruteForceApps;  // All FTP login attempts, tagged as one attack instance
 for (uint32_t i = 0; i < ftpAttackClients && i < enterpriseClients.GetN(); ++i) {
     Ptr<Node> attackerNode = enterpriseClients.Get(i);
 
@@ -1527,8 +2079,13 @@ for (uint32_t i = 0; i < ftpAttackClients && i < enterpriseClients.GetN(); ++i)
         ApplicationContainer ftpBruteForceApp = ftpBruteForceHelper.Install(attackerNode);
         ftpBruteForceApp.Start(Seconds(ftpBruteForceStartTime + i * 0.1 + attempt * 0.1));  // Staggered attempts
         ftpBruteForceApp.Stop(Seconds(ftpBruteForceStopTime));
+        ftpBruteForceApps.Add(ftpBruteForceApp);
     }
 }
+uint32_t ftpBruteForceInstance =
+    attackSchedule.Add(ATTACK_FTP_LOGIN_FLOOD, ftpBruteForceStartTime, ftpBruteForceStopTime, ftpServerIp.Get(), ftpPort, 6,
+                      ScheduleAddresses(enterpriseClients, ftpAttackClients));
+attackTagger.Register(ftpBruteForceApps, ftpBruteForceInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Botnet C&C Communication Simulation
@@ -1553,6 +2110,7 @@ double botCommStopTime = 607.0;       // End time for bot communication (revised
 uint32_t botClients = 3;              // Number of bot clients
 DataRate botDataRate("500kbps");      // Low data rate typical for botnet communication
 
+ApplicationContainer botCommApps;  // All bot clients, tagged as one attack instance
 for (uint32_t i = 0; i < botClients && i < wifiStaNodes.GetN(); ++i) {
     Ptr<Node> botNode = wifiStaNodes.Get(i);
 
@@ -1567,7 +2125,12 @@ for (uint32_t i = 0; i < botClients && i < wifiStaNodes.GetN(); ++i) {
     ApplicationContainer botCommApp = botCommHelper.Install(botNode);
     botCommApp.Start(Seconds(botCommStartTime + i * 0.2));  // Slightly staggered start times
     botCommApp.Stop(Seconds(botCommStopTime));
+    botCommApps.Add(botCommApp);
 }
+uint32_t botCommInstance =
+    attackSchedule.Add(ATTACK_BOTNET, botCommStartTime, botCommStopTime, cncServerIp.Get(), cncPort, 6,
+                      ScheduleAddresses(wifiStaNodes, botClients));
+attackTagger.Register(botCommApps, botCommInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // VPN Tunnel Flooding Attack on VPN Server
@@ -1582,6 +2145,7 @@ DataRate vpnFloodDataRate("50Mbps");    // High data rate for flooding
 Ipv4Address vpnServerIp = vpnInterfaces.GetAddress(0);  // Assuming the VPN server IP is the first address in vpnInterfaces
 uint16_t vpnPort = 443;                                // Typical VPN port (can adjust based on your setup)
 
+ApplicationContainer vpnFloodApps;  // All VPN flood clients, tagged as one attack instance
 for (uint32_t i = 0; i < vpnFloodClients && i < remoteClients.GetN(); ++i) {
     Ptr<Node> floodNode = remoteClients.Get(i);
 
@@ -1593,7 +2157,12 @@ for (uint32_t i = 0; i < vpnFloodClients && i < remoteClients.GetN(); ++i) {
     ApplicationContainer vpnFloodApp = vpnFloodHelper.Install(floodNode);
     vpnFloodApp.Start(Seconds(vpnFloodStartTime + i * 0.1));  // Slight staggered start for each client
     vpnFloodApp.Stop(Seconds(vpnFloodStopTime));
+    vpnFloodApps.Add(vpnFloodApp);
 }
+uint32_t vpnFloodInstance =
+    attackSchedule.Add(ATTACK_VPN_FLOOD, vpnFloodStartTime, vpnFloodStopTime, vpnServerIp.Get(), vpnPort, 6,
+                      ScheduleAddresses(remoteClients, vpnFloodClients));
+attackTagger.Register(vpnFloodApps, vpnFloodInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Credential Stuffing Attack on VPN Server
@@ -1607,6 +2176,7 @@ uint32_t stuffingClients = 3;                   // Number of clients involved in
 // Configure credential stuffing attack targeting the VPN server
 //Ipv4Address vpnServerIp = vpnInterfaces.GetAddress(0);  // Assuming the VPN server IP is the first address in vpnInterfaces
 
+ApplicationContainer credentialStuffingApps;  // All credential stuffing attempts, tagged as one attack instance
 for (uint32_t i = 0; i < stuffingClients && i < remoteClients.GetN(); ++i) {
     Ptr<Node> stuffingNode = remoteClients.Get(i);
 
@@ -1619,8 +2189,13 @@ for (uint32_t i = 0; i < stuffingClients && i < remoteClients.GetN(); ++i) {
         ApplicationContainer credentialStuffingApp = credentialStuffingHelper.Install(stuffingNode);
         credentialStuffingApp.Start(Seconds(credentialStuffingStartTime + i * 0.2 + attempt * 0.1));  // Staggered attempts
         credentialStuffingApp.Stop(Seconds(credentialStuffingStopTime));
+        credentialStuffingApps.Add(credentialStuffingApp);
     }
 }
+uint32_t credentialStuffingInstance =
+    attackSchedule.Add(ATTACK_CREDENTIAL_STUFFING, credentialStuffingStartTime, credentialStuffingStopTime,
+                      vpnServerIp.Get(), vpnPort, 6, ScheduleAddresses(remoteClients, stuffingClients));
+attackTagger.Register(credentialStuffingApps, credentialStuffingInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // XSS Attack
@@ -1642,6 +2217,7 @@ std::vector<std::string> xssPayloads = {
 };
 
 // Loop over client nodes to install XSS traffic-generating applications
+ApplicationContainer xssAttackApps;  // All XSS payloads, tagged as one attack instance
 for (uint32_t i = 0; i < xssClients && i < enterpriseClients.GetN(); ++i) {
     Ptr<Node> attackerNode = enterpriseClients.Get(i);
 
@@ -1657,8 +2233,13 @@ for (uint32_t i = 0; i < xssClients && i < enterpriseClients.GetN(); ++i) {
         ApplicationContainer xssAttackApp = xssAttack.Install(attackerNode);
         xssAttackApp.Start(Seconds(xssStartTime + i * 0.1 + payloadIndex * 0.2));  // Staggered start for each payload
         xssAttackApp.Stop(Seconds(xssStopTime));
+        xssAttackApps.Add(xssAttackApp);
     }
 }
+uint32_t xssInstance =
+    attackSchedule.Add(ATTACK_XSS, xssStartTime, xssStopTime, httpServerIp.Get(), httpPort, 6,
+                      ScheduleAddresses(enterpriseClients, xssClients));
+attackTagger.Register(xssAttackApps, xssInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ARP Spoofing
@@ -1684,6 +2265,10 @@ arpPoisoningApp.SetAttribute("PacketSize", UintegerValue(128));  // Small packet
 ApplicationContainer arpPoisonApp = arpPoisoningApp.Install(maliciousNode);
 arpPoisonApp.Start(Seconds(arpPoisonStartTime));
 arpPoisonApp.Stop(Seconds(arpPoisonStopTime));
+uint32_t arpPoisonInstance =
+    attackSchedule.Add(ATTACK_ARP_SPOOFING, arpPoisonStartTime, arpPoisonStopTime, targetIp.Get(), 80, 17,
+                      {attackerIp.Get()});
+attackTagger.Register(arpPoisonApp, arpPoisonInstance);
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1720,6 +2305,11 @@ zeroDayAppHttps.SetAttribute("PacketSize", UintegerValue(1024));
 ApplicationContainer zeroDayExploitAppHttps = zeroDayAppHttps.Install(attackerNodeZeroDay);
 zeroDayExploitAppHttps.Start(Seconds(zeroDayStartTime));
 zeroDayExploitAppHttps.Stop(Seconds(zeroDayStopTime));
+uint32_t zeroDayInstance =
+    attackSchedule.Add(ATTACK_ZERO_DAY, zeroDayStartTime, zeroDayStopTime, targetIpZeroDay.Get(), 0, 6,
+                      {ScheduleAddress(attackerNodeZeroDay)});  // HTTP and HTTPS
+attackTagger.Register(zeroDayExploitApp, zeroDayInstance);
+attackTagger.Register(zeroDayExploitAppHttps, zeroDayInstance);
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // DDoS Attack 
@@ -1742,6 +2332,7 @@ ddosAttackers.push_back(wifiStaNodes.Get(1));       // Example from Wi-Fi client
 ddosAttackers.push_back(remoteClients.Get(2));      // Example from remote clients
 
 // Configure the attack on each selected attacker node
+ApplicationContainer ddosAttackApps;  // All DDoS attackers, tagged as one attack instance
 for (uint32_t i = 0; i < ddosAttackers.size(); ++i) {
     Ptr<Node> attackerNode = ddosAttackers[i];
 
@@ -1753,10 +2344,16 @@ for (uint32_t i = 0; i < ddosAttackers.size(); ++i) {
     ApplicationContainer ddosAttackApp = ddosAttackHelper.Install(attackerNode);
     ddosAttackApp.Start(Seconds(ddosStartTime + i * 0.5)); // Stagger each attacker’s start time
     ddosAttackApp.Stop(Seconds(ddosStopTime));
+    ddosAttackApps.Add(ddosAttackApp);
 }
-
-// Enable PCAP capture on the target server for analysis
-csmaDmz.EnablePcap("ddos-attack-traffic", ddosTargetNode->GetId(), true); // Capture on the target server
+std::vector<uint32_t> ddosAddresses;
+for (Ptr<Node> attackerNode : ddosAttackers) {
+    ddosAddresses.push_back(ScheduleAddress(attackerNode));
+}
+uint32_t ddosInstance =
+    attackSchedule.Add(ATTACK_DDOS, ddosStartTime, ddosStopTime, ddosTargetIp.Get(), ddosTargetPort, 17, ddosAddresses);
+attackTagger.Register(ddosAttackApps, ddosInstance);
+// The DDoS target is captured as the ddos-attack-traffic view of the DMZ tap (see the PCAP section)
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Network Configuration: Enabling Routing and IP Forwarding
@@ -1845,56 +2442,115 @@ Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 // - Provides a mechanism for post-simulation forensic analysis.
 //
 // **Configuration Highlights**:
-// - Promiscuous mode (`true`) is enabled for each PCAP capture to include all packets on the respective link.
-// - Files are named to reflect the target device or attack being monitored for clarity.
+// - Each physical segment is captured once, promiscuously, into one file named after its first view.
+// - The other monitoring points are views on those files, listed with a filter in `capture-index.csv`.
 //
 // This configuration is essential for monitoring network behavior under normal and attack conditions.
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-// Capturing All Traffic in a Single PCAP File
-
-pointToPoint.EnablePcap("all-network-traffic", coreRouters.Get(0)->GetDevice(0), true);  // Set promiscuous mode to true
-
+// Taps are deduplicated by segment: every view on the DMZ bus shares one file, and both ends of the
+// core-to-distribution-switch-0 link share another. The first view registered on a segment names
+// its file. The former all-network-traffic capture tapped the core router's loopback device and never
+// produced a file; the core views below cover the routed traffic instead.
+CaptureManager captureManager;
+LabelIndexWriter labelIndex;
 
 NS_LOG_INFO("Enabling PCAP files on critical points for attack monitoring...");
 
 // 1. VPN Server Node: Capture VPN-related traffic for attacks like Credential Stuffing and Tunnel Flooding
-vpnLink.EnablePcap("vpn-server-traffic", vpnToCore.Get(0), true);  // Device 0 on VPN server end of vpnToCore link
+captureManager.AddView("vpn-server-traffic", vpnToCore.Get(0));  // VPN server end of vpnToCore link
 
-// 2. DMZ Servers - Monitoring HTTP, HTTPS, FTP, SSH, and DNS servers
+// 2. DMZ Servers - Monitoring HTTP, HTTPS, FTP, SSH, and DNS servers on the shared DMZ bus
 
 // HTTP/HTTPS Server: Capture SYN Flood, SQL Injection, HTTP Spoofing
-csmaDmz.EnablePcap("http-https-server-traffic", dmzServers.Get(0)->GetDevice(1), true); // Device 1 for HTTP/HTTPS on dmzServers.Get(0)
+captureManager.AddView("http-https-server-traffic", dmzServers.Get(0)->GetDevice(1),
+                       ServerFilter(webServerIp, "tcp port 80 or tcp port 443"));
 
 // FTP Server: Capture FTP Login Attempt Flood and Brute Force
-csmaDmz.EnablePcap("ftp-server-traffic", dmzServers.Get(3)->GetDevice(1), true); // Device 1 for FTP on dmzServers.Get(3)
+captureManager.AddView("ftp-server-traffic", dmzServers.Get(3)->GetDevice(1), ServerFilter(ftpServerIp, "tcp port 21"));
 
-// SSH Server: Capture SSH Brute Force attempts
-csmaDmz.EnablePcap("ssh-server-traffic", dmzServers.Get(3)->GetDevice(1), true); // Device 1 for SSH on dmzServers.Get(3)
+// SSH Server: Capture SSH Brute Force attempts (same server as FTP)
+captureManager.AddView("ssh-server-traffic", dmzServers.Get(3)->GetDevice(1), ServerFilter(ftpServerIp, "tcp port 22"));
 
 // DNS Server: Capture UDP Flood targeting DNS
-csmaDmz.EnablePcap("dns-server-traffic", dmzServers.Get(2)->GetDevice(1), true); // Device 1 for DNS on dmzServers.Get(2)
+captureManager.AddView("dns-server-traffic", dmzServers.Get(2)->GetDevice(1), ServerFilter(dnsServerIp, "udp port 53"));
 
 // Botnet C&C Server: Capture communication to/from bot nodes
-csmaDmz.EnablePcap("botnet-cnc-server-traffic", dmzServers.Get(4)->GetDevice(1), true); // Device 1 for Botnet C&C on dmzServers.Get(4)
+captureManager.AddView("botnet-cnc-server-traffic", dmzServers.Get(4)->GetDevice(1),
+                       ServerFilter(cncServerIp, "tcp port 9999"));
 
-// 3. Core Router - Enable PCAP to capture all traffic passing through the core
-pointToPoint.EnablePcap("core-router-traffic", p2pDevices1.Get(0), true);  // Confirmed Device 0 for core router’s link to dist switch 0
+// DDoS Target: UDP flood against the web server
+captureManager.AddView("ddos-attack-traffic", ddosTargetNode->GetDevice(1), ServerFilter(ddosTargetIp, "udp port 80"));
+
+// 3. Core Router - Capture all traffic passing through the core's link to distribution switch 0
+captureManager.AddView("core-router-traffic", p2pDevices1.Get(0));
 
 // 4. Distribution and Access Switches - Capturing intra-network traffic flow
 
-// Distribution Switch 0: Enable PCAP to capture traffic between Core Router and Enterprise network
-pointToPoint.EnablePcap("distribution-switch-0-traffic", p2pDevices1.Get(1), true);  // Device 1 for dist switch 0’s link to core router
+// Distribution Switch 0: same link as the core router view
+captureManager.AddView("distribution-switch-0-traffic", p2pDevices1.Get(1));
 
 // Distribution Switch 1: Capture traffic between Core Router and DMZ network
-pointToPoint.EnablePcap("distribution-switch-1-traffic", p2pDevices2.Get(1), true); // Device 1 for dist switch 1’s link to core router
+captureManager.AddView("distribution-switch-1-traffic", p2pDevices2.Get(1));
+
+// Access Switch: enterprise clients
+captureManager.AddView("access-switch-traffic", accessSwitchesHR.Get(0)->GetDevice(1));
+
+// 5. Wi-Fi Access Point
+captureManager.AddView("wifi-ap-traffic", wifiApDevice.Get(0));
 
-// Access Switch: Already generated and confirmed
-csmaEnterprise.EnablePcap("access-switch-traffic", accessSwitchesHR.Get(0)->GetDevice(1), true); // Device 1 on access switch for enterprise clients
+if (capture) {
+    if (captureFormat != "pcap" && captureFormat != "pcapng") {
+        NS_FATAL_ERROR("Unknown --capture-format: " << captureFormat);
+    }
+    CaptureFormat format = (captureFormat == "pcapng") ? CAPTURE_FORMAT_PCAPNG : CAPTURE_FORMAT_PCAP;
+    captureManager.SetSnapLen(captureSnapLen);
+    if (!captureManager.SetSnapLens(captureSnapLens)) {
+        NS_FATAL_ERROR("Invalid --capture-snaplen-views: " << captureSnapLens);
+    }
+    std::string filterError;
+    if (!captureManager.SetWriteFilters(captureWriteFilters, &filterError)) {
+        NS_FATAL_ERROR("Invalid --capture-write-filters: " << filterError);
+    }
+    captureManager.SetRotation(captureRotate, captureRotateAttacks);
+    captureManager.SetCompression(compression);
+    if (captureOverflow != "block" && captureOverflow != "drop") {
+        NS_FATAL_ERROR("Unknown --capture-overflow: " << captureOverflow);
+    }
+    captureManager.SetOverflow(captureOverflow == "drop" ? OUTPUT_OVERFLOW_DROP : OUTPUT_OVERFLOW_BLOCK);
+    captureManager.SetTagLabels(tagLabels);
+    if (captureLabelIndex != "off") {
+        if (captureLabelIndex != "all" && captureLabelIndex != "attack") {
+            NS_FATAL_ERROR("Unknown --capture-label-index: " << captureLabelIndex);
+        }
+        if (!labelIndex.Open(output.Open(captureLabelIndexFile), captureLabelIndex == "attack")) {
+            NS_FATAL_ERROR("Cannot open capture label index " << captureLabelIndexFile);
+        }
+        captureManager.SetLabelIndex(&labelIndex);
+    }
+    if (!captureManager.Open(output, format, &attackSchedule, stopTime)) {
+        NS_FATAL_ERROR("Cannot open PCAP capture files");
+    }
+    if (!captureManager.WriteIndex(output.Open(captureIndexFile))) {
+        NS_FATAL_ERROR("Cannot open capture index " << captureIndexFile);
+    }
+}
 
-// 5. Wi-Fi Access Point (Missing file)
-wifiPhy.EnablePcap("wifi-ap-traffic", wifiApDevice.Get(0), 0);  // Explicit capture on the AP's Wi-Fi device
+// Flow features are metered on the core router's link to distribution switch 0 and on the DMZ bus,
+// the two points the dataset's flows are taken from; each tap writes its own CSV like a capture.
+FlowFeatureExtractor flowExtractor;
+if (flowFeatures) {
+    flowExtractor.AddTap("core-router", p2pDevices1.Get(0));
+    flowExtractor.AddTap("dmz", dmzServers.Get(0)->GetDevice(1));
+    flowExtractor.SetTimeouts(flowTimeout, flowIdleTimeout, flowActivityTimeout);
+    flowExtractor.SetCapacity(flowTableCapacity);
+    flowExtractor.SetThreads(flowFeatureThreads);
+    flowExtractor.SetTagLabels(tagLabels);
+    if (!flowExtractor.Open(output, &attackSchedule)) {
+        NS_FATAL_ERROR("Cannot open flow feature files");
+    }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Flow Monitoring and Simulation Finalization
@@ -1904,7 +2560,8 @@ wifiPhy.EnablePcap("wifi-ap-traffic", wifiApDevice.Get(0), 0);  // Explicit capt
 // Key Features:
 // 1. **Flow Monitor**:
 //    - Tracks traffic statistics (throughput, delay, jitter, packet loss) for all network nodes.
-//    - Results are saved to `flowmon-results.xml` for analysis.
+//    - Idle flows are written to `flowmon-flows.csv` during the run (or `flowmon-results.xml` at the end
+//      with --flowmon=xml).
 //
 // 2. **Packet Tracing (Optional)**:
 //    - Enables packet metadata and routing table tracking for visualization and debugging.
@@ -1913,14 +2570,33 @@ wifiPhy.EnablePcap("wifi-ap-traffic", wifiApDevice.Get(0), 0);  // Explicit capt
 //    - Runs the simulation, saves results, and cleans up resources.
 //
 // Outputs:
-// - `flowmon-results.xml`: Detailed traffic flow statistics.
+// - `flowmon-flows.csv`: Per-flow traffic statistics, written as flows go idle.
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     ///////////////////////////////
     // Flow Monitor (Optional)
     ///////////////////////////////
+    memoryTracker.Checkpoint("applications");
+    if (flowmonMode != "incremental" && flowmonMode != "xml") {
+        NS_FATAL_ERROR("Unknown --flowmon: " << flowmonMode);
+    }
     FlowMonitorHelper flowmonHelper;
+    if (flowmonMode == "incremental") {
+        // The records carry sums only; one-bin histograms stop growing with the delay and gap range
+        flowmonHelper.SetMonitorAttribute("DelayBinWidth", DoubleValue(FLOWMON_EXPORT_BIN_WIDTH));
+        flowmonHelper.SetMonitorAttribute("JitterBinWidth", DoubleValue(FLOWMON_EXPORT_BIN_WIDTH));
+        flowmonHelper.SetMonitorAttribute("PacketSizeBinWidth", DoubleValue(FLOWMON_EXPORT_BIN_WIDTH));
+        flowmonHelper.SetMonitorAttribute("FlowInterruptionsBinWidth", DoubleValue(FLOWMON_EXPORT_BIN_WIDTH));
+    }
     Ptr<FlowMonitor> flowmon = flowmonHelper.InstallAll();  // Install on all nodes
+    memoryTracker.SetFlowMonitor(flowmon);
+    FlowMonitorExporter flowmonExporter;
+    if (flowmonMode == "incremental" &&
+        !flowmonExporter.Open(output.Open(flowmonExportFile, false, compression), flowmon,
+                              DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier()), Seconds(flowmonInterval),
+                              Seconds(flowmonIdleTimeout))) {
+        NS_FATAL_ERROR("Cannot open FlowMonitor export " << flowmonExportFile);
+    }
     //flowmon->SerializeToXmlFile("flowmon-results.xml", true, true);
     
 
@@ -1929,13 +2605,227 @@ wifiPhy.EnablePcap("wifi-ap-traffic", wifiApDevice.Get(0), 0);  // Explicit capt
     //anim.EnablePacketMetadata(true);  // Records packet details
     //anim.EnableIpv4RouteTracking("routingtable-trace.xml", Seconds(0), Seconds(20), Seconds(0.25));  // Record route changes
     
+    ///////////////////////////////
+    // Packet Event Tracing (Optional)
+    ///////////////////////////////
+    // Text mode keeps the original per-packet NS_LOG output; binary mode writes fixed-size records
+    // through the ring-buffer tracer and can be decoded afterwards with ids_trace_decoder.
+    PacketTracer packetTracer;
+    if (packetTraceMode == "binary") {
+        if (!packetTracer.Open(output.Open(packetTraceFile), packetTraceBuffer)) {
+            NS_FATAL_ERROR("Cannot open packet trace file " << packetTraceFile);
+        }
+        ConnectPacketTrace(&packetTracer);
+    } else if (packetTraceMode == "text") {
+        ConnectPacketTrace(nullptr);
+    } else if (packetTraceMode != "off") {
+        NS_FATAL_ERROR("Unknown --packet-trace mode: " << packetTraceMode);
+    }
+
+    ///////////////////////////////
+    // Wi-Fi PHY Tracing (Optional)
+    ///////////////////////////////
+    // Summary mode keeps per-station, per-mode counters and SNR/size histograms and writes them every
+    // wifi-trace-interval seconds; text mode keeps the original per-frame NS_LOG output.
+    WifiPhyStats wifiStats;
+    if (wifiTraceMode == "summary" || wifiTraceMode == "text") {
+        WifiPhyStats* stats = nullptr;
+        if (wifiTraceMode == "summary") {
+            if (!wifiStats.Open(output.Open(wifiTraceFile))) {
+                NS_FATAL_ERROR("Cannot open Wi-Fi summary file " << wifiTraceFile);
+            }
+            stats = &wifiStats;
+            Simulator::Schedule(Seconds(wifiTraceInterval), &FlushWifiStats, stats, Seconds(wifiTraceInterval));
+        }
+        ConnectWifiTrace(stats, wifiApDevice.Get(0), "ap");
+        for (uint32_t i = 0; i < wifiStaDevices.GetN(); ++i) {
+            ConnectWifiTrace(stats, wifiStaDevices.Get(i), "sta-" + std::to_string(i));
+        }
+    } else if (wifiTraceMode != "off") {
+        NS_FATAL_ERROR("Unknown --wifi-trace mode: " << wifiTraceMode);
+    }
+
+    ///////////////////////////////
+    // Packet Ground Truth
+    ///////////////////////////////
+    // With tag labels, the packets of the attack applications and the replies to them carry an
+    // AttackTag from the moment they enter the IPv4 stack; the labelled outputs read it from there.
+    bool labelledOutput = capture || flowFeatures || packetExportMode == "columnar" || packetTraceMode == "binary";
+    if (tagLabels && labelledOutput) {
+        attackTagger.Attach(&attackSchedule);
+    }
+
+    // The label columns of the packet records and the pcapng captures refer to the attack schedule,
+    // and ids_capture_splitter reads it to split the captures
+    if (packetExportMode == "columnar" || capture) {
+        if (!attackSchedule.WriteCsv(output.Open(attackScheduleFile))) {
+            NS_FATAL_ERROR("Cannot open attack schedule file " << attackScheduleFile);
+        }
+    }
+
+    ///////////////////////////////
+    // Packet Record Export (Optional)
+    ///////////////////////////////
+    // Columnar mode writes one row per IPv4 packet sent or received by any node, labelled from its
+    // AttackTag (or the attack schedule with --label-source=window), so training jobs can read
+    // packet fields without parsing the PCAP files.
+    ColumnarPacketExporter packetExporter;
+    if (packetExportMode == "columnar") {
+        if (!packetExporter.Open(output.Open(packetExportFile), packetExportRows,
+                                 tagLabels ? nullptr : &attackSchedule)) {
+            NS_FATAL_ERROR("Cannot open packet export file " << packetExportFile);
+        }
+        ConnectPacketExport(&packetExporter);
+    } else if (packetExportMode != "off") {
+        NS_FATAL_ERROR("Unknown --packet-export mode: " << packetExportMode);
+    }
+
+    ///////////////////////////////
+    // Throughput Profiling (Optional)
+    ///////////////////////////////
+    // One timeline row per profile-interval, tagged with the active attack phase.
+    SimulationProfiler profiler;
+    if (profile) {
+        if (!profiler.Open(output.Open(profileFile), Seconds(profileInterval), &attackSchedule)) {
+            NS_FATAL_ERROR("Cannot open profiler timeline " << profileFile);
+        }
+    }
+
+    ///////////////////////////////
+    // Application Attribution (Optional)
+    ///////////////////////////////
+    // Every application installed above is registered with a role derived from its peer and the
+    // attack schedule; packets are counted through the applications' own traces.
+    AppAttribution appAttribution;
+    if (appReport) {
+        appAttribution.Attach(&attackSchedule);
+    }
+
+    // Traffic mix for benchmark variants: clients outside the selected class never start
+    if (trafficMix == "benign" || trafficMix == "attack") {
+        uint32_t disabled = ApplyTrafficMix(trafficMix, &attackSchedule, Seconds(stopTime + 1.0));
+        NS_LOG_INFO("Traffic mix " << trafficMix << ": " << disabled << " clients disabled");
+    } else if (trafficMix != "all") {
+        NS_FATAL_ERROR("Unknown --traffic mix: " << trafficMix);
+    }
+
+    ///////////////////////////////
+    // Memory Tracking (Optional)
+    ///////////////////////////////
+    // Samples during the run are charged to the attack phase active at the sample time.
+    if (memTrack) {
+        memoryTracker.Checkpoint("tracing");
+        memoryTracker.StartTimer(Seconds(memTrackInterval), &attackSchedule);
+    }
+
     // After simulation run
-    Simulator::Stop(Seconds(appStopTime));
+    Simulator::Stop(Seconds(stopTime));
     //Simulator::Stop(Seconds(200));
+
+    // Measure wall-clock time per simulated second so tracing modes can be compared
+    auto wallStart = std::chrono::steady_clock::now();
     Simulator::Run();
-    
-    // Serialize Flow Monitor results
-    flowmon->SerializeToXmlFile("flowmon-results.xml", true, true);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    memoryTracker.Checkpoint("end-of-run");
+    profiler.Close();
+    packetTracer.Close();
+    packetExporter.Close();
+    captureManager.Close();
+    labelIndex.Close();
+    flowExtractor.Close();
+    flowmonExporter.Close();  // Flows still active at the end
+    if (capture && !captureManager.WriteManifest(output.Open(captureManifestFile))) {
+        NS_FATAL_ERROR("Cannot open capture manifest " << captureManifestFile);
+    }
+    wifiStats.Flush(Simulator::Now().GetSeconds());  // Final partial window
+    wifiStats.Close();
+    anim.reset();          // Writes the closing tag and closes the animation file (or pipe)
+    animStream.Finish();
+
+    double simSeconds = Simulator::Now().GetSeconds();
+    NS_LOG_UNCOND("Wall-clock time: " << wallSeconds << " s for " << simSeconds << " simulated seconds ("
+                  << (simSeconds > 0 ? wallSeconds * 1000.0 / simSeconds : 0.0) << " ms per simulated second, packet-trace="
+                  << packetTraceMode << ", " << packetTracer.GetRecordCount() << " binary records)");
+    if (packetExportMode == "columnar") {
+        NS_LOG_UNCOND("Packet export: " << packetExporter.GetRowCount() << " rows in "
+                      << packetExporter.GetRowGroupCount() << " row groups written to " << packetExportFile);
+    }
+
+    // Serialize Flow Monitor results through the output writer (same content as SerializeToXmlFile)
+    if (flowmonMode == "xml") {
+        AsyncOutputFile* flowmonFile = output.Open("flowmon-results.xml", false, compression);
+        if (flowmonFile == nullptr) {
+            NS_FATAL_ERROR("Cannot open flowmon-results.xml");
+        }
+        AsyncOutputStreamBuf flowmonBuffer(flowmonFile);
+        std::ostream flowmonStream(&flowmonBuffer);
+        flowmonStream << "<?xml version=\"1.0\" ?>\n";
+        flowmon->SerializeToXmlStream(flowmonStream, 0, true, true);
+    }
+
+    memoryTracker.Checkpoint("output");
+    memoryTracker.Close();
+
+    // Machine-readable summary for ids_benchmark
+    if (!runSummaryFile.empty()) {
+        AsyncOutputFile* summaryFile = output.Open(runSummaryFile);
+        if (summaryFile == nullptr) {
+            NS_FATAL_ERROR("Cannot open run summary " << runSummaryFile);
+        }
+        uint64_t rssKb = 0;
+        uint64_t hwmKb = 0;
+        ReadProcessMemory(rssKb, hwmKb);
+        uint64_t events = Simulator::GetEventCount();
+        char summary[256];
+        int n = std::snprintf(summary, sizeof(summary),
+                              "{\"sim_s\":%.3f,\"wall_s\":%.6f,\"events\":%llu,\"events_per_s\":%.0f,\"peak_rss_kb\":%llu}\n",
+                              simSeconds, wallSeconds, static_cast<unsigned long long>(events),
+                              wallSeconds > 0 ? events / wallSeconds : 0.0, static_cast<unsigned long long>(hwmKb));
+        summaryFile->Write(summary, static_cast<size_t>(n));
+        summaryFile->Close();
+    }
+
+    if (appReport && !appAttribution.WriteCsv(output.Open(appReportFile))) {
+        NS_FATAL_ERROR("Cannot open application report " << appReportFile);
+    }
+
+    // Detach std::clog from the sampling and async buffers, then drain and close all output files
+    std::clog.rdbuf(clogOriginal);
+    if (asyncLog) {
+        asyncLog->pubsync();
+    }
+    output.Stop();
+    if (logProfile == LOG_PROFILE_DEBUG) {
+        sampledLog.Report(std::clog);
+    }
+    if (netanimMode == "stream") {
+        animStream.Report(std::clog);
+    }
+    if (capture) {
+        captureManager.Report(std::clog);
+    }
+    if (capture && captureLabelIndex != "off") {
+        labelIndex.Report(std::clog);
+    }
+    if (flowFeatures) {
+        flowExtractor.Report(std::clog);
+    }
+    if (flowmonMode == "incremental") {
+        flowmonExporter.Report(std::clog);
+    }
+    if (tagLabels && labelledOutput) {
+        attackTagger.Report(std::clog);
+    }
+    if (profile) {
+        profiler.Report(std::clog);
+    }
+    if (appReport) {
+        appAttribution.Report(std::clog);
+    }
+    if (memTrack) {
+        memoryTracker.Report(std::clog);
+    }
+    output.Report(std::clog);
     Simulator::Destroy();
 
     return 0;
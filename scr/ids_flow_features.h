@@ -0,0 +1,866 @@
+// In-Simulation Flow Features for the IDS Dataset Simulation
+//
+// CIC-IDS2017-style flow features used to be computed after the run by an external flow meter
+// reading the captures back, which doubles the I/O and takes hours for a full run. This header
+// computes them while the simulation runs instead: every tap (a point-to-point or CSMA device)
+// keeps a table of open flows, each packet seen on the tap updates the running statistics of its
+// flow, and a labelled CSV row is written as soon as the flow ends.
+//
+// Flows follow CICFlowMeter:
+// - A flow is keyed by its bidirectional 5-tuple; the first packet defines the forward direction.
+//   ICMP and other protocols without ports form flows with ports 0.
+// - A flow ends when a packet arrives more than the flow timeout (120 s) after the flow started
+//   (the packet starts a new flow), on a TCP RST, or once both sides have sent a FIN (a final
+//   pure ACK is still counted). Flows still open are written on Close, in the order they started.
+// - A flow also ends after the idle timeout without a packet (equal to the flow timeout by default,
+//   which matches CICFlowMeter), and when its tap's flow table is full and it is the least recently
+//   used flow. The table (ids_flow_table.h) has a fixed capacity, so memory stays bounded when
+//   clients or attack rates are scaled up; the report counts the flows ended by each cause.
+// - Packet lengths are transport payload bytes and header lengths are transport header bytes.
+//   Times are in microseconds. Active and idle periods are split by the activity timeout (5 s);
+//   subflows by gaps of more than 1 s; bulks are 4 or more payload packets in one direction
+//   without a packet of the other direction and without a gap of more than 1 s.
+// - Per packet, the length and inter-arrival statistics only accumulate sums (ids_flow_stats.h).
+//   Ended flows are queued per flow table and their means and deviations are computed 64 flows
+//   at a time by the batched kernels before the rows are written, so rows appear in batches.
+// - Optionally, worker threads do the metering (SetThreads). The trace callback then only parses
+//   the packet (the Packet itself must stay on the simulator thread) and pushes a compact
+//   FlowPacket to a lock-free single-producer queue (ids_spsc_queue.h). Flows are sharded by
+//   5-tuple hash, each worker owns its shard of every tap's flow table (the table capacity is
+//   split between them), so the workers share nothing but the output files. A full queue makes
+//   the simulator thread wait, which the report shows. Each shard evicts from its own LRU, so once
+//   a table fills, which flows are evicted (and so the rows) depends on the number of workers.
+//
+// Output format (one file per tap, columns as in the CIC-IDS2017 TrafficLabelling CSVs):
+//   Flow ID,Source IP,...,Idle Min,Label
+// where Timestamp is the simulated start time in seconds and Label is BENIGN or the attack label
+// (see AttackLabelName). A flow is labelled with the first attack label among its packets, taken
+// from the AttackTag (ids_attack_tag.h) or from the attack schedule. Deviations from CICFlowMeter:
+// rates of zero-length flows are 0 instead of Infinity/NaN, Init_Win_bytes_backward is the window
+// of the first backward packet, and the subflow count starts at 1.
+
+#ifndef IDS_FLOW_FEATURES_H
+#define IDS_FLOW_FEATURES_H
+
+#include "ns3/csma-net-device.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+#include "ids_attack_tag.h"
+#include "ids_capture_format.h"
+#include "ids_flow_stats.h"
+#include "ids_flow_table.h"
+#include "ids_spsc_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+constexpr double FLOW_FEATURES_TIMEOUT = 120.0;              // CICFlowMeter flow (active) timeout, seconds
+constexpr double FLOW_FEATURES_IDLE_TIMEOUT = 120.0;         // Seconds without a packet that end a flow
+constexpr uint32_t FLOW_FEATURES_TABLE_CAPACITY = 65536;     // Open flows per tap
+constexpr double FLOW_FEATURES_ACTIVITY_TIMEOUT = 5.0;       // CICFlowMeter activity timeout, seconds
+constexpr int64_t FLOW_FEATURES_GAP_US = 1000000;            // Subflow and bulk gap, microseconds
+constexpr uint64_t FLOW_FEATURES_BULK_PACKETS = 4;           // Packets that make a bulk
+constexpr size_t FLOW_FEATURES_BATCH_FLOWS = 64;             // Ended flows finalized and written together
+constexpr size_t FLOW_FEATURES_QUEUE_RECORDS = 65536;        // Packets queued per worker thread
+
+/// One IPv4 packet as seen by the flow meter.
+struct FlowPacket {
+    PacketTuple tuple;
+    int64_t timeUs;        // Capture time in microseconds
+    uint32_t payload;      // Transport payload bytes
+    uint32_t header;       // Transport header bytes
+    int32_t window;        // TCP window, -1 for other protocols
+    uint32_t instance;     // Attack instance, 0 = benign
+    uint8_t label;         // AttackLabel
+};
+
+/**
+ * Parses the fields the flow meter needs from an IPv4 header and the start of its payload.
+ *
+ * @param bytes The IPv4 header.
+ * @param length Number of bytes available.
+ * @param packet Receives the tuple, payload and header lengths and TCP window.
+ * @return false if the bytes are not an IPv4 header.
+ */
+inline bool ParseFlowPacket(const uint8_t* bytes, size_t length, FlowPacket& packet) {
+    if (!ParseIpv4Tuple(bytes, length, packet.tuple)) {
+        return false;
+    }
+    size_t headerLength = (bytes[0] & 0x0f) * 4u;
+    uint32_t totalLength = static_cast<uint32_t>((bytes[2] << 8) | bytes[3]);
+    bool firstFragment = (((bytes[6] & 0x1f) << 8) | bytes[7]) == 0;
+    packet.header = 0;
+    packet.window = -1;
+    if (firstFragment && packet.tuple.protocol == 6 && length >= headerLength + 16) {
+        packet.header = (bytes[headerLength + 12] >> 4) * 4u;
+        packet.window = (bytes[headerLength + 14] << 8) | bytes[headerLength + 15];
+    } else if (firstFragment && packet.tuple.protocol == 17) {
+        packet.header = 8;
+    }
+    uint32_t used = static_cast<uint32_t>(headerLength) + packet.header;
+    packet.payload = (totalLength > used) ? totalLength - used : 0;
+    return true;
+}
+
+/// Bulk transfer state of one direction of a flow (CICFlowMeter's bulk heuristic).
+struct FlowBulk {
+    int64_t startHelper = 0;       // Start of the current candidate bulk, 0 = none
+    int64_t lastUs = 0;            // Last packet of the current candidate bulk
+    uint64_t packetHelper = 0;     // Packets in the candidate bulk
+    uint64_t sizeHelper = 0;       // Payload bytes in the candidate bulk
+    uint64_t count = 0;            // Completed bulks
+    uint64_t packets = 0;          // Packets in bulks
+    uint64_t bytes = 0;            // Payload bytes in bulks
+    int64_t durationUs = 0;        // Time spent in bulks
+
+    /**
+     * Adds a packet of this direction.
+     *
+     * @param timeUs Packet time.
+     * @param payload Payload bytes of the packet.
+     * @param otherLastUs Last bulk packet of the other direction, which interrupts a candidate bulk.
+     */
+    void Add(int64_t timeUs, uint32_t payload, int64_t otherLastUs) {
+        if (otherLastUs > startHelper) {
+            startHelper = 0;
+        }
+        if (payload == 0) {
+            return;
+        }
+        if (startHelper == 0 || timeUs - lastUs > FLOW_FEATURES_GAP_US) {
+            startHelper = timeUs;
+            lastUs = timeUs;
+            packetHelper = 1;
+            sizeHelper = payload;
+            return;
+        }
+        ++packetHelper;
+        sizeHelper += payload;
+        if (packetHelper == FLOW_FEATURES_BULK_PACKETS) {
+            ++count;
+            packets += packetHelper;
+            bytes += sizeHelper;
+            durationUs += timeUs - startHelper;
+        } else if (packetHelper > FLOW_FEATURES_BULK_PACKETS) {
+            ++packets;
+            bytes += payload;
+            durationUs += timeUs - lastUs;
+        }
+        lastUs = timeUs;
+    }
+};
+
+/// Running features of one open flow.
+struct FlowState {
+    PacketTuple forward;           // Tuple of the first packet, its source is the forward side
+    uint64_t sequence = 0;         // Start order, for a deterministic order of flows written on Close
+    int64_t startUs = 0;           // First packet
+    int64_t lastUs = 0;            // Last packet
+    int64_t fwdLastUs = 0;         // Last forward packet
+    int64_t bwdLastUs = 0;         // Last backward packet
+    int64_t activeStartUs = 0;     // Start of the current active period
+    int64_t activeEndUs = 0;       // Last packet of the current active period
+    int64_t subflowLastUs = 0;     // Last packet, for subflow gaps
+    uint32_t subflows = 1;         // Subflows (gaps of more than 1 s plus one)
+    FlowStat length;               // Payload bytes of all packets
+    FlowStat fwdLength;            // Payload bytes of forward packets
+    FlowStat bwdLength;            // Payload bytes of backward packets
+    FlowStat iat;                  // Gaps between packets
+    FlowStat fwdIat;               // Gaps between forward packets
+    FlowStat bwdIat;               // Gaps between backward packets
+    FlowStat active;               // Active periods
+    FlowStat idle;                 // Idle periods
+    FlowBulk fwdBulk;
+    FlowBulk bwdBulk;
+    uint64_t fwdHeader = 0;        // Transport header bytes, forward
+    uint64_t bwdHeader = 0;        // Transport header bytes, backward
+    uint32_t minFwdHeader = 0;     // Smallest forward transport header
+    uint32_t fwdDataPackets = 0;   // Forward packets with payload
+    uint32_t fwdPsh = 0;
+    uint32_t bwdPsh = 0;
+    uint32_t fwdUrg = 0;
+    uint32_t bwdUrg = 0;
+    uint32_t flags[8] = {};        // Packets with FIN, SYN, RST, PSH, ACK, URG, ECE, CWR set (bit order)
+    int32_t fwdInitWindow = -1;    // TCP window of the first forward packet
+    int32_t bwdInitWindow = -1;    // TCP window of the first backward packet
+    bool fwdFin = false;           // Forward side has sent a FIN
+    bool bwdFin = false;           // Backward side has sent a FIN
+    uint32_t instance = 0;         // Attack instance of the first attack packet
+    uint8_t label = ATTACK_BENIGN; // AttackLabel of the first attack packet
+
+    /// Starts the flow with its first packet.
+    void Start(const FlowPacket& p, uint64_t seq) {
+        forward = p.tuple;
+        sequence = seq;
+        startUs = p.timeUs;
+        lastUs = p.timeUs;
+        activeStartUs = p.timeUs;
+        activeEndUs = p.timeUs;
+        subflowLastUs = p.timeUs;
+        minFwdHeader = p.header;
+        fwdInitWindow = p.window;
+        Count(p, true);
+    }
+
+    /**
+     * Adds a later packet.
+     *
+     * @param p The packet.
+     * @param activityTimeoutUs Gap that ends an active period.
+     */
+    void Add(const FlowPacket& p, int64_t activityTimeoutUs) {
+        if (p.timeUs - activeEndUs > activityTimeoutUs) {
+            if (activeEndUs > activeStartUs) {
+                active.Add(static_cast<double>(activeEndUs - activeStartUs));
+            }
+            idle.Add(static_cast<double>(p.timeUs - activeEndUs));
+            activeStartUs = p.timeUs;
+        }
+        activeEndUs = p.timeUs;
+        if (p.timeUs - subflowLastUs > FLOW_FEATURES_GAP_US) {
+            ++subflows;
+        }
+        subflowLastUs = p.timeUs;
+        iat.Add(static_cast<double>(p.timeUs - lastUs));
+        lastUs = p.timeUs;
+
+        bool isForward = p.tuple.src == forward.src && p.tuple.srcPort == forward.srcPort;
+        if (!isForward && bwdLength.n == 0) {
+            bwdInitWindow = p.window;
+        }
+        Count(p, isForward);
+    }
+
+    /// Closes the active period of a flow that ends.
+    void Finish() {
+        if (activeEndUs > activeStartUs) {
+            active.Add(static_cast<double>(activeEndUs - activeStartUs));
+        }
+    }
+
+    /// Returns true once both sides have sent a FIN.
+    bool IsClosing() const { return fwdFin && bwdFin; }
+
+    /// Queues the statistics of a finished flow; the flow must stay in place until batch.Finalize.
+    void AddStats(FlowStatBatch& batch) {
+        for (FlowStat* s : {&length, &fwdLength, &bwdLength, &iat, &fwdIat, &bwdIat, &active, &idle}) {
+            batch.Add(s);
+        }
+    }
+
+private:
+    /// Updates the per-direction counters and statistics.
+    void Count(const FlowPacket& p, bool isForward) {
+        uint8_t tcpFlags = p.tuple.tcpFlags;
+        for (uint32_t bit = 0; bit < 8; ++bit) {
+            flags[bit] += (tcpFlags >> bit) & 1;
+        }
+        length.Add(p.payload);
+        if (isForward) {
+            fwdBulk.Add(p.timeUs, p.payload, bwdBulk.lastUs);
+            if (fwdLength.n > 0) {
+                fwdIat.Add(static_cast<double>(p.timeUs - fwdLastUs));
+            }
+            fwdLastUs = p.timeUs;
+            fwdLength.Add(p.payload);
+            fwdHeader += p.header;
+            minFwdHeader = std::min(minFwdHeader, p.header);
+            fwdDataPackets += (p.payload > 0) ? 1 : 0;
+            fwdPsh += (tcpFlags >> 3) & 1;
+            fwdUrg += (tcpFlags >> 5) & 1;
+            fwdFin = fwdFin || (tcpFlags & 0x01);
+        } else {
+            bwdBulk.Add(p.timeUs, p.payload, fwdBulk.lastUs);
+            if (bwdLength.n > 0) {
+                bwdIat.Add(static_cast<double>(p.timeUs - bwdLastUs));
+            }
+            bwdLastUs = p.timeUs;
+            bwdLength.Add(p.payload);
+            bwdHeader += p.header;
+            bwdPsh += (tcpFlags >> 3) & 1;
+            bwdUrg += (tcpFlags >> 5) & 1;
+            bwdFin = bwdFin || (tcpFlags & 0x01);
+        }
+        if (label == ATTACK_BENIGN && p.label != ATTACK_BENIGN) {
+            label = p.label;
+            instance = p.instance;
+        }
+    }
+};
+
+/// CSV header of the flow feature files (CIC-IDS2017 column names, including the repeated column).
+constexpr char FLOW_FEATURES_CSV_HEADER[] =
+    "Flow ID,Source IP,Source Port,Destination IP,Destination Port,Protocol,Timestamp,Flow Duration,"
+    "Total Fwd Packets,Total Backward Packets,Total Length of Fwd Packets,Total Length of Bwd Packets,"
+    "Fwd Packet Length Max,Fwd Packet Length Min,Fwd Packet Length Mean,Fwd Packet Length Std,"
+    "Bwd Packet Length Max,Bwd Packet Length Min,Bwd Packet Length Mean,Bwd Packet Length Std,"
+    "Flow Bytes/s,Flow Packets/s,Flow IAT Mean,Flow IAT Std,Flow IAT Max,Flow IAT Min,"
+    "Fwd IAT Total,Fwd IAT Mean,Fwd IAT Std,Fwd IAT Max,Fwd IAT Min,"
+    "Bwd IAT Total,Bwd IAT Mean,Bwd IAT Std,Bwd IAT Max,Bwd IAT Min,"
+    "Fwd PSH Flags,Bwd PSH Flags,Fwd URG Flags,Bwd URG Flags,Fwd Header Length,Bwd Header Length,"
+    "Fwd Packets/s,Bwd Packets/s,Min Packet Length,Max Packet Length,Packet Length Mean,Packet Length Std,"
+    "Packet Length Variance,FIN Flag Count,SYN Flag Count,RST Flag Count,PSH Flag Count,ACK Flag Count,"
+    "URG Flag Count,CWE Flag Count,ECE Flag Count,Down/Up Ratio,Average Packet Size,Avg Fwd Segment Size,"
+    "Avg Bwd Segment Size,Fwd Header Length,Fwd Avg Bytes/Bulk,Fwd Avg Packets/Bulk,Fwd Avg Bulk Rate,"
+    "Bwd Avg Bytes/Bulk,Bwd Avg Packets/Bulk,Bwd Avg Bulk Rate,Subflow Fwd Packets,Subflow Fwd Bytes,"
+    "Subflow Bwd Packets,Subflow Bwd Bytes,Init_Win_bytes_forward,Init_Win_bytes_backward,act_data_pkt_fwd,"
+    "min_seg_size_forward,Active Mean,Active Std,Active Max,Active Min,Idle Mean,Idle Std,Idle Max,Idle Min,"
+    "Label\n";
+
+/**
+ * Appends the CSV row of a finished flow.
+ *
+ * @param flow The flow, after FlowState::Finish and with its statistics finalized.
+ * @param out Receives the row, terminated by a newline.
+ */
+inline void AppendFlowRow(const FlowState& flow, std::string& out) {
+    char field[64];
+    auto add = [&](const char* format, auto value) {
+        std::snprintf(field, sizeof(field), format, value);
+        out += field;
+        out += ',';
+    };
+    auto real = [&](double value) { add("%.10g", value); };
+    auto count = [&](uint64_t value) { add("%llu", static_cast<unsigned long long>(value)); };
+    auto stats = [&](const FlowStat& s, bool withTotal) {
+        if (withTotal) {
+            real(s.Total());
+        }
+        real(s.mean);
+        real(s.stdDev);
+        real(s.max);
+        real(s.min);
+    };
+    auto lengths = [&](const FlowStat& s) {
+        real(s.max);
+        real(s.min);
+        real(s.mean);
+        real(s.stdDev);
+    };
+    auto bulk = [&](const FlowBulk& b) {
+        count(b.count > 0 ? b.bytes / b.count : 0);
+        count(b.count > 0 ? b.packets / b.count : 0);
+        real(b.durationUs > 0 ? b.bytes / (b.durationUs / 1e6) : 0.0);
+    };
+
+    const PacketTuple& t = flow.forward;
+    std::string src = AttackSchedule::FormatAddress(t.src);
+    std::string dst = AttackSchedule::FormatAddress(t.dst);
+    out += src + "-" + dst + "-" + std::to_string(t.srcPort) + "-" + std::to_string(t.dstPort) + "-" +
+           std::to_string(t.protocol) + ",";
+    out += src + "," + std::to_string(t.srcPort) + "," + dst + "," + std::to_string(t.dstPort) + "," +
+           std::to_string(t.protocol) + ",";
+    add("%.6f", flow.startUs / 1e6);
+
+    double seconds = (flow.lastUs - flow.startUs) / 1e6;
+    uint64_t fwdPackets = flow.fwdLength.n;
+    uint64_t bwdPackets = flow.bwdLength.n;
+    uint64_t packets = fwdPackets + bwdPackets;
+    double bytes = flow.fwdLength.Total() + flow.bwdLength.Total();
+    count(static_cast<uint64_t>(flow.lastUs - flow.startUs));
+    count(fwdPackets);
+    count(bwdPackets);
+    real(flow.fwdLength.Total());
+    real(flow.bwdLength.Total());
+    lengths(flow.fwdLength);
+    lengths(flow.bwdLength);
+    real(seconds > 0 ? bytes / seconds : 0.0);
+    real(seconds > 0 ? packets / seconds : 0.0);
+    stats(flow.iat, false);
+    stats(flow.fwdIat, true);
+    stats(flow.bwdIat, true);
+    count(flow.fwdPsh);
+    count(flow.bwdPsh);
+    count(flow.fwdUrg);
+    count(flow.bwdUrg);
+    count(flow.fwdHeader);
+    count(flow.bwdHeader);
+    real(seconds > 0 ? fwdPackets / seconds : 0.0);
+    real(seconds > 0 ? bwdPackets / seconds : 0.0);
+    real(flow.length.min);
+    real(flow.length.max);
+    real(flow.length.mean);
+    real(flow.length.stdDev);
+    real(flow.length.variance);
+    // FIN, SYN, RST, PSH, ACK, URG, CWR ("CWE"), ECE
+    for (uint32_t bit : {0u, 1u, 2u, 3u, 4u, 5u, 7u, 6u}) {
+        count(flow.flags[bit]);
+    }
+    count(fwdPackets > 0 ? bwdPackets / fwdPackets : 0);
+    real(packets > 0 ? bytes / packets : 0.0);
+    real(flow.fwdLength.mean);
+    real(flow.bwdLength.mean);
+    count(flow.fwdHeader);
+    bulk(flow.fwdBulk);
+    bulk(flow.bwdBulk);
+    count(fwdPackets / flow.subflows);
+    count(static_cast<uint64_t>(flow.fwdLength.Total()) / flow.subflows);
+    count(bwdPackets / flow.subflows);
+    count(static_cast<uint64_t>(flow.bwdLength.Total()) / flow.subflows);
+    add("%d", flow.fwdInitWindow);
+    add("%d", flow.bwdInitWindow);
+    count(flow.fwdDataPackets);
+    count(flow.minFwdHeader);
+    stats(flow.active, false);
+    stats(flow.idle, false);
+    out += (flow.label == ATTACK_BENIGN) ? "BENIGN" : AttackLabelName(flow.label);
+    out += '\n';
+}
+
+/// Why a flow was written.
+enum FlowEndReason : uint8_t {
+    FLOW_END_TCP = 0,      // RST, or FIN from both sides
+    FLOW_END_ACTIVE,       // Active timeout: a packet arrived more than the flow timeout after the start
+    FLOW_END_IDLE,         // Idle timeout: no packet for the idle timeout
+    FLOW_END_EVICTED,      // Least recently used flow of a full table
+    FLOW_END_CLOSE,        // Still open at the end of the run
+    FLOW_END_REASON_COUNT
+};
+
+/**
+ * Computes flow features on a set of taps and writes one labelled CSV file per tap.
+ *
+ * Each tap's open flows live in FlowTables of fixed capacity, so memory stays bounded however
+ * many flows the attacks open; idle flows are expired from the LRU end as packets arrive. With
+ * worker threads, the trace callback only parses the packet into a FlowPacket and pushes it to
+ * the SpscQueue of the worker owning its flow; each worker meters its own shard of every tap.
+ */
+class FlowFeatureExtractor {
+public:
+    FlowFeatureExtractor()
+        : m_schedule(nullptr), m_tagLabels(false), m_timeoutUs(static_cast<int64_t>(FLOW_FEATURES_TIMEOUT * 1e6)),
+          m_idleTimeoutUs(static_cast<int64_t>(FLOW_FEATURES_IDLE_TIMEOUT * 1e6)),
+          m_activityTimeoutUs(static_cast<int64_t>(FLOW_FEATURES_ACTIVITY_TIMEOUT * 1e6)),
+          m_capacity(FLOW_FEATURES_TABLE_CAPACITY), m_threads(0), m_sequence(0), m_stopping(false), m_stalls(0),
+          m_stallNs(0) {}
+
+    ~FlowFeatureExtractor() { Close(); }
+
+    FlowFeatureExtractor(const FlowFeatureExtractor&) = delete;
+    FlowFeatureExtractor& operator=(const FlowFeatureExtractor&) = delete;
+
+    /**
+     * Registers a tap. Call before Open.
+     *
+     * @param name Tap name; the features are written to <name>-flows.csv.
+     * @param device Point-to-point or CSMA device whose traffic is metered.
+     * @return false if the device type is not supported.
+     */
+    bool AddTap(const std::string& name, Ptr<NetDevice> device) {
+        uint32_t linkType;
+        if (DynamicCast<PointToPointNetDevice>(device)) {
+            linkType = CAPTURE_LINKTYPE_PPP;
+        } else if (DynamicCast<CsmaNetDevice>(device)) {
+            linkType = CAPTURE_LINKTYPE_ETHERNET;
+        } else {
+            return false;
+        }
+        Tap tap;
+        tap.name = name;
+        tap.path = name + "-flows.csv";
+        tap.device = device;
+        tap.linkType = linkType;
+        m_taps.push_back(std::move(tap));
+        return true;
+    }
+
+    /**
+     * Sets the flow timeouts. Call before Open.
+     *
+     * @param timeout Active timeout: seconds after its first packet at which a flow ends.
+     * @param idleTimeout Seconds without a packet after which a flow ends.
+     * @param activityTimeout Gap in seconds that separates active periods.
+     */
+    void SetTimeouts(double timeout, double idleTimeout, double activityTimeout) {
+        m_timeoutUs = static_cast<int64_t>(timeout * 1e6);
+        m_idleTimeoutUs = static_cast<int64_t>(idleTimeout * 1e6);
+        m_activityTimeoutUs = static_cast<int64_t>(activityTimeout * 1e6);
+    }
+
+    /**
+     * Sets the number of open flows each tap can hold. When a table is full, its least recently
+     * used flow is written and evicted. Call before Open.
+     *
+     * @param flows Open flows per tap, split evenly between the worker threads.
+     */
+    void SetCapacity(uint32_t flows) { m_capacity = flows; }
+
+    /**
+     * Sets the number of worker threads that meter the flows. Call before Open.
+     *
+     * With 0 the packets are metered inside the trace callback on the simulator thread. With
+     * workers, flows are sharded by their 5-tuple hash and rows of different workers interleave in
+     * the files in batches, in an order that varies between runs. The rows themselves match the
+     * inline run only while no shard's table fills: each shard holds its share of the capacity and
+     * evicts its own least recently used flow, so evictions depend on the number of workers. A
+     * shard expires idle flows only at its own packets (and at Close), so the end reasons match
+     * but idle flows stay open longer, and the peak in Report, the sum of the shard peaks, depends
+     * on the number of workers too.
+     *
+     * @param threads Worker threads, 0 to meter on the simulator thread.
+     */
+    void SetThreads(uint32_t threads) { m_threads = threads; }
+
+    /**
+     * Labels packets from their AttackTag instead of the attack schedule windows.
+     *
+     * @param tags true to read AttackTags.
+     */
+    void SetTagLabels(bool tags) { m_tagLabels = tags; }
+
+    /**
+     * Opens one feature file per tap, starts the workers and connects the taps.
+     *
+     * @param writer Output writer the files are created on.
+     * @param schedule Attack schedule labelling the packets when tag labels are off, or nullptr.
+     * @return false if a file cannot be created.
+     */
+    bool Open(AsyncOutputWriter& writer, const AttackSchedule* schedule) {
+        m_schedule = schedule;
+        uint32_t shards = std::max<uint32_t>(m_threads, 1);
+        for (uint32_t i = 0; i < m_taps.size(); ++i) {
+            Tap& tap = m_taps[i];
+            tap.file = writer.Open(tap.path);
+            if (tap.file == nullptr) {
+                return false;
+            }
+            tap.shards = std::vector<Shard>(shards);
+            for (Shard& shard : tap.shards) {
+                shard.flows.SetCapacity(std::max<uint32_t>(m_capacity / shards, 1));
+            }
+            tap.file->Write(FLOW_FEATURES_CSV_HEADER, sizeof(FLOW_FEATURES_CSV_HEADER) - 1);
+            tap.device->TraceConnectWithoutContext("PromiscSniffer",
+                                                   MakeBoundCallback(&FlowFeatureExtractor::OnPacket, this, i));
+        }
+        m_stopping.store(false, std::memory_order_relaxed);
+        for (uint32_t w = 0; w < m_threads; ++w) {
+            m_workers.push_back(std::make_unique<Worker>(FLOW_FEATURES_QUEUE_RECORDS));
+        }
+        for (uint32_t w = 0; w < m_threads; ++w) {
+            m_workers[w]->thread = std::thread(&FlowFeatureExtractor::Work, this, w);
+        }
+        return true;
+    }
+
+    /// Meters the queued packets, writes the flows still open in the order they started and closes the files.
+    void Close() {
+        m_stopping.store(true, std::memory_order_release);
+        for (std::unique_ptr<Worker>& worker : m_workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+        for (Tap& tap : m_taps) {
+            if (tap.file == nullptr) {
+                continue;
+            }
+            // A shard only expires idle flows when one of its own packets arrives; expire them at the
+            // tap's last packet, as the inline run does. Rows of flows that already ended come first,
+            // then the open flows of all shards in start order
+            for (Shard& shard : tap.shards) {
+                ExpireIdle(tap, shard, tap.lastUs);
+                Flush(tap, shard);
+            }
+            std::vector<std::tuple<uint64_t, uint32_t, uint32_t>> open;
+            for (uint32_t s = 0; s < tap.shards.size(); ++s) {
+                tap.shards[s].flows.ForEach([&open, s](uint32_t handle, const FlowState& flow) {
+                    open.emplace_back(flow.sequence, s, handle);
+                });
+            }
+            std::sort(open.begin(), open.end());
+            for (const std::tuple<uint64_t, uint32_t, uint32_t>& entry : open) {
+                WriteFlow(tap, tap.shards[0], tap.shards[std::get<1>(entry)].flows.Get(std::get<2>(entry)),
+                          FLOW_END_CLOSE);
+            }
+            Flush(tap, tap.shards[0]);
+            for (Shard& shard : tap.shards) {
+                shard.flows.Clear();
+            }
+            tap.file->Close();
+            tap.file = nullptr;
+        }
+    }
+
+    /**
+     * Writes per-tap packet and flow counts, why the flows ended and how often the simulator
+     * thread waited for a full worker queue.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        os << "Flow features: " << m_taps.size() << " taps, " << m_capacity << " open flows per tap, ";
+        if (m_threads > 0) {
+            os << m_threads << " worker threads, " << m_stalls << " full-queue waits (" << m_stallNs / 1e6 << " ms)";
+        } else {
+            os << "metered on the simulator thread";
+        }
+        os << std::endl;
+        for (const Tap& tap : m_taps) {
+            uint64_t written = 0;
+            uint64_t attackFlows = 0;
+            uint64_t ended[FLOW_END_REASON_COUNT] = {};
+            uint32_t peakFlows = 0;
+            for (const Shard& shard : tap.shards) {
+                written += shard.written;
+                attackFlows += shard.attackFlows;
+                for (uint32_t reason = 0; reason < FLOW_END_REASON_COUNT; ++reason) {
+                    ended[reason] += shard.ended[reason];
+                }
+                peakFlows += shard.peakFlows;   // Sum of the shard peaks, exact with one shard
+            }
+            os << "  " << tap.path << ": " << tap.packets << " packets, " << written << " flows (" << attackFlows
+               << " attack), peak " << peakFlows << " open flows; ended by tcp " << ended[FLOW_END_TCP]
+               << ", active timeout " << ended[FLOW_END_ACTIVE] << ", idle timeout " << ended[FLOW_END_IDLE]
+               << ", eviction " << ended[FLOW_END_EVICTED] << ", end of run " << ended[FLOW_END_CLOSE] << std::endl;
+        }
+    }
+
+private:
+    /// Flows of one tap owned by one worker (or by the simulator thread without workers).
+    struct alignas(64) Shard {
+        FlowTable<FlowState> flows;       // Open flows
+        std::vector<FlowState> finished;  // Ended flows waiting for Flush, in end order
+        FlowStatBatch batch;              // Statistics of the ended flows
+        std::string rows;                 // Reused row buffer
+        uint64_t written = 0;             // Flows written
+        uint64_t attackFlows = 0;         // Of which labelled as attacks
+        uint64_t ended[FLOW_END_REASON_COUNT] = {};  // Flows written per FlowEndReason
+        uint32_t peakFlows = 0;           // Most flows open at once
+    };
+
+    /// One metered device, its shards and its output file.
+    struct Tap {
+        std::string name;
+        std::string path;
+        Ptr<NetDevice> device;
+        uint32_t linkType = 0;
+        AsyncOutputFile* file = nullptr;
+        std::vector<Shard> shards;        // One per worker, or one without workers
+        uint64_t packets = 0;             // IPv4 packets metered (simulator thread)
+        int64_t lastUs = 0;               // Time of the last packet (simulator thread)
+    };
+
+    /// Packet handed to a worker.
+    struct FlowWork {
+        FlowPacket packet;
+        uint64_t sequence;                // Arrival order over all taps
+        uint32_t tap;
+    };
+
+    /// Worker thread and the queue the simulator thread feeds it through.
+    struct Worker {
+        explicit Worker(size_t records) : queue(records) {}
+        SpscQueue<FlowWork> queue;
+        std::thread thread;
+    };
+
+    static void OnPacket(FlowFeatureExtractor* self, uint32_t tap, Ptr<const Packet> packet) {
+        self->Enqueue(tap, packet);
+    }
+
+    /// Parses a packet seen on a tap and meters it, or queues it for the worker owning its flow.
+    void Enqueue(uint32_t tapIndex, Ptr<const Packet> packet) {
+        Tap& tap = m_taps[tapIndex];
+        if (tap.file == nullptr) {
+            return;
+        }
+        uint8_t head[CAPTURE_LABEL_BYTES];
+        uint32_t headLength = packet->CopyData(head, CAPTURE_LABEL_BYTES);
+        size_t ipLength = 0;
+        const uint8_t* ip = FindIpv4Header(tap.linkType, head, headLength, ipLength);
+        FlowWork work;
+        FlowPacket& p = work.packet;
+        if (ip == nullptr || !ParseFlowPacket(ip, ipLength, p)) {
+            return;
+        }
+        int64_t ns = Simulator::Now().GetNanoSeconds();
+        p.timeUs = ns / 1000;
+        p.instance = 0;
+        p.label = ATTACK_BENIGN;
+        if (m_tagLabels) {
+            ReadAttackTag(packet, p.instance, p.label);
+        } else if (m_schedule != nullptr) {
+            const PacketTuple& t = p.tuple;
+            p.instance = m_schedule->Match(ns / 1e9, t.src, t.dst, t.protocol, t.srcPort, t.dstPort);
+            p.label = m_schedule->InstanceLabel(p.instance);
+        }
+        ++tap.packets;
+        tap.lastUs = p.timeUs;
+        work.sequence = m_sequence++;
+        work.tap = tapIndex;
+        if (m_workers.empty()) {
+            Meter(tap, tap.shards[0], p, work.sequence);
+            return;
+        }
+        // High hash bits pick the worker; the flow table index uses the low bits
+        uint64_t hash = HashFlowTableKey(MakeFlowTableKey(p.tuple));
+        SpscQueue<FlowWork>& queue = m_workers[(hash >> 32) % m_workers.size()]->queue;
+        if (!queue.Push(work)) {
+            auto start = std::chrono::steady_clock::now();
+            do {
+                std::this_thread::yield();
+            } while (!queue.Push(work));
+            ++m_stalls;
+            m_stallNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                             .count();
+        }
+    }
+
+    /// Worker thread: meters its queue until Close, then drains it.
+    void Work(uint32_t index) {
+        SpscQueue<FlowWork>& queue = m_workers[index]->queue;
+        FlowWork work;
+        uint32_t idlePolls = 0;
+        for (;;) {
+            // Read the flag before draining: everything pushed before Close is then seen
+            bool stopping = m_stopping.load(std::memory_order_acquire);
+            bool any = false;
+            while (queue.Pop(work)) {
+                Tap& tap = m_taps[work.tap];
+                Meter(tap, tap.shards[index], work.packet, work.sequence);
+                any = true;
+            }
+            if (any) {
+                idlePolls = 0;
+            } else if (stopping) {
+                return;
+            } else if (++idlePolls < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    /**
+     * Adds a packet to its flow, writing the flows it ends.
+     *
+     * @param tap The tap the packet was seen on.
+     * @param shard The shard of the tap owning the packet's flow.
+     * @param p The packet.
+     * @param sequence Arrival order of the packet, the start order of a flow it starts.
+     */
+    void Meter(Tap& tap, Shard& shard, const FlowPacket& p, uint64_t sequence) {
+        ExpireIdle(tap, shard, p.timeUs);
+
+        FlowTable<FlowState>& flows = shard.flows;
+        FlowTableKey key = MakeFlowTableKey(p.tuple);
+        uint32_t handle = flows.Find(key);
+        if (handle != FLOW_TABLE_NONE) {
+            FlowState& flow = flows.Get(handle);
+            bool closing = flow.IsClosing();
+            bool pureAck = p.tuple.tcpFlags == 0x10 && p.payload == 0;
+            if (p.timeUs - flow.startUs <= m_timeoutUs && (!closing || pureAck)) {
+                flow.Add(p, m_activityTimeoutUs);
+                if (closing || (p.tuple.tcpFlags & 0x04)) {
+                    EndFlow(tap, shard, handle, FLOW_END_TCP);
+                } else {
+                    flows.Touch(handle);
+                }
+                return;
+            }
+            EndFlow(tap, shard, handle, closing ? FLOW_END_TCP : FLOW_END_ACTIVE);
+        }
+
+        if (p.tuple.tcpFlags & 0x04) {
+            FlowState flow;
+            flow.Start(p, sequence);
+            WriteFlow(tap, shard, flow, FLOW_END_TCP);
+            return;
+        }
+        if (flows.IsFull()) {
+            EndFlow(tap, shard, flows.GetOldest(), FLOW_END_EVICTED);
+        }
+        handle = flows.Insert(key);
+        flows.Get(handle).Start(p, sequence);
+        shard.peakFlows = std::max(shard.peakFlows, flows.GetSize());
+    }
+
+    /// Ends the flows of a shard without a packet for the idle timeout before a time.
+    void ExpireIdle(Tap& tap, Shard& shard, int64_t nowUs) {
+        // Packets arrive in time order, so the idle flows are at the LRU end of the table
+        FlowTable<FlowState>& flows = shard.flows;
+        for (uint32_t oldest = flows.GetOldest();
+             oldest != FLOW_TABLE_NONE && nowUs - flows.Get(oldest).lastUs > m_idleTimeoutUs;
+             oldest = flows.GetOldest()) {
+            EndFlow(tap, shard, oldest, FLOW_END_IDLE);
+        }
+    }
+
+    /// Writes an open flow and removes it from the table.
+    void EndFlow(Tap& tap, Shard& shard, uint32_t handle, FlowEndReason reason) {
+        WriteFlow(tap, shard, shard.flows.Get(handle), reason);
+        shard.flows.Erase(handle);
+    }
+
+    /// Finishes a flow and queues its row; a full batch is written.
+    void WriteFlow(Tap& tap, Shard& shard, FlowState& flow, FlowEndReason reason) {
+        flow.Finish();
+        ++shard.written;
+        ++shard.ended[reason];
+        shard.attackFlows += (flow.label != ATTACK_BENIGN) ? 1 : 0;
+        shard.finished.push_back(flow);
+        if (shard.finished.size() >= FLOW_FEATURES_BATCH_FLOWS) {
+            Flush(tap, shard);
+        }
+    }
+
+    /// Finalizes the statistics of a shard's queued flows in one batch and writes their rows.
+    void Flush(Tap& tap, Shard& shard) {
+        if (shard.finished.empty()) {
+            return;
+        }
+        for (FlowState& flow : shard.finished) {
+            flow.AddStats(shard.batch);
+        }
+        shard.batch.Finalize();
+        shard.rows.clear();
+        for (const FlowState& flow : shard.finished) {
+            AppendFlowRow(flow, shard.rows);
+        }
+        {
+            // Workers share the tap's file; a batch of rows is written at once
+            std::lock_guard<std::mutex> lock(m_fileMutex);
+            tap.file->Write(shard.rows.data(), shard.rows.size());
+        }
+        shard.finished.clear();
+    }
+
+    const AttackSchedule* m_schedule;     // Labels when tag labels are off, may be null
+    bool m_tagLabels;                     // Labels from AttackTags instead of schedule windows
+    int64_t m_timeoutUs;                  // Active timeout
+    int64_t m_idleTimeoutUs;              // Idle timeout
+    int64_t m_activityTimeoutUs;          // Activity timeout (active/idle periods)
+    uint32_t m_capacity;                  // Open flows per tap
+    uint32_t m_threads;                   // Worker threads, 0 = simulator thread
+    uint64_t m_sequence;                  // IPv4 packets seen on all taps
+    std::vector<Tap> m_taps;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<bool> m_stopping;         // Set by Close; workers drain their queue and exit
+    std::mutex m_fileMutex;               // Serializes worker writes to the tap files
+    uint64_t m_stalls;                    // Pushes that found a full queue
+    uint64_t m_stallNs;                   // Simulator thread time spent waiting for queue space
+};
+
+} // namespace ns3
+
+#endif // IDS_FLOW_FEATURES_H
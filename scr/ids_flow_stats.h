@@ -0,0 +1,196 @@
+// Batched Flow Statistics Kernels for the IDS Dataset Simulation
+//
+// Packet-length and inter-arrival statistics are the hot path of the flow feature extractor
+// (ids_flow_features.h): every packet updates several of them. A per-packet Welford update
+// divides on every packet; FlowStat instead only accumulates the count, the shifted sum and sum of
+// squares, and the extremes, and the mean, variance and standard deviation are computed once, when
+// the flow has ended. Ended flows are finalized in batches: FlowStatBatch gathers the
+// accumulators of many statistics into structure-of-arrays buffers and runs one kernel over them,
+// four statistics per AVX2 instruction where the CPU supports it (checked at run time, so no
+// compiler flags are needed) and a scalar loop otherwise.
+//
+// The sums are taken around the first value of the series (shifted data), which keeps the
+// variance exact to a few ulps for series such as inter-arrival times whose mean is large
+// compared with their spread.
+//
+// ids_flow_stats_bench.cc compares the batched kernels with the per-packet Welford update. Only
+// depends on the C++ standard library.
+
+#ifndef IDS_FLOW_STATS_H
+#define IDS_FLOW_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define IDS_FLOW_STATS_AVX2 1
+#include <immintrin.h>
+#else
+#define IDS_FLOW_STATS_AVX2 0
+#endif
+
+namespace ns3 {
+
+/// Accumulated series of one flow statistic; mean, variance and stdDev are set when finalized.
+struct FlowStat {
+    uint64_t n = 0;
+    double shift = 0.0;        // First value; sums are taken around it
+    double sum = 0.0;          // Sum of (x - shift)
+    double sumSq = 0.0;        // Sum of (x - shift)^2
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;         // Set by FinalizeFlowStat or FlowStatBatch::Finalize
+    double variance = 0.0;     // Sample variance, 0 for fewer than two values
+    double stdDev = 0.0;       // Sample standard deviation
+
+    void Add(double x) {
+        if (n == 0) {
+            shift = x;
+            min = x;
+            max = x;
+        }
+        double d = x - shift;
+        ++n;
+        sum += d;
+        sumSq += d * d;
+        min = std::min(min, x);
+        max = std::max(max, x);
+    }
+
+    /// Sum of the values.
+    double Total() const { return sum + shift * static_cast<double>(n); }
+};
+
+/**
+ * Computes mean, sample variance and standard deviation from accumulated sums, scalar loop.
+ *
+ * @param count Number of statistics.
+ * @param n Values per statistic.
+ * @param shift Shift of each statistic.
+ * @param sum Shifted sums.
+ * @param sumSq Shifted sums of squares.
+ * @param mean Receives the means.
+ * @param variance Receives the sample variances.
+ * @param stdDev Receives the sample standard deviations.
+ */
+inline void FinalizeMomentsScalar(size_t count, const double* n, const double* shift, const double* sum,
+                                  const double* sumSq, double* mean, double* variance, double* stdDev) {
+    for (size_t i = 0; i < count; ++i) {
+        double values = std::max(n[i], 1.0);
+        mean[i] = shift[i] + sum[i] / values;
+        double v = (n[i] > 1.0) ? (sumSq[i] - sum[i] * sum[i] / values) / (n[i] - 1.0) : 0.0;
+        variance[i] = std::max(v, 0.0);
+        stdDev[i] = std::sqrt(variance[i]);
+    }
+}
+
+#if IDS_FLOW_STATS_AVX2
+/// FinalizeMomentsScalar for four statistics per instruction; the tail uses the scalar loop.
+__attribute__((target("avx2"))) inline void FinalizeMomentsAvx2(size_t count, const double* n, const double* shift,
+                                                                const double* sum, const double* sumSq, double* mean,
+                                                                double* variance, double* stdDev) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d vn = _mm256_loadu_pd(n + i);
+        __m256d vs = _mm256_loadu_pd(sum + i);
+        __m256d values = _mm256_max_pd(vn, one);
+        __m256d m = _mm256_add_pd(_mm256_loadu_pd(shift + i), _mm256_div_pd(vs, values));
+        __m256d centered = _mm256_sub_pd(_mm256_loadu_pd(sumSq + i), _mm256_div_pd(_mm256_mul_pd(vs, vs), values));
+        __m256d v = _mm256_div_pd(centered, _mm256_max_pd(_mm256_sub_pd(vn, one), one));
+        v = _mm256_and_pd(v, _mm256_cmp_pd(vn, one, _CMP_GT_OQ));   // 0 for fewer than two values
+        v = _mm256_max_pd(v, zero);
+        _mm256_storeu_pd(mean + i, m);
+        _mm256_storeu_pd(variance + i, v);
+        _mm256_storeu_pd(stdDev + i, _mm256_sqrt_pd(v));
+    }
+    FinalizeMomentsScalar(count - i, n + i, shift + i, sum + i, sumSq + i, mean + i, variance + i, stdDev + i);
+}
+#endif
+
+/// Returns true if the batched kernels use AVX2 on this CPU.
+inline bool FlowStatsUseAvx2() {
+#if IDS_FLOW_STATS_AVX2
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+/// FinalizeMomentsScalar, or its AVX2 version where the CPU supports it.
+inline void FinalizeMoments(size_t count, const double* n, const double* shift, const double* sum,
+                            const double* sumSq, double* mean, double* variance, double* stdDev) {
+#if IDS_FLOW_STATS_AVX2
+    if (FlowStatsUseAvx2()) {
+        FinalizeMomentsAvx2(count, n, shift, sum, sumSq, mean, variance, stdDev);
+        return;
+    }
+#endif
+    FinalizeMomentsScalar(count, n, shift, sum, sumSq, mean, variance, stdDev);
+}
+
+/// Finalizes a single statistic (scalar).
+inline void FinalizeFlowStat(FlowStat& s) {
+    double n = static_cast<double>(s.n);
+    FinalizeMomentsScalar(1, &n, &s.shift, &s.sum, &s.sumSq, &s.mean, &s.variance, &s.stdDev);
+}
+
+/**
+ * Finalizes many statistics at once through structure-of-arrays buffers.
+ *
+ * Add gathers the accumulators of each statistic, Finalize runs the kernel over all of them and
+ * writes mean, variance and stdDev back. The buffers are kept between batches.
+ */
+class FlowStatBatch {
+public:
+    /// Adds a statistic to the batch; it must stay valid until Finalize.
+    void Add(FlowStat* stat) {
+        m_stats.push_back(stat);
+        m_n.push_back(static_cast<double>(stat->n));
+        m_shift.push_back(stat->shift);
+        m_sum.push_back(stat->sum);
+        m_sumSq.push_back(stat->sumSq);
+    }
+
+    /// Statistics added since the last Finalize.
+    size_t GetSize() const { return m_stats.size(); }
+
+    /// Computes every statistic in the batch and empties it.
+    void Finalize() {
+        size_t count = m_stats.size();
+        m_mean.resize(count);
+        m_variance.resize(count);
+        m_stdDev.resize(count);
+        FinalizeMoments(count, m_n.data(), m_shift.data(), m_sum.data(), m_sumSq.data(), m_mean.data(),
+                        m_variance.data(), m_stdDev.data());
+        for (size_t i = 0; i < count; ++i) {
+            m_stats[i]->mean = m_mean[i];
+            m_stats[i]->variance = m_variance[i];
+            m_stats[i]->stdDev = m_stdDev[i];
+        }
+        m_stats.clear();
+        m_n.clear();
+        m_shift.clear();
+        m_sum.clear();
+        m_sumSq.clear();
+    }
+
+private:
+    std::vector<FlowStat*> m_stats;       // Statistics the results are written back to
+    std::vector<double> m_n;              // Inputs, one entry per statistic
+    std::vector<double> m_shift;
+    std::vector<double> m_sum;
+    std::vector<double> m_sumSq;
+    std::vector<double> m_mean;           // Outputs
+    std::vector<double> m_variance;
+    std::vector<double> m_stdDev;
+};
+
+} // namespace ns3
+
+#endif // IDS_FLOW_STATS_H
@@ -0,0 +1,297 @@
+// IDS Flow Statistics Micro-Benchmark
+// Compares the per-packet Welford update the flow feature extractor used to run with the
+// accumulate-then-finalize scheme of ids_flow_stats.h, on synthetic flows shaped like the
+// extractor's: every packet updates the flow length and inter-arrival statistics and those of its
+// direction, and every flow's statistics are finalized when it ends, 64 flows per batch.
+//
+// Variants:
+// - welford:        per-packet Welford update (one division per value), std computed per statistic.
+// - batched-scalar: FlowStat accumulation, batched finalize with the scalar kernel.
+// - batched-avx2:   FlowStat accumulation, finalize with the AVX2 kernel (only run on x86-64 CPUs
+//                   with AVX2).
+// Each variant runs --repeat times on the same pre-generated values and the fastest run is
+// reported as a JSON line: ns per packet for the updates, ns per statistic for the finalization
+// (including the structure-of-arrays gather and scatter) and the largest relative difference of
+// the means and standard deviations from the Welford results. A last line times the finalize
+// kernels alone over all statistics at once.
+//
+// The benchmark only depends on ids_flow_stats.h and the C++ standard library, so it can be built
+// inside the ns-3 scratch directory or on its own:
+//   g++ -O2 -std=c++17 -o ids_flow_stats_bench ids_flow_stats_bench.cc
+//
+// Usage:
+//   ids_flow_stats_bench [--flows=100000] [--packets=20] [--repeat=5] [--seed=1]
+
+#include "ids_flow_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+constexpr size_t STATS_PER_FLOW = 6;   // Length, forward/backward length, IAT, forward/backward IAT
+constexpr size_t BATCH_FLOWS = 64;     // As FLOW_FEATURES_BATCH_FLOWS
+
+/// The per-packet update of the extractor before ids_flow_stats.h.
+struct WelfordStat {
+    uint64_t n = 0;
+    double sum = 0.0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double stdDev = 0.0;
+
+    void Add(double x) {
+        ++n;
+        sum += x;
+        min = (n == 1 || x < min) ? x : min;
+        max = (n == 1 || x > max) ? x : max;
+        double delta = x - mean;
+        mean += delta / n;
+        m2 += delta * (x - mean);
+    }
+};
+
+/// Synthetic packets of all flows, flow after flow.
+struct Traffic {
+    std::vector<size_t> start;      // First packet of each flow, plus the end
+    std::vector<double> length;     // Payload bytes
+    std::vector<double> gapUs;      // Gap to the previous packet of the flow, microseconds
+    std::vector<uint8_t> forward;   // 1 for forward packets
+};
+
+Traffic Generate(size_t flows, double meanPackets, uint32_t seed) {
+    std::mt19937_64 rng(seed);
+    std::geometric_distribution<size_t> packets(1.0 / meanPackets);
+    std::uniform_int_distribution<int> length(0, 1460);
+    std::exponential_distribution<double> gap(1.0 / 20000.0);
+    Traffic t;
+    t.start.reserve(flows + 1);
+    for (size_t f = 0; f < flows; ++f) {
+        t.start.push_back(t.length.size());
+        size_t count = 1 + packets(rng);
+        for (size_t i = 0; i < count; ++i) {
+            t.length.push_back(length(rng));
+            t.gapUs.push_back(std::floor(gap(rng)));
+            t.forward.push_back((rng() & 3) != 0);
+        }
+    }
+    t.start.push_back(t.length.size());
+    return t;
+}
+
+/// Updates the statistics of one flow as FlowState does, one packet at a time.
+template <typename Stat>
+void Update(const Traffic& t, size_t flow, Stat* s) {
+    double fwdGap = 0.0;
+    double bwdGap = 0.0;
+    for (size_t i = t.start[flow]; i < t.start[flow + 1]; ++i) {
+        s[0].Add(t.length[i]);
+        if (i > t.start[flow]) {
+            s[3].Add(t.gapUs[i]);
+        }
+        fwdGap += t.gapUs[i];
+        bwdGap += t.gapUs[i];
+        if (t.forward[i]) {
+            if (s[1].n > 0) {
+                s[4].Add(fwdGap);
+            }
+            s[1].Add(t.length[i]);
+            fwdGap = 0.0;
+        } else {
+            if (s[2].n > 0) {
+                s[5].Add(bwdGap);
+            }
+            s[2].Add(t.length[i]);
+            bwdGap = 0.0;
+        }
+    }
+}
+
+struct Timing {
+    double updateNs = 1e300;        // Fastest update pass
+    double finalizeNs = 1e300;      // Fastest finalize pass
+};
+
+double Since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+Timing RunWelford(const Traffic& t, int repeat, std::vector<WelfordStat>& stats) {
+    Timing best;
+    size_t flows = t.start.size() - 1;
+    for (int r = 0; r < repeat; ++r) {
+        stats.assign(flows * STATS_PER_FLOW, WelfordStat());
+        auto start = std::chrono::steady_clock::now();
+        for (size_t f = 0; f < flows; ++f) {
+            Update(t, f, &stats[f * STATS_PER_FLOW]);
+        }
+        best.updateNs = std::min(best.updateNs, Since(start));
+        start = std::chrono::steady_clock::now();
+        for (WelfordStat& s : stats) {
+            s.stdDev = std::sqrt(s.n > 1 ? s.m2 / (s.n - 1) : 0.0);
+        }
+        best.finalizeNs = std::min(best.finalizeNs, Since(start));
+    }
+    return best;
+}
+
+/// Signature of FinalizeMomentsScalar and FinalizeMomentsAvx2.
+using Kernel = void (*)(size_t, const double*, const double*, const double*, const double*, double*, double*,
+                        double*);
+
+/// Accumulates with FlowStat and finalizes batches of flows through SoA buffers, as FlowStatBatch.
+Timing RunBatched(const Traffic& t, int repeat, Kernel kernel, std::vector<FlowStat>& stats) {
+    Timing best;
+    size_t flows = t.start.size() - 1;
+    size_t batch = BATCH_FLOWS * STATS_PER_FLOW;
+    std::vector<double> n(batch);
+    std::vector<double> shift(batch);
+    std::vector<double> sum(batch);
+    std::vector<double> sumSq(batch);
+    std::vector<double> mean(batch);
+    std::vector<double> variance(batch);
+    std::vector<double> stdDev(batch);
+    for (int r = 0; r < repeat; ++r) {
+        stats.assign(flows * STATS_PER_FLOW, FlowStat());
+        auto start = std::chrono::steady_clock::now();
+        for (size_t f = 0; f < flows; ++f) {
+            Update(t, f, &stats[f * STATS_PER_FLOW]);
+        }
+        best.updateNs = std::min(best.updateNs, Since(start));
+        start = std::chrono::steady_clock::now();
+        for (size_t first = 0; first < stats.size(); first += batch) {
+            size_t count = std::min(batch, stats.size() - first);
+            for (size_t i = 0; i < count; ++i) {
+                const FlowStat& s = stats[first + i];
+                n[i] = static_cast<double>(s.n);
+                shift[i] = s.shift;
+                sum[i] = s.sum;
+                sumSq[i] = s.sumSq;
+            }
+            kernel(count, n.data(), shift.data(), sum.data(), sumSq.data(), mean.data(), variance.data(),
+                   stdDev.data());
+            for (size_t i = 0; i < count; ++i) {
+                FlowStat& s = stats[first + i];
+                s.mean = mean[i];
+                s.variance = variance[i];
+                s.stdDev = stdDev[i];
+            }
+        }
+        best.finalizeNs = std::min(best.finalizeNs, Since(start));
+    }
+    return best;
+}
+
+/// Largest relative difference of the means and standard deviations.
+double MaxDifference(const std::vector<WelfordStat>& reference, const std::vector<FlowStat>& stats) {
+    double worst = 0.0;
+    auto relative = [](double a, double b) { return std::fabs(a - b) / std::max(std::fabs(b), 1e-9); };
+    for (size_t i = 0; i < stats.size(); ++i) {
+        worst = std::max(worst, relative(stats[i].mean, reference[i].mean));
+        worst = std::max(worst, relative(stats[i].stdDev, reference[i].stdDev));
+    }
+    return worst;
+}
+
+void Print(const char* variant, const Timing& timing, size_t packets, size_t stats, double difference) {
+    std::printf("{\"variant\":\"%s\",\"packets\":%zu,\"stats\":%zu,\"update_ns_per_packet\":%.3f,"
+                "\"finalize_ns_per_stat\":%.3f,\"max_rel_diff\":%.3g}\n",
+                variant, packets, stats, timing.updateNs / packets, timing.finalizeNs / stats, difference);
+}
+
+/// Returns the value of a --name=value argument, or an empty string.
+std::string OptionValue(const char* arg, const char* name) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return "";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    size_t flows = 100000;
+    double meanPackets = 20.0;
+    int repeat = 5;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (!(value = OptionValue(argv[i], "--flows")).empty()) {
+            flows = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (!(value = OptionValue(argv[i], "--packets")).empty()) {
+            meanPackets = std::strtod(value.c_str(), nullptr);
+        } else if (!(value = OptionValue(argv[i], "--repeat")).empty()) {
+            repeat = std::atoi(value.c_str());
+        } else if (!(value = OptionValue(argv[i], "--seed")).empty()) {
+            seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--flows=100000] [--packets=20] [--repeat=5] [--seed=1]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (flows == 0 || meanPackets < 1.0 || repeat < 1) {
+        std::fprintf(stderr, "--flows and --repeat must be positive and --packets at least 1\n");
+        return 1;
+    }
+
+    Traffic traffic = Generate(flows, meanPackets, seed);
+    size_t packets = traffic.length.size();
+    size_t statCount = flows * STATS_PER_FLOW;
+
+    std::vector<WelfordStat> reference;
+    Print("welford", RunWelford(traffic, repeat, reference), packets, statCount, 0.0);
+
+    std::vector<FlowStat> stats;
+    Print("batched-scalar", RunBatched(traffic, repeat, FinalizeMomentsScalar, stats), packets, statCount,
+          MaxDifference(reference, stats));
+#if IDS_FLOW_STATS_AVX2
+    if (FlowStatsUseAvx2()) {
+        Print("batched-avx2", RunBatched(traffic, repeat, FinalizeMomentsAvx2, stats), packets, statCount,
+              MaxDifference(reference, stats));
+    } else {
+        std::printf("{\"variant\":\"batched-avx2\",\"skipped\":\"no AVX2 on this CPU\"}\n");
+    }
+#endif
+
+    // Kernels alone, over every statistic at once
+    std::vector<double> n(statCount);
+    std::vector<double> shift(statCount);
+    std::vector<double> sum(statCount);
+    std::vector<double> sumSq(statCount);
+    std::vector<double> mean(statCount);
+    std::vector<double> variance(statCount);
+    std::vector<double> stdDev(statCount);
+    for (size_t i = 0; i < statCount; ++i) {
+        n[i] = static_cast<double>(stats[i].n);
+        shift[i] = stats[i].shift;
+        sum[i] = stats[i].sum;
+        sumSq[i] = stats[i].sumSq;
+    }
+    double scalarNs = 1e300;
+    double dispatchNs = 1e300;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        FinalizeMomentsScalar(statCount, n.data(), shift.data(), sum.data(), sumSq.data(), mean.data(),
+                              variance.data(), stdDev.data());
+        scalarNs = std::min(scalarNs, Since(start));
+        start = std::chrono::steady_clock::now();
+        FinalizeMoments(statCount, n.data(), shift.data(), sum.data(), sumSq.data(), mean.data(), variance.data(),
+                        stdDev.data());
+        dispatchNs = std::min(dispatchNs, Since(start));
+    }
+    std::printf("{\"variant\":\"kernels\",\"stats\":%zu,\"scalar_ns_per_stat\":%.3f,\"%s_ns_per_stat\":%.3f}\n",
+                statCount, scalarNs / statCount, FlowStatsUseAvx2() ? "avx2" : "scalar", dispatchNs / statCount);
+    return 0;
+}
@@ -0,0 +1,247 @@
+// Bounded Flow Table for the IDS Dataset Simulation
+//
+// Brute-force loops, port scans and DNS lookups each open a new flow, so a flow table keyed by
+// an unbounded hash map grows with the attack intensity and the client count. This table has a
+// fixed capacity chosen up front:
+// - Entries live in a pool of at most `capacity` slots, addressed by a uint32_t handle that stays
+//   valid until the entry is erased. The pool grows on demand up to the capacity and never
+//   beyond, so memory is bounded by the capacity and small runs do not pay for it.
+// - Lookups go through an open-addressing index (linear probing, at least twice the capacity so
+//   the load stays at or below 0.5) holding handles only. Erasing shifts the following index
+//   entries back instead of leaving tombstones, so probe lengths do not degrade over a long run.
+// - Every entry is on an LRU list ordered by its last Touch. The owner expires idle entries by
+//   walking the list from the oldest end, and evicts the oldest entry when the table is full.
+//
+// The table does not know about time or timeouts; the owner (ids_flow_features.h) decides when an
+// entry is finished and writes its record before erasing it.
+
+#ifndef IDS_FLOW_TABLE_H
+#define IDS_FLOW_TABLE_H
+
+#include "ids_attack_schedule.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+constexpr uint32_t FLOW_TABLE_NONE = 0xffffffffu;   // Invalid handle / empty index slot
+
+/// Bidirectional 5-tuple, lower (address, port) endpoint first.
+struct FlowTableKey {
+    uint32_t lowIp;
+    uint32_t highIp;
+    uint16_t lowPort;
+    uint16_t highPort;
+    uint8_t protocol;
+
+    bool operator==(const FlowTableKey& o) const {
+        return lowIp == o.lowIp && highIp == o.highIp && lowPort == o.lowPort && highPort == o.highPort &&
+               protocol == o.protocol;
+    }
+};
+
+/// Returns the key of a packet's flow; both directions of a flow share it.
+inline FlowTableKey MakeFlowTableKey(const PacketTuple& t) {
+    bool swap = t.src > t.dst || (t.src == t.dst && t.srcPort > t.dstPort);
+    return swap ? FlowTableKey{t.dst, t.src, t.dstPort, t.srcPort, t.protocol}
+                : FlowTableKey{t.src, t.dst, t.srcPort, t.dstPort, t.protocol};
+}
+
+/// 64-bit mix of a key (splitmix64 finalizer); linear probing needs well-spread low bits.
+inline uint64_t HashFlowTableKey(const FlowTableKey& k) {
+    uint64_t x = ((uint64_t(k.lowIp) << 32) | k.highIp) ^
+                 (((uint64_t(k.lowPort) << 24) | (uint64_t(k.highPort) << 8) | k.protocol) * 0x9e3779b97f4a7c15ULL);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Fixed-capacity flow table with an open-addressing index and an LRU list.
+ *
+ * @tparam Value Per-flow state, default-constructible.
+ */
+template <typename Value>
+class FlowTable {
+public:
+    FlowTable() : m_capacity(0), m_mask(0), m_size(0), m_free(FLOW_TABLE_NONE), m_oldest(FLOW_TABLE_NONE),
+                  m_newest(FLOW_TABLE_NONE) {}
+
+    /**
+     * Sets the capacity and clears the table.
+     *
+     * @param capacity Maximum number of entries, at least 1.
+     */
+    void SetCapacity(uint32_t capacity) {
+        m_capacity = capacity > 0 ? capacity : 1;
+        uint32_t slots = 2;
+        while (slots < 2ull * m_capacity) {
+            slots <<= 1;
+        }
+        m_index.assign(slots, FLOW_TABLE_NONE);
+        m_mask = slots - 1;
+        m_entries.clear();
+        m_entries.shrink_to_fit();
+        m_size = 0;
+        m_free = FLOW_TABLE_NONE;
+        m_oldest = FLOW_TABLE_NONE;
+        m_newest = FLOW_TABLE_NONE;
+    }
+
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint32_t GetSize() const { return m_size; }
+    bool IsFull() const { return m_size >= m_capacity; }
+
+    /// Returns the handle of a key's entry, or FLOW_TABLE_NONE.
+    uint32_t Find(const FlowTableKey& key) const {
+        for (uint32_t slot = Home(key);; slot = (slot + 1) & m_mask) {
+            uint32_t handle = m_index[slot];
+            if (handle == FLOW_TABLE_NONE || m_entries[handle].key == key) {
+                return handle;
+            }
+        }
+    }
+
+    /**
+     * Adds an entry for a key that is not in the table, as the newest entry. The table must not be
+     * full; references returned by Get before the call may be invalidated.
+     *
+     * @param key The flow key.
+     * @return The handle of the new, default-constructed entry.
+     */
+    uint32_t Insert(const FlowTableKey& key) {
+        uint32_t handle;
+        if (m_free != FLOW_TABLE_NONE) {
+            handle = m_free;
+            m_free = m_entries[handle].next;
+            m_entries[handle].value = Value();
+        } else {
+            handle = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        }
+        Entry& e = m_entries[handle];
+        e.key = key;
+        e.used = true;
+        Link(handle);
+        uint32_t slot = Home(key);
+        while (m_index[slot] != FLOW_TABLE_NONE) {
+            slot = (slot + 1) & m_mask;
+        }
+        m_index[slot] = handle;
+        ++m_size;
+        return handle;
+    }
+
+    /// Removes an entry; its handle becomes invalid.
+    void Erase(uint32_t handle) {
+        Entry& e = m_entries[handle];
+        uint32_t slot = Home(e.key);
+        while (m_index[slot] != handle) {
+            slot = (slot + 1) & m_mask;
+        }
+        // Backward-shift deletion: move later entries of the probe run into the hole
+        uint32_t hole = slot;
+        for (uint32_t next = (hole + 1) & m_mask; m_index[next] != FLOW_TABLE_NONE; next = (next + 1) & m_mask) {
+            uint32_t home = Home(m_entries[m_index[next]].key);
+            bool movable = (next > hole) ? (home <= hole || home > next) : (home <= hole && home > next);
+            if (movable) {
+                m_index[hole] = m_index[next];
+                hole = next;
+            }
+        }
+        m_index[hole] = FLOW_TABLE_NONE;
+        Unlink(handle);
+        e.used = false;
+        e.value = Value();   // Release what the value holds
+        e.next = m_free;
+        m_free = handle;
+        --m_size;
+    }
+
+    /// Marks an entry as the most recently used.
+    void Touch(uint32_t handle) {
+        if (handle != m_newest) {
+            Unlink(handle);
+            Link(handle);
+        }
+    }
+
+    /// Handle of the least recently used entry, or FLOW_TABLE_NONE if the table is empty.
+    uint32_t GetOldest() const { return m_oldest; }
+
+    Value& Get(uint32_t handle) { return m_entries[handle].value; }
+    const Value& Get(uint32_t handle) const { return m_entries[handle].value; }
+
+    /**
+     * Calls f(handle, value) for every entry, in pool order.
+     *
+     * @param f The callback.
+     */
+    template <typename F>
+    void ForEach(F f) {
+        for (uint32_t handle = 0; handle < m_entries.size(); ++handle) {
+            if (m_entries[handle].used) {
+                f(handle, m_entries[handle].value);
+            }
+        }
+    }
+
+    /// Removes all entries; the capacity is kept.
+    void Clear() { SetCapacity(m_capacity); }
+
+private:
+    struct Entry {
+        FlowTableKey key{};
+        Value value{};
+        uint32_t prev = FLOW_TABLE_NONE;   // Older neighbour on the LRU list
+        uint32_t next = FLOW_TABLE_NONE;   // Newer neighbour, or next free entry
+        bool used = false;
+    };
+
+    uint32_t Home(const FlowTableKey& key) const { return static_cast<uint32_t>(HashFlowTableKey(key)) & m_mask; }
+
+    /// Appends an entry at the newest end of the LRU list.
+    void Link(uint32_t handle) {
+        Entry& e = m_entries[handle];
+        e.prev = m_newest;
+        e.next = FLOW_TABLE_NONE;
+        if (m_newest != FLOW_TABLE_NONE) {
+            m_entries[m_newest].next = handle;
+        } else {
+            m_oldest = handle;
+        }
+        m_newest = handle;
+    }
+
+    /// Removes an entry from the LRU list.
+    void Unlink(uint32_t handle) {
+        Entry& e = m_entries[handle];
+        if (e.prev != FLOW_TABLE_NONE) {
+            m_entries[e.prev].next = e.next;
+        } else {
+            m_oldest = e.next;
+        }
+        if (e.next != FLOW_TABLE_NONE) {
+            m_entries[e.next].prev = e.prev;
+        } else {
+            m_newest = e.prev;
+        }
+    }
+
+    uint32_t m_capacity;                  // Maximum entries
+    uint32_t m_mask;                      // Index slots - 1
+    uint32_t m_size;                      // Entries in use
+    uint32_t m_free;                      // First free pool entry
+    uint32_t m_oldest;                    // LRU end of the list
+    uint32_t m_newest;                    // MRU end of the list
+    std::vector<uint32_t> m_index;        // Open-addressing index of handles
+    std::vector<Entry> m_entries;         // Entry pool, at most m_capacity entries
+};
+
+} // namespace ns3
+
+#endif // IDS_FLOW_TABLE_H
@@ -0,0 +1,180 @@
+// Incremental FlowMonitor Export for the IDS Dataset Simulation
+//
+// The FlowMonitor results used to be serialized once after Simulator::Run() as one large XML file
+// with per-flow histograms, so nothing was available before the run ended and every histogram
+// bin of every flow stayed in memory for the whole run. This exporter instead walks the flow
+// statistics every export interval and writes one compact CSV record for each flow that has gone
+// idle (no packet sent or received for the idle timeout) since its last record. Flows still
+// active are written on Close. Results can be read while the simulation is still running.
+//
+// FlowMonitor offers no way to remove a flow, so its per-flow entries stay; the exporter keeps
+// only one counter per flow. ids_dataset.cc widens the FlowMonitor histogram bins in this mode so
+// each histogram holds a single bin instead of growing with the delay, jitter and gap range.
+//
+// Output format (times in simulated seconds):
+//   flow_id,src_ip,src_port,dst_ip,dst_port,protocol,first_tx_s,last_tx_s,first_rx_s,last_rx_s,
+//   tx_packets,tx_bytes,rx_packets,rx_bytes,lost_packets,times_forwarded,delay_sum_s,jitter_sum_s,reason
+// reason is "idle" or "end". A flow that resumes after its idle record is written again with its
+// cumulative counters; the last record of a flow_id supersedes the earlier ones.
+
+#ifndef IDS_FLOWMON_EXPORT_H
+#define IDS_FLOWMON_EXPORT_H
+
+#include "ns3/flow-monitor.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+constexpr double FLOWMON_EXPORT_INTERVAL = 10.0;      // Seconds between exports
+constexpr double FLOWMON_EXPORT_IDLE_TIMEOUT = 30.0;  // Seconds without packets before a flow is written
+constexpr double FLOWMON_EXPORT_BIN_WIDTH = 1e6;      // Histogram bin width that keeps every histogram at one bin
+
+/**
+ * Writes the FlowMonitor statistics of idle flows periodically during the run.
+ */
+class FlowMonitorExporter {
+public:
+    FlowMonitorExporter() : m_file(nullptr), m_flows(0), m_idleRecords(0), m_endRecords(0) {}
+
+    ~FlowMonitorExporter() { Close(); }
+
+    FlowMonitorExporter(const FlowMonitorExporter&) = delete;
+    FlowMonitorExporter& operator=(const FlowMonitorExporter&) = delete;
+
+    /**
+     * Starts exporting and writes the CSV header. The first export runs one interval from now.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @param flowmon The installed FlowMonitor.
+     * @param classifier The IPv4 classifier of the FlowMonitorHelper, for the 5-tuples.
+     * @param interval Simulated time between exports.
+     * @param idleTimeout Time without packets after which a flow is written.
+     * @return true if the file is valid.
+     */
+    bool Open(AsyncOutputFile* file, Ptr<FlowMonitor> flowmon, Ptr<Ipv4FlowClassifier> classifier, Time interval,
+              Time idleTimeout) {
+        m_file = file;
+        if (m_file == nullptr) {
+            return false;
+        }
+        m_flowmon = flowmon;
+        m_classifier = classifier;
+        m_interval = interval;
+        m_idleTimeout = idleTimeout;
+        static const char header[] =
+            "flow_id,src_ip,src_port,dst_ip,dst_port,protocol,first_tx_s,last_tx_s,first_rx_s,last_rx_s,"
+            "tx_packets,tx_bytes,rx_packets,rx_bytes,lost_packets,times_forwarded,delay_sum_s,jitter_sum_s,reason\n";
+        m_file->Write(header, sizeof(header) - 1);
+        m_event = Simulator::Schedule(m_interval, &FlowMonitorExporter::Tick, this);
+        return true;
+    }
+
+    /// Writes every flow with packets since its last record and closes the file.
+    void Close() {
+        if (m_file == nullptr) {
+            return;
+        }
+        m_event.Cancel();
+        Export(true);
+        m_file->Close();
+        m_file = nullptr;
+    }
+
+    /// Records written since Open.
+    uint64_t GetRecordCount() const { return m_idleRecords + m_endRecords; }
+
+    /**
+     * Writes the number of records and flows.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        os << "FlowMonitor export: " << GetRecordCount() << " records (" << m_idleRecords << " idle, " << m_endRecords
+           << " at end) for " << m_flows << " flows" << std::endl;
+    }
+
+private:
+    /// Export timer; reschedules itself.
+    void Tick() {
+        Export(false);
+        m_event = Simulator::Schedule(m_interval, &FlowMonitorExporter::Tick, this);
+    }
+
+    /**
+     * Writes the flows that changed since their last record.
+     *
+     * @param final true on Close: write every changed flow, idle or not.
+     */
+    void Export(bool final) {
+        m_flowmon->CheckForLostPackets();
+        Time now = Simulator::Now();
+        const FlowMonitor::FlowStatsContainer& stats = m_flowmon->GetFlowStats();
+        m_flows = stats.size();
+        for (const auto& entry : stats) {
+            FlowId id = entry.first;
+            const FlowMonitor::FlowStats& s = entry.second;
+            if (id >= m_written.size()) {
+                m_written.resize(id + 1, 0);
+            }
+            uint64_t packets = s.txPackets + s.rxPackets + s.lostPackets;
+            if (packets == m_written[id]) {
+                continue;
+            }
+            if (!final && now - std::max(s.timeLastTxPacket, s.timeLastRxPacket) < m_idleTimeout) {
+                continue;
+            }
+            WriteRecord(id, s, final);
+            m_written[id] = packets;
+        }
+    }
+
+    void WriteRecord(FlowId id, const FlowMonitor::FlowStats& s, bool final) {
+        Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow(id);
+        std::string src = AttackSchedule::FormatAddress(t.sourceAddress.Get());
+        std::string dst = AttackSchedule::FormatAddress(t.destinationAddress.Get());
+        char line[384];
+        int n = std::snprintf(line, sizeof(line),
+                              "%u,%s,%u,%s,%u,%u,%.9f,%.9f,%.9f,%.9f,%u,%llu,%u,%llu,%u,%u,%.9f,%.9f,%s\n", id,
+                              src.c_str(), t.sourcePort, dst.c_str(), t.destinationPort, t.protocol,
+                              s.timeFirstTxPacket.GetSeconds(), s.timeLastTxPacket.GetSeconds(),
+                              s.timeFirstRxPacket.GetSeconds(), s.timeLastRxPacket.GetSeconds(),
+                              s.txPackets, static_cast<unsigned long long>(s.txBytes), s.rxPackets,
+                              static_cast<unsigned long long>(s.rxBytes), s.lostPackets, s.timesForwarded,
+                              s.delaySum.GetSeconds(), s.jitterSum.GetSeconds(), final ? "end" : "idle");
+        if (n > 0) {
+            m_file->Write(line, std::min<size_t>(n, sizeof(line) - 1));
+        }
+        if (final) {
+            ++m_endRecords;
+        } else {
+            ++m_idleRecords;
+        }
+    }
+
+    AsyncOutputFile* m_file;              // Flow records
+    Ptr<FlowMonitor> m_flowmon;
+    Ptr<Ipv4FlowClassifier> m_classifier;
+    Time m_interval;                      // Time between exports
+    Time m_idleTimeout;                   // Time without packets before a flow is written
+    EventId m_event;                      // Next export
+    std::vector<uint64_t> m_written;      // Packets (tx + rx + lost) of each flow at its last record
+    size_t m_flows;                       // Flows classified at the last export
+    uint64_t m_idleRecords;               // Records of idle flows
+    uint64_t m_endRecords;                // Records written on Close
+};
+
+} // namespace ns3
+
+#endif // IDS_FLOWMON_EXPORT_H
@@ -0,0 +1,237 @@
+// Sorted Binary Label Index for the IDS Dataset Simulation
+//
+// Joining labels onto packets or flows used to mean reading every capture again and matching its
+// records against the attack schedule. The capture manager writes this index while the simulation
+// runs instead: one fixed-size record per IPv4 packet written to a capture file, holding the packet
+// time, a direction-independent hash of its 5-tuple, its label and attack instance, and the capture
+// file and byte offset of its record. Packets are captured in simulation time order, so the records
+// are sorted by time without a sort pass; a consumer mmaps the file and binary-searches a time range,
+// then filters on the flow hash, and seeks straight to the packets it needs.
+//
+// The index can hold every packet or only the attack packets (a packet absent from an attack-only
+// index is benign). Non-IPv4 frames (ARP, 802.11 management) are not indexed.
+//
+// File layout (little-endian host order):
+// - LabelIndexFileHeader (16 bytes): magic "IDSLABIX", format version and record size.
+// - LabelIndexRecord entries (32 bytes each), sorted by time_ns.
+// - File table: the capture file paths, each terminated by a NUL byte, in file ID order. File IDs
+//   are 16-bit, so an index covers at most LABEL_INDEX_MAX_FILES capture files.
+// - LabelIndexFileTrailer (16 bytes): file table offset, file count and the magic "IDSL".
+//
+// Offsets are byte offsets of the pcap record header or pcapng Enhanced Packet Block in the
+// uncompressed capture; for LZ4 captures they refer to the decompressed stream.
+//
+// The flow hash is 64-bit FNV-1a over the 13 bytes lowIp, lowPort, highIp, highPort, protocol
+// (addresses and ports big-endian), where low is the endpoint with the smaller (address, port)
+// pair, so both directions of a flow share one hash. LabelFlowHash computes it for offline tools.
+//
+// Use ids_label_lookup.cc to query an index from the command line.
+
+#ifndef IDS_LABEL_INDEX_H
+#define IDS_LABEL_INDEX_H
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/// One indexed packet. The layout is fixed so the file can be mmapped and searched in place.
+struct LabelIndexRecord {
+    int64_t timeNs;        // Simulation time in nanoseconds
+    uint64_t flowHash;     // LabelFlowHash of the packet's 5-tuple
+    uint64_t offset;       // Offset of the packet record in its capture file
+    uint32_t instance;     // Attack instance (row of attack-schedule.csv), 0 = benign
+    uint16_t file;         // Capture file ID, index into the file table
+    uint8_t label;         // AttackLabel
+    uint8_t reserved;      // Padding, always zero
+};
+static_assert(sizeof(LabelIndexRecord) == 32, "LabelIndexRecord must stay 32 bytes");
+
+/// Header at the start of every label index.
+struct LabelIndexFileHeader {
+    char magic[8];         // "IDSLABIX"
+    uint32_t version;      // LABEL_INDEX_VERSION
+    uint32_t recordSize;   // sizeof(LabelIndexRecord)
+};
+static_assert(sizeof(LabelIndexFileHeader) == 16, "LabelIndexFileHeader must stay 16 bytes");
+
+/// Trailer at the end of every complete label index.
+struct LabelIndexFileTrailer {
+    uint64_t fileTableOffset;  // File offset of the first path of the file table
+    uint32_t fileCount;        // Paths in the file table
+    char magic[4];             // "IDSL"
+};
+static_assert(sizeof(LabelIndexFileTrailer) == 16, "LabelIndexFileTrailer must stay 16 bytes");
+
+constexpr char LABEL_INDEX_MAGIC[8] = {'I', 'D', 'S', 'L', 'A', 'B', 'I', 'X'};
+constexpr char LABEL_INDEX_TRAILER_MAGIC[4] = {'I', 'D', 'S', 'L'};
+constexpr uint32_t LABEL_INDEX_VERSION = 1;
+constexpr uint32_t LABEL_INDEX_MAX_FILES = 65536;   // File IDs representable in LabelIndexRecord::file
+
+/**
+ * Direction-independent 64-bit FNV-1a hash of a 5-tuple. Addresses in host byte order.
+ *
+ * @param src Source address.
+ * @param srcPort Source port, 0 for protocols without ports.
+ * @param dst Destination address.
+ * @param dstPort Destination port.
+ * @param protocol IP protocol number.
+ */
+inline uint64_t LabelFlowHash(uint32_t src, uint16_t srcPort, uint32_t dst, uint16_t dstPort, uint8_t protocol) {
+    if (src > dst || (src == dst && srcPort > dstPort)) {
+        std::swap(src, dst);
+        std::swap(srcPort, dstPort);
+    }
+    uint8_t bytes[13] = {static_cast<uint8_t>(src >> 24), static_cast<uint8_t>(src >> 16),
+                         static_cast<uint8_t>(src >> 8),  static_cast<uint8_t>(src),
+                         static_cast<uint8_t>(srcPort >> 8), static_cast<uint8_t>(srcPort),
+                         static_cast<uint8_t>(dst >> 24), static_cast<uint8_t>(dst >> 16),
+                         static_cast<uint8_t>(dst >> 8),  static_cast<uint8_t>(dst),
+                         static_cast<uint8_t>(dstPort >> 8), static_cast<uint8_t>(dstPort), protocol};
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint8_t b : bytes) {
+        hash = (hash ^ b) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * Appends label index records to an output file as packets are captured.
+ *
+ * Each record is serialized in place into the output buffer (one Reserve per packet); the file
+ * table is kept in memory and written with the trailer on Close.
+ */
+class LabelIndexWriter {
+public:
+    LabelIndexWriter() : m_file(nullptr), m_attacksOnly(false), m_records(0), m_attackRecords(0) {}
+
+    ~LabelIndexWriter() { Close(); }
+
+    LabelIndexWriter(const LabelIndexWriter&) = delete;
+    LabelIndexWriter& operator=(const LabelIndexWriter&) = delete;
+
+    /**
+     * Starts writing an index and writes its header.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @param attacksOnly Index only packets with an attack label.
+     * @return true if the file is valid.
+     */
+    bool Open(AsyncOutputFile* file, bool attacksOnly) {
+        Close();
+        m_file = file;
+        if (m_file == nullptr) {
+            return false;
+        }
+        m_attacksOnly = attacksOnly;
+        m_paths.clear();
+        m_records = 0;
+        m_attackRecords = 0;
+
+        LabelIndexFileHeader header;
+        std::memcpy(header.magic, LABEL_INDEX_MAGIC, sizeof(header.magic));
+        header.version = LABEL_INDEX_VERSION;
+        header.recordSize = sizeof(LabelIndexRecord);
+        m_file->Write(&header, sizeof(header));
+        return true;
+    }
+
+    /// Returns true while an index is open.
+    bool IsOpen() const { return m_file != nullptr; }
+
+    /**
+     * Adds a capture file to the file table.
+     *
+     * @param path Path of the capture file as written.
+     * @param file Receives the file ID used in the records.
+     * @return false if the file table already holds LABEL_INDEX_MAX_FILES files.
+     */
+    bool AddFile(const std::string& path, uint16_t& file) {
+        if (m_paths.size() >= LABEL_INDEX_MAX_FILES) {
+            return false;
+        }
+        file = static_cast<uint16_t>(m_paths.size());
+        m_paths.push_back(path);
+        return true;
+    }
+
+    /**
+     * Appends the record of one captured packet. Records must be added in time order.
+     *
+     * @param timeNs Capture time in nanoseconds.
+     * @param tuple Addressing fields of the packet.
+     * @param instance Attack instance, 0 for benign packets.
+     * @param label AttackLabel of the packet.
+     * @param file File ID returned by AddFile.
+     * @param offset Offset of the packet record in the capture file.
+     */
+    void Record(int64_t timeNs, const PacketTuple& tuple, uint32_t instance, uint8_t label, uint16_t file,
+                uint64_t offset) {
+        if (m_file == nullptr || (m_attacksOnly && label == ATTACK_BENIGN)) {
+            return;
+        }
+        char* out = m_file->Reserve(sizeof(LabelIndexRecord));
+        if (out == nullptr) {
+            return;
+        }
+        LabelIndexRecord record;
+        record.timeNs = timeNs;
+        record.flowHash = LabelFlowHash(tuple.src, tuple.srcPort, tuple.dst, tuple.dstPort, tuple.protocol);
+        record.offset = offset;
+        record.instance = instance;
+        record.file = file;
+        record.label = label;
+        record.reserved = 0;
+        std::memcpy(out, &record, sizeof(record));
+        ++m_records;
+        m_attackRecords += (label != ATTACK_BENIGN) ? 1 : 0;
+    }
+
+    /// Writes the file table and the trailer and closes the index.
+    void Close() {
+        if (m_file == nullptr) {
+            return;
+        }
+        LabelIndexFileTrailer trailer;
+        trailer.fileTableOffset = m_file->GetBytesWritten();
+        trailer.fileCount = static_cast<uint32_t>(m_paths.size());
+        std::memcpy(trailer.magic, LABEL_INDEX_TRAILER_MAGIC, sizeof(trailer.magic));
+        for (const std::string& path : m_paths) {
+            m_file->Write(path.c_str(), path.size() + 1);
+        }
+        m_file->Write(&trailer, sizeof(trailer));
+        m_file->Close();
+        m_file = nullptr;
+    }
+
+    /// Records written since Open.
+    uint64_t GetRecordCount() const { return m_records; }
+
+    /**
+     * Writes the number of records and capture files.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        os << "Label index: " << m_records << " records (" << m_attackRecords << " attack) over " << m_paths.size()
+           << " capture files" << (m_attacksOnly ? ", attack packets only" : "") << std::endl;
+    }
+
+private:
+    AsyncOutputFile* m_file;              // Index file
+    bool m_attacksOnly;                   // Skip benign packets
+    std::vector<std::string> m_paths;     // File table
+    uint64_t m_records;                   // Records written since Open
+    uint64_t m_attackRecords;             // Of which attack-labelled
+};
+
+} // namespace ns3
+
+#endif // IDS_LABEL_INDEX_H
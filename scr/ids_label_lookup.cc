@@ -0,0 +1,233 @@
+// IDS Label Index Lookup
+// Queries the label index written next to the captures by ids_dataset.cc (--capture-label-index).
+// The index is mapped with mmap; a time range is found with two binary searches over the sorted
+// records, so a query touches only the records it prints. A flow filter compares the
+// direction-independent flow hash of every record in the range. Without a range or flow the
+// records, time span and per-label packet counts are summarized; otherwise the matching records
+// are printed as CSV:
+//   time_s,flow_hash,label,instance,file,offset
+// where offset is the byte offset of the packet record in the (uncompressed) capture file.
+//
+// The tool only depends on ids_label_index.h and the C++ standard library, so it can be built
+// inside the ns-3 scratch directory or on its own:
+//   g++ -O2 -std=c++17 -pthread -o ids_label_lookup ids_label_lookup.cc
+//
+// Usage:
+//   ids_label_lookup <label-index.bin> [--from=S] [--to=S] [--flow=ip:port,ip:port,tcp|udp|N]
+//                    [--attacks]
+
+#include "ids_label_index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/// Returns the value of a --name=value argument, or an empty string.
+static std::string OptionValue(const char* arg, const char* name) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length) == 0 && arg[length] == '=') {
+        return arg + length + 1;
+    }
+    return "";
+}
+
+/// Parses "ip:port" into a host-order address and port.
+static bool ParseEndpoint(const std::string& text, uint32_t& address, uint16_t& port) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || !AttackSchedule::ParseAddress(text.substr(0, colon).c_str(), address)) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long value = std::strtoul(text.c_str() + colon + 1, &end, 10);
+    if (end == text.c_str() + colon + 1 || *end != '\0' || value > 65535) {
+        return false;
+    }
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+/// Parses "ip:port,ip:port,protocol" into the flow hash used by the index.
+static bool ParseFlow(const std::string& text, uint64_t& hash) {
+    size_t first = text.find(',');
+    size_t second = (first == std::string::npos) ? std::string::npos : text.find(',', first + 1);
+    if (second == std::string::npos) {
+        return false;
+    }
+    uint32_t src;
+    uint32_t dst;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    if (!ParseEndpoint(text.substr(0, first), src, srcPort) ||
+        !ParseEndpoint(text.substr(first + 1, second - first - 1), dst, dstPort)) {
+        return false;
+    }
+    std::string protocolName = text.substr(second + 1);
+    unsigned long protocol;
+    if (protocolName == "tcp") {
+        protocol = 6;
+    } else if (protocolName == "udp") {
+        protocol = 17;
+    } else {
+        char* end = nullptr;
+        protocol = std::strtoul(protocolName.c_str(), &end, 10);
+        if (protocolName.empty() || *end != '\0' || protocol > 255) {
+            return false;
+        }
+    }
+    hash = LabelFlowHash(src, srcPort, dst, dstPort, static_cast<uint8_t>(protocol));
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    const char* path = nullptr;
+    bool ranged = false;
+    int64_t fromNs = INT64_MIN;
+    int64_t toNs = INT64_MAX;
+    bool byFlow = false;
+    uint64_t flowHash = 0;
+    bool attacksOnly = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (!(value = OptionValue(argv[i], "--from")).empty()) {
+            fromNs = static_cast<int64_t>(std::strtod(value.c_str(), nullptr) * 1e9);
+            ranged = true;
+        } else if (!(value = OptionValue(argv[i], "--to")).empty()) {
+            toNs = static_cast<int64_t>(std::strtod(value.c_str(), nullptr) * 1e9);
+            ranged = true;
+        } else if (!(value = OptionValue(argv[i], "--flow")).empty()) {
+            if (!ParseFlow(value, flowHash)) {
+                std::fprintf(stderr, "Invalid --flow: %s (expected ip:port,ip:port,tcp|udp|N)\n", value.c_str());
+                return 1;
+            }
+            byFlow = true;
+        } else if (std::strcmp(argv[i], "--attacks") == 0) {
+            attacksOnly = true;
+        } else if (argv[i][0] == '-' || path != nullptr) {
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr) {
+        std::fprintf(stderr, "Usage: %s <label-index.bin> [--from=S] [--to=S] [--flow=ip:port,ip:port,proto] "
+                             "[--attacks]\n", argv[0]);
+        return 1;
+    }
+
+    int fd = ::open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    if (fileSize < sizeof(LabelIndexFileHeader) + sizeof(LabelIndexFileTrailer)) {
+        std::fprintf(stderr, "%s is not an IDS label index\n", path);
+        ::close(fd);
+        return 1;
+    }
+    void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::fprintf(stderr, "Cannot map %s\n", path);
+        return 1;
+    }
+    const char* base = static_cast<const char*>(mapping);
+
+    // Validate header and trailer before trusting any offset in the file
+    LabelIndexFileHeader header;
+    LabelIndexFileTrailer trailer;
+    std::memcpy(&header, base, sizeof(header));
+    std::memcpy(&trailer, base + fileSize - sizeof(trailer), sizeof(trailer));
+    if (std::memcmp(header.magic, LABEL_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+        std::memcmp(trailer.magic, LABEL_INDEX_TRAILER_MAGIC, sizeof(trailer.magic)) != 0) {
+        std::fprintf(stderr, "%s is not a complete IDS label index\n", path);
+        ::munmap(mapping, fileSize);
+        return 1;
+    }
+    if (header.version != LABEL_INDEX_VERSION || header.recordSize != sizeof(LabelIndexRecord) ||
+        trailer.fileTableOffset < sizeof(header) || trailer.fileTableOffset > fileSize - sizeof(trailer) ||
+        (trailer.fileTableOffset - sizeof(header)) % sizeof(LabelIndexRecord) != 0) {
+        std::fprintf(stderr, "Unsupported or corrupt label index (version %u)\n", header.version);
+        ::munmap(mapping, fileSize);
+        return 1;
+    }
+    std::vector<std::string> files;
+    const char* name = base + trailer.fileTableOffset;
+    const char* tableEnd = base + fileSize - sizeof(trailer);
+    while (name < tableEnd && files.size() < trailer.fileCount) {
+        const char* end = static_cast<const char*>(std::memchr(name, '\0', tableEnd - name));
+        if (end == nullptr) {
+            break;
+        }
+        files.emplace_back(name, end);
+        name = end + 1;
+    }
+    if (files.size() != trailer.fileCount) {
+        std::fprintf(stderr, "Corrupt file table in %s\n", path);
+        ::munmap(mapping, fileSize);
+        return 1;
+    }
+
+    // The records are aligned (16-byte header) and sorted by time, so they are searched in place
+    const LabelIndexRecord* begin = reinterpret_cast<const LabelIndexRecord*>(base + sizeof(header));
+    const LabelIndexRecord* end = begin + (trailer.fileTableOffset - sizeof(header)) / sizeof(LabelIndexRecord);
+    auto earlier = [](const LabelIndexRecord& r, int64_t ns) { return r.timeNs < ns; };
+    auto later = [](int64_t ns, const LabelIndexRecord& r) { return ns < r.timeNs; };
+
+    if (!ranged && !byFlow && !attacksOnly) {
+        uint64_t counts[ATTACK_LABEL_COUNT] = {};
+        uint64_t unknown = 0;
+        for (const LabelIndexRecord* r = begin; r != end; ++r) {
+            if (r->label < ATTACK_LABEL_COUNT) {
+                ++counts[r->label];
+            } else {
+                ++unknown;
+            }
+        }
+        std::printf("Records: %llu\n", static_cast<unsigned long long>(end - begin));
+        if (begin != end) {
+            std::printf("Time: %.6f s - %.6f s\n", begin->timeNs / 1e9, (end - 1)->timeNs / 1e9);
+        }
+        std::printf("Capture files: %zu\n", files.size());
+        for (size_t f = 0; f < files.size(); ++f) {
+            std::printf("  %zu: %s\n", f, files[f].c_str());
+        }
+        std::printf("Labels:\n");
+        for (uint32_t label = 0; label < ATTACK_LABEL_COUNT; ++label) {
+            if (counts[label] > 0) {
+                std::printf("  %-24s %llu\n", AttackLabelName(label), static_cast<unsigned long long>(counts[label]));
+            }
+        }
+        if (unknown > 0) {
+            std::printf("  %-24s %llu\n", "unknown", static_cast<unsigned long long>(unknown));
+        }
+        ::munmap(mapping, fileSize);
+        return 0;
+    }
+
+    const LabelIndexRecord* first = std::lower_bound(begin, end, fromNs, earlier);
+    const LabelIndexRecord* last = std::upper_bound(first, end, toNs, later);
+    std::printf("time_s,flow_hash,label,instance,file,offset\n");
+    for (const LabelIndexRecord* r = first; r != last; ++r) {
+        if ((byFlow && r->flowHash != flowHash) || (attacksOnly && r->label == ATTACK_BENIGN)) {
+            continue;
+        }
+        std::printf("%.9f,%016llx,%s,%u,%s,%llu\n", r->timeNs / 1e9, static_cast<unsigned long long>(r->flowHash),
+                    AttackLabelName(r->label), r->instance, r->file < files.size() ? files[r->file].c_str() : "?",
+                    static_cast<unsigned long long>(r->offset));
+    }
+    ::munmap(mapping, fileSize);
+    return 0;
+}
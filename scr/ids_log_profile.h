@@ -0,0 +1,275 @@
+// Log Profiles for the IDS Dataset Simulation
+//
+// main() used to enable INFO logging for the application and transport components
+// unconditionally, which produces gigabytes of stdout during the SYN/UDP/DDoS floods. Logging is
+// now selected with a named profile at startup:
+// - none:    no component logging at all (production dataset runs pay nothing for logging).
+// - summary: only the scenario's own progress messages (NetworkSimulation component).
+// - debug:   the original application and transport components at INFO level, routed through a
+//            sampling stream buffer that applies per-component 1-in-N sampling and rate limits.
+//
+// Sampling works on complete log lines: in the debug profile every component is enabled with
+// LOG_PREFIX_FUNC so each line carries a "<Component>:<Function>(): " prefix that identifies it. The
+// message is still formatted by ns-3 before it is dropped, so sampling saves the output I/O but
+// not the formatting; use the summary or none profile when logging cost must be zero.
+
+#ifndef IDS_LOG_PROFILE_H
+#define IDS_LOG_PROFILE_H
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/// Named logging profiles selectable with --log-profile.
+enum LogProfile {
+    LOG_PROFILE_NONE,     // No component logging
+    LOG_PROFILE_SUMMARY,  // Scenario progress messages only
+    LOG_PROFILE_DEBUG     // Application and transport components, sampled and rate limited
+};
+
+/**
+ * Parses a profile name given on the command line.
+ *
+ * @param name Profile name: none, summary or debug.
+ * @param profile Receives the parsed profile.
+ * @return false if the name is unknown.
+ */
+inline bool ParseLogProfile(const std::string& name, LogProfile& profile) {
+    if (name == "none") {
+        profile = LOG_PROFILE_NONE;
+    } else if (name == "summary") {
+        profile = LOG_PROFILE_SUMMARY;
+    } else if (name == "debug") {
+        profile = LOG_PROFILE_DEBUG;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Stream buffer placed in front of std::clog that forwards whole log lines subject to
+ * per-component 1-in-N sampling and a per-component limit of lines per simulated second.
+ *
+ * Limits are configured with comma-separated "Component=value" lists; the component "*" sets the
+ * default for components that are not listed. A value of 0 (or 1 for sampling) disables the limit.
+ */
+class SampledLogBuffer : public std::streambuf {
+public:
+    /**
+     * @param target The stream buffer that receives the lines that pass (std::clog's original buffer).
+     */
+    explicit SampledLogBuffer(std::streambuf* target) : m_target(target), m_last(nullptr) {}
+
+    /**
+     * Configures 1-in-N sampling, e.g. "PacketSink=100,TcpL4Protocol=1000,*=10".
+     * @return false if the specification cannot be parsed.
+     */
+    bool SetSampling(const std::string& spec) { return ParseSpec(spec, true); }
+
+    /**
+     * Configures the maximum lines per simulated second, e.g. "UdpL4Protocol=50,*=200".
+     * @return false if the specification cannot be parsed.
+     */
+    bool SetRateLimit(const std::string& spec) { return ParseSpec(spec, false); }
+
+    /**
+     * Writes how many lines each component produced and how many were kept.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        for (const ComponentState& state : m_components) {
+            if (state.seen == 0) {
+                continue;
+            }
+            os << "Log sampling: " << (state.name.empty() ? "(unprefixed)" : state.name) << " kept " << state.kept << " of " << state.seen << " lines"
+               << std::endl;
+        }
+    }
+
+protected:
+    int overflow(int c) override {
+        if (c == traits_type::eof()) {
+            return traits_type::not_eof(c);
+        }
+        m_line.push_back(static_cast<char>(c));
+        if (c == '\n') {
+            EmitLine();
+        }
+        return c;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        for (std::streamsize i = 0; i < n; ++i) {
+            m_line.push_back(s[i]);
+            if (s[i] == '\n') {
+                EmitLine();
+            }
+        }
+        return n;
+    }
+
+    int sync() override { return m_target->pubsync(); }
+
+private:
+    /// Sampling and rate limiting state of one component.
+    struct ComponentState {
+        std::string name;
+        int64_t sampleEvery = -1;   // Keep one line in N, -1 = use the "*" default
+        int64_t maxPerSecond = -1;  // Lines per simulated second (0 = unlimited), -1 = use the "*" default
+        uint64_t seen = 0;          // Lines produced
+        uint64_t kept = 0;          // Lines forwarded
+        int64_t window = -1;        // Simulated second of the current rate window
+        uint64_t windowCount = 0;   // Lines forwarded in the current window
+    };
+
+    /// Decides whether the buffered line passes and forwards it to the target buffer.
+    void EmitLine() {
+        ComponentState& state = Lookup(ComponentOf(m_line));
+        if (state.sampleEvery < 0 || state.maxPerSecond < 0) {
+            ResolveDefaults(state);
+        }
+        ++state.seen;
+        bool keep = (state.seen - 1) % state.sampleEvery == 0;
+        if (keep && state.maxPerSecond > 0) {
+            int64_t window = static_cast<int64_t>(std::floor(Simulator::Now().GetSeconds()));
+            if (window != state.window) {
+                state.window = window;
+                state.windowCount = 0;
+            }
+            keep = state.windowCount < static_cast<uint64_t>(state.maxPerSecond);
+            if (keep) {
+                ++state.windowCount;
+            }
+        }
+        if (keep) {
+            ++state.kept;
+            m_target->sputn(m_line.data(), m_line.size());
+        }
+        m_line.clear();
+    }
+
+    /// Component name from the "<Component>:<Function>(): " prefix of a line, or empty.
+    static std::string ComponentOf(const std::string& line) {
+        size_t func = line.find("(): ");
+        if (func == std::string::npos) {
+            return std::string();  // Unprefixed output such as NS_LOG_UNCOND
+        }
+        size_t start = line.rfind(' ', func);  // Skip the optional time and node prefixes
+        start = (start == std::string::npos) ? 0 : start + 1;
+        size_t colon = line.find(':', start);
+        if (colon == std::string::npos || colon > func) {
+            return std::string();
+        }
+        return line.substr(start, colon - start);
+    }
+
+    /// Finds or creates the state of a component; consecutive lines usually share a component.
+    ComponentState& Lookup(const std::string& name) {
+        if (m_last != nullptr && m_last->name == name) {
+            return *m_last;
+        }
+        for (ComponentState& state : m_components) {
+            if (state.name == name) {
+                m_last = &state;
+                return state;
+            }
+        }
+        ComponentState state;
+        state.name = name;
+        m_components.push_back(state);
+        m_last = nullptr;  // push_back may have moved the other entries
+        return m_components.back();
+    }
+
+    /// Fills the limits a component did not configure from the "*" entry (unprefixed lines pass).
+    void ResolveDefaults(ComponentState& state) const {
+        const ComponentState* defaults = state.name.empty() ? nullptr : Find("*");
+        if (state.sampleEvery < 0) {
+            state.sampleEvery = (defaults != nullptr && defaults->sampleEvery > 0) ? defaults->sampleEvery : 1;
+        }
+        if (state.maxPerSecond < 0) {
+            state.maxPerSecond = (defaults != nullptr && defaults->maxPerSecond > 0) ? defaults->maxPerSecond : 0;
+        }
+    }
+
+    const ComponentState* Find(const std::string& name) const {
+        for (const ComponentState& state : m_components) {
+            if (state.name == name) {
+                return &state;
+            }
+        }
+        return nullptr;
+    }
+
+    bool ParseSpec(const std::string& spec, bool sampling) {
+        std::istringstream entries(spec);
+        std::string entry;
+        while (std::getline(entries, entry, ',')) {
+            if (entry.empty()) {
+                continue;
+            }
+            size_t eq = entry.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                return false;
+            }
+            char* end = nullptr;
+            unsigned long long value = std::strtoull(entry.c_str() + eq + 1, &end, 10);
+            if (end == entry.c_str() + eq + 1 || *end != '\0') {
+                return false;
+            }
+            ComponentState& state = Lookup(entry.substr(0, eq));
+            if (sampling) {
+                state.sampleEvery = value > 0 ? static_cast<int64_t>(value) : 1;
+            } else {
+                state.maxPerSecond = static_cast<int64_t>(value);
+            }
+        }
+        return true;
+    }
+
+    std::streambuf* m_target;                  // Original std::clog buffer
+    std::string m_line;                        // Line being assembled
+    std::vector<ComponentState> m_components;  // Known components ("*" holds the defaults)
+    ComponentState* m_last;                    // Component of the previous line
+};
+
+/**
+ * Enables the ns-3 log components of a profile.
+ *
+ * @param profile The selected logging profile.
+ */
+inline void ApplyLogProfile(LogProfile profile) {
+    if (profile == LOG_PROFILE_NONE) {
+        return;
+    }
+    if (profile == LOG_PROFILE_SUMMARY) {
+        LogComponentEnable("NetworkSimulation", LOG_LEVEL_INFO);  // Scenario setup milestones
+        return;
+    }
+
+    // The function prefix puts the component name on every line, which the sampler relies on.
+    LogLevel level = static_cast<LogLevel>(LOG_LEVEL_INFO | LOG_PREFIX_FUNC | LOG_PREFIX_TIME | LOG_PREFIX_NODE);
+    LogComponentEnable("NetworkSimulation", level);
+    LogComponentEnable("BulkSendApplication", level);       // Bulk data over TCP
+    LogComponentEnable("PacketSink", level);                // Receiver for bulk data and other traffic
+    LogComponentEnable("UdpEchoClientApplication", level);  // UDP echo client (DNS, echo, ICMP flood)
+    LogComponentEnable("UdpEchoServerApplication", level);  // UDP echo server
+    LogComponentEnable("TcpL4Protocol", level);             // TCP layer 4 operations
+    LogComponentEnable("UdpL4Protocol", level);             // UDP layer 4 operations
+}
+
+} // namespace ns3
+
+#endif // IDS_LOG_PROFILE_H
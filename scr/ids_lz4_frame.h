@@ -0,0 +1,192 @@
+// LZ4 Frame Compression for the IDS Dataset Simulation
+//
+// Self-contained LZ4 frame encoder used by the AsyncOutputWriter to compress output files on its
+// writer thread, without linking an external compression library into the ns-3 build. Output
+// files are standard LZ4 frames and can be read with the stock tools, e.g.
+//   lz4 -d network-visualization.xml.lz4
+//   lz4 -dc vpn-server-traffic-1-1.pcap.lz4 | tcpdump -r -
+//
+// The compressor is the greedy single-probe LZ4 algorithm (hash table of 4-byte sequences, no lazy
+// matching): it trades some ratio for speed, which suits repetitive XML well. Blocks are at most
+// 64 KiB and independent; blocks that do not shrink are stored uncompressed.
+
+#ifndef IDS_LZ4_FRAME_H
+#define IDS_LZ4_FRAME_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ns3 {
+
+constexpr uint32_t LZ4_FRAME_MAGIC = 0x184D2204;
+constexpr size_t LZ4_BLOCK_SIZE = 64 * 1024;  // Block maximum size id 4 in the frame descriptor
+
+/// XXH32 of a buffer (used for the LZ4 frame header checksum).
+inline uint32_t Xxh32(const void* data, size_t size, uint32_t seed) {
+    const uint32_t p1 = 2654435761U, p2 = 2246822519U, p3 = 3266489917U, p4 = 668265263U, p5 = 374761393U;
+    auto rotl = [](uint32_t x, int r) { return (x << r) | (x >> (32 - r)); };
+    auto read32 = [](const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    };
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint32_t h;
+    if (size >= 16) {
+        uint32_t v1 = seed + p1 + p2, v2 = seed + p2, v3 = seed, v4 = seed - p1;
+        for (; p + 16 <= end; p += 16) {
+            v1 = rotl(v1 + read32(p) * p2, 13) * p1;
+            v2 = rotl(v2 + read32(p + 4) * p2, 13) * p1;
+            v3 = rotl(v3 + read32(p + 8) * p2, 13) * p1;
+            v4 = rotl(v4 + read32(p + 12) * p2, 13) * p1;
+        }
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    } else {
+        h = seed + p5;
+    }
+    h += static_cast<uint32_t>(size);
+    for (; p + 4 <= end; p += 4) {
+        h = rotl(h + read32(p) * p3, 17) * p4;
+    }
+    for (; p < end; ++p) {
+        h = rotl(h + *p * p5, 11) * p1;
+    }
+    h ^= h >> 15;
+    h *= p2;
+    h ^= h >> 13;
+    h *= p3;
+    h ^= h >> 16;
+    return h;
+}
+
+/// Worst-case compressed size of an LZ4 block.
+inline size_t Lz4CompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+/**
+ * Compresses one independent LZ4 block.
+ *
+ * @param src Input bytes (at most LZ4_BLOCK_SIZE so every offset fits in 16 bits).
+ * @param size Number of input bytes.
+ * @param dst Output buffer of at least Lz4CompressBound(size) bytes.
+ * @return The compressed size.
+ */
+inline size_t Lz4CompressBlock(const uint8_t* src, size_t size, uint8_t* dst) {
+    const int hashBits = 12;
+    uint32_t table[1 << hashBits] = {};  // Position + 1 of the last occurrence, 0 = empty
+    auto read32 = [](const uint8_t* p) {
+        uint32_t v;
+        std::memcpy(&v, p, 4);
+        return v;
+    };
+    auto writeLength = [](uint8_t*& op, size_t length) {
+        for (; length >= 255; length -= 255) {
+            *op++ = 255;
+        }
+        *op++ = static_cast<uint8_t>(length);
+    };
+
+    uint8_t* op = dst;
+    size_t anchor = 0;
+    // Format limits: the last match starts at least 12 bytes before the end and the last 5 bytes
+    // are always literals.
+    if (size > 12) {
+        const size_t matchStartLimit = size - 12;
+        const size_t matchEndLimit = size - 5;
+        size_t i = 0;
+        while (i < matchStartLimit) {
+            uint32_t sequence = read32(src + i);
+            uint32_t h = (sequence * 2654435761U) >> (32 - hashBits);
+            uint32_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(i + 1);
+            if (candidate == 0 || read32(src + candidate - 1) != sequence) {
+                ++i;
+                continue;
+            }
+            size_t ref = candidate - 1;
+            size_t matchLength = 4;
+            while (i + matchLength < matchEndLimit && src[ref + matchLength] == src[i + matchLength]) {
+                ++matchLength;
+            }
+
+            size_t literals = i - anchor;
+            size_t extra = matchLength - 4;
+            *op++ = static_cast<uint8_t>(((literals < 15 ? literals : 15) << 4) | (extra < 15 ? extra : 15));
+            if (literals >= 15) {
+                writeLength(op, literals - 15);
+            }
+            std::memcpy(op, src + anchor, literals);
+            op += literals;
+            uint16_t offset = static_cast<uint16_t>(i - ref);
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+            if (extra >= 15) {
+                writeLength(op, extra - 15);
+            }
+            i += matchLength;
+            anchor = i;
+        }
+    }
+
+    size_t literals = size - anchor;
+    *op++ = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4);
+    if (literals >= 15) {
+        writeLength(op, literals - 15);
+    }
+    std::memcpy(op, src + anchor, literals);
+    op += literals;
+    return op - dst;
+}
+
+/**
+ * Writes the 7-byte LZ4 frame header: magic, FLG (version 01, independent blocks, no checksums),
+ * BD (64 KiB blocks) and the header checksum.
+ *
+ * @param out Receives the header.
+ */
+inline void Lz4FrameHeader(uint8_t out[7]) {
+    std::memcpy(out, &LZ4_FRAME_MAGIC, 4);
+    out[4] = 0x60;
+    out[5] = 0x40;
+    out[6] = static_cast<uint8_t>(Xxh32(out + 4, 2, 0) >> 8);
+}
+
+/**
+ * Compresses data into consecutive LZ4 frame blocks (size field + block, at most LZ4_BLOCK_SIZE
+ * input bytes each) and appends them to a buffer. Blocks that do not shrink are stored
+ * uncompressed. Every block is independent, so a reader can locate blocks by their size fields
+ * and decompress them in parallel.
+ *
+ * @param data Input bytes.
+ * @param size Number of input bytes.
+ * @param out Buffer receiving the blocks.
+ */
+inline void Lz4AppendBlocks(const void* data, size_t size, std::vector<char>& out) {
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        size_t chunk = std::min(size, LZ4_BLOCK_SIZE);
+        size_t start = out.size();
+        out.resize(start + 4 + Lz4CompressBound(chunk));
+        uint8_t* block = reinterpret_cast<uint8_t*>(&out[start + 4]);
+        uint32_t compressed = static_cast<uint32_t>(Lz4CompressBlock(src, chunk, block));
+        uint32_t field = compressed;
+        if (compressed >= chunk) {
+            // Incompressible: store the block as is (high bit of the size field set)
+            compressed = static_cast<uint32_t>(chunk);
+            std::memcpy(block, src, chunk);
+            field = compressed | 0x80000000U;
+        }
+        std::memcpy(&out[start], &field, 4);
+        out.resize(start + 4 + compressed);
+        src += chunk;
+        size -= chunk;
+    }
+}
+
+} // namespace ns3
+
+#endif // IDS_LZ4_FRAME_H
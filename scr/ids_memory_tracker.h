@@ -0,0 +1,275 @@
+// Memory Footprint Tracker for the IDS Dataset Simulation
+//
+// Memory use grows over the run (FlowMonitor state, NetAnim buffers, the applications installed in
+// loops) and there was no breakdown of where. This tracker samples the resident set size together
+// with live object counts at named setup checkpoints, at the start and end of every attack window
+// and on a simulated-time timer, and reports the peak and the phase that grew memory the most.
+//
+// Counts per sample:
+// - rss_kb / hwm_kb: VmRSS and VmHWM (peak RSS) from /proc/self/status.
+// - packets: Packet UIDs handed out so far (SetCountPackets, off by default: empty otherwise). ns-3
+//   keeps no count of live packets and has no accessor for the UID counter, so this is read by
+//   allocating one probe packet per sample, which shifts the UIDs of all later packets: traces
+//   and NetAnim pktUid values then differ from a run without the tracker.
+// - sockets: TCP and UDP sockets open on all nodes (the L4 protocols' SocketList attribute).
+// - applications: applications installed on all nodes.
+// - flows: flows classified by the FlowMonitor, if one is attached.
+//
+// Sample format:
+//   time_s,phase,rss_kb,hwm_kb,packets,sockets,applications,flows
+// The phase is the checkpoint name during setup and teardown. While the simulation runs it is the
+// attack phase (see ids_attack_schedule.h) of the interval that ends at the sample: samples are
+// taken at every window boundary, so each interval lies in one phase, and the RSS growth over the
+// interval (and a peak reached at its end) is charged to that phase, not to the phase that begins
+// at a boundary sample.
+
+#ifndef IDS_MEMORY_TRACKER_H
+#define IDS_MEMORY_TRACKER_H
+
+#include "ns3/flow-monitor.h"
+#include "ns3/node-list.h"
+#include "ns3/object-vector.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/udp-l4-protocol.h"
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * Reads VmRSS and VmHWM of the current process in KiB.
+ *
+ * @param rssKb Receives the resident set size.
+ * @param hwmKb Receives the peak resident set size.
+ * @return false if /proc/self/status cannot be read.
+ */
+inline bool ReadProcessMemory(uint64_t& rssKb, uint64_t& hwmKb) {
+    std::FILE* status = std::fopen("/proc/self/status", "r");
+    if (status == nullptr) {
+        return false;
+    }
+    rssKb = 0;
+    hwmKb = 0;
+    char line[256];
+    while (std::fgets(line, sizeof(line), status) != nullptr) {
+        unsigned long long value;
+        if (std::sscanf(line, "VmRSS: %llu", &value) == 1) {
+            rssKb = value;
+        } else if (std::sscanf(line, "VmHWM: %llu", &value) == 1) {
+            hwmKb = value;
+        }
+    }
+    std::fclose(status);
+    return true;
+}
+
+/**
+ * Samples process memory and ns-3 object counts and attributes memory growth to phases.
+ */
+class MemoryTracker {
+public:
+    MemoryTracker() : m_file(nullptr), m_schedule(nullptr), m_countPackets(false), m_lastRss(0), m_peakRss(0),
+                      m_hwmKb(0), m_peakTime(0.0), m_lastRunTime(0.0) {}
+
+    ~MemoryTracker() { Close(); }
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    /**
+     * Starts writing samples and writes the CSV header.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @return true if the file is valid.
+     */
+    bool Open(AsyncOutputFile* file) {
+        Close();
+        m_file = file;
+        if (m_file == nullptr) {
+            return false;
+        }
+        static const char header[] = "time_s,phase,rss_kb,hwm_kb,packets,sockets,applications,flows\n";
+        m_file->Write(header, sizeof(header) - 1);
+        return true;
+    }
+
+    /**
+     * Samples the packet UID counter. Each sample allocates a probe packet, which shifts the UIDs
+     * of the packets created after it.
+     *
+     * @param count true to fill the packets column.
+     */
+    void SetCountPackets(bool count) { m_countPackets = count; }
+
+    /// Attaches the FlowMonitor whose flow count is sampled.
+    void SetFlowMonitor(Ptr<FlowMonitor> flowmon) { m_flowmon = flowmon; }
+
+    /**
+     * Takes a sample attributed to a named phase. Growth since the previous sample is charged to
+     * this phase.
+     *
+     * @param phase Checkpoint name, e.g. "topology" or "end-of-run".
+     */
+    void Checkpoint(const std::string& phase) {
+        if (m_file == nullptr) {
+            return;
+        }
+        uint64_t rssKb = 0;
+        uint64_t hwmKb = 0;
+        ReadProcessMemory(rssKb, hwmKb);
+        double now = Simulator::Now().GetSeconds();
+
+        char packets[24] = "";
+        if (m_countPackets) {
+            std::snprintf(packets, sizeof(packets), "%llu", static_cast<unsigned long long>(PacketsAllocated()));
+        }
+        char line[256];
+        int n = std::snprintf(line, sizeof(line), "%.3f,%s,%llu,%llu,%s,%u,%u,%zu\n", now, phase.c_str(),
+                              static_cast<unsigned long long>(rssKb), static_cast<unsigned long long>(hwmKb), packets,
+                              CountSockets(), CountApplications(),
+                              m_flowmon ? m_flowmon->GetFlowStats().size() : size_t(0));
+        m_file->Write(line, static_cast<size_t>(n));
+
+        if (rssKb > m_lastRss) {
+            m_growth[phase] += rssKb - m_lastRss;
+        }
+        m_lastRss = rssKb;
+        if (rssKb > m_peakRss) {
+            m_peakRss = rssKb;
+            m_peakPhase = phase;
+            m_peakTime = now;
+        }
+        m_hwmKb = hwmKb;
+    }
+
+    /**
+     * Schedules samples every interval and at the start and end of every attack window.
+     *
+     * @param interval Simulated time between timer samples.
+     * @param schedule Attack schedule giving the phase boundaries and names, or nullptr.
+     */
+    void StartTimer(Time interval, const AttackSchedule* schedule) {
+        m_schedule = schedule;
+        m_interval = interval;
+        double now = Simulator::Now().GetSeconds();
+        m_lastRunTime = now;
+        Simulator::Schedule(interval, &MemoryTracker::Tick, this);
+        if (schedule == nullptr) {
+            return;
+        }
+        for (const AttackWindow& w : schedule->GetWindows()) {
+            if (w.start >= now) {
+                Simulator::Schedule(Seconds(w.start - now), &MemoryTracker::SampleRun, this);
+            }
+            if (w.stop >= now) {
+                Simulator::Schedule(Seconds(w.stop - now), &MemoryTracker::SampleRun, this);
+            }
+        }
+    }
+
+    /// Closes the sample file.
+    void Close() {
+        if (m_file == nullptr) {
+            return;
+        }
+        m_file->Close();
+        m_file = nullptr;
+    }
+
+    /**
+     * Writes the peak RSS, the phase in which it was reached and the growth per phase.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        os << "Memory: peak RSS " << m_peakRss << " KiB in phase " << m_peakPhase << " at " << m_peakTime
+           << " s (process high-water mark " << m_hwmKb << " KiB)" << std::endl;
+        std::string topPhase;
+        uint64_t topGrowth = 0;
+        for (const auto& entry : m_growth) {
+            os << "  " << entry.first << ": +" << entry.second << " KiB" << std::endl;
+            if (entry.second > topGrowth) {
+                topGrowth = entry.second;
+                topPhase = entry.first;
+            }
+        }
+        if (topGrowth > 0) {
+            os << "  largest growth: " << topPhase << " (+" << topGrowth << " KiB)" << std::endl;
+        }
+    }
+
+private:
+    /// Timer sample; reschedules itself.
+    void Tick() {
+        SampleRun();
+        Simulator::Schedule(m_interval, &MemoryTracker::Tick, this);
+    }
+
+    /// Sample during the run, attributed to the phase of the interval since the previous run sample.
+    void SampleRun() {
+        double now = Simulator::Now().GetSeconds();
+        uint8_t phase = ATTACK_BENIGN;
+        if (m_schedule != nullptr) {
+            // The midpoint is inside the interval, away from the boundaries ActivePhase includes
+            phase = m_schedule->ActivePhase(now > m_lastRunTime ? (m_lastRunTime + now) / 2 : now);
+        }
+        m_lastRunTime = now;
+        Checkpoint(std::string("run:") + AttackLabelName(phase));
+    }
+
+    /// Packet UIDs handed out so far (allocates one probe packet, see SetCountPackets).
+    static uint64_t PacketsAllocated() { return Create<Packet>()->GetUid(); }
+
+    /// TCP and UDP sockets on all nodes.
+    static uint32_t CountSockets() {
+        uint32_t sockets = 0;
+        for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+            ObjectVectorValue list;
+            if (Ptr<TcpL4Protocol> tcp = (*it)->GetObject<TcpL4Protocol>()) {
+                tcp->GetAttribute("SocketList", list);
+                sockets += list.GetN();
+            }
+            if (Ptr<UdpL4Protocol> udp = (*it)->GetObject<UdpL4Protocol>()) {
+                udp->GetAttribute("SocketList", list);
+                sockets += list.GetN();
+            }
+        }
+        return sockets;
+    }
+
+    /// Applications installed on all nodes.
+    static uint32_t CountApplications() {
+        uint32_t applications = 0;
+        for (NodeList::Iterator it = NodeList::Begin(); it != NodeList::End(); ++it) {
+            applications += (*it)->GetNApplications();
+        }
+        return applications;
+    }
+
+    AsyncOutputFile* m_file;                 // Sample CSV
+    const AttackSchedule* m_schedule;        // Phase names during the run, may be null
+    bool m_countPackets;                     // Fill the packets column (allocates a probe packet)
+    Ptr<FlowMonitor> m_flowmon;              // Flow count source, may be null
+    Time m_interval;                         // Simulated time between timer samples
+    uint64_t m_lastRss;                      // RSS of the previous sample (KiB)
+    uint64_t m_peakRss;                      // Largest sampled RSS (KiB)
+    uint64_t m_hwmKb;                        // Last VmHWM read (KiB)
+    std::string m_peakPhase;                 // Phase of the largest sample
+    double m_peakTime;                       // Simulation time of the largest sample
+    double m_lastRunTime;                    // Time of the previous run sample (or of StartTimer)
+    std::map<std::string, uint64_t> m_growth;  // RSS growth charged to each phase (KiB)
+};
+
+} // namespace ns3
+
+#endif // IDS_MEMORY_TRACKER_H
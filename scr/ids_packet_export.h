@@ -0,0 +1,269 @@
+// Columnar Packet Record Exporter for the IDS Dataset Simulation
+//
+// Downstream training jobs used to parse the PCAP captures again to recover per-packet fields.
+// This exporter writes those fields directly from the simulation: every IPv4 packet sent or
+// received by a node becomes one row (time, node, interface, direction, 5-tuple, TCP flags, size,
+// label, attack instance), and the rows are stored column by column in fixed-size row groups, so a reader can mmap
+// the file and touch only the columns it needs.
+//
+// File layout (little-endian host order, every column chunk starts on an 8-byte boundary):
+// - ColumnarFileHeader (16 bytes): magic "IDSCOLS1", format version and column count.
+// - One ColumnarColumnInfo (16 bytes) per column: name, ColumnType and value width.
+// - Row groups: for each column in schema order, rowCount * width bytes of values, zero padded.
+// - Footer: per row group, rowCount, first/last time_ns and the file offset of every column chunk
+//   (3 + columnCount uint64 values).
+// - ColumnarFileTrailer (16 bytes): footer offset, row group count and the magic "IDSC".
+//
+// Use ids_columnar_reader.cc to inspect a file or dump selected columns as CSV. With numpy, a column
+// chunk is np.frombuffer(mm, dtype, count=rowCount, offset=chunkOffset).
+
+#ifndef IDS_PACKET_EXPORT_H
+#define IDS_PACKET_EXPORT_H
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+#include "ids_packet_tracer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ns3 {
+
+/// Value type of a column.
+enum ColumnType : uint8_t {
+    COLUMN_INT64 = 1,
+    COLUMN_UINT32 = 2,
+    COLUMN_UINT16 = 3,
+    COLUMN_UINT8 = 4
+};
+
+/// Columns of the packet record file, in file order. Existing values must not change.
+enum PacketColumn : uint32_t {
+    PACKET_COL_TIME_NS = 0,   // Simulation time in nanoseconds (int64)
+    PACKET_COL_NODE,          // ns-3 node ID (uint32)
+    PACKET_COL_INTERFACE,     // IPv4 interface index on the node (uint32)
+    PACKET_COL_DIRECTION,     // PacketTraceDirection (uint8)
+    PACKET_COL_SRC_IP,        // Source address, host byte order (uint32)
+    PACKET_COL_DST_IP,        // Destination address, host byte order (uint32)
+    PACKET_COL_SRC_PORT,      // TCP/UDP source port, 0 otherwise (uint16)
+    PACKET_COL_DST_PORT,      // TCP/UDP destination port, 0 otherwise (uint16)
+    PACKET_COL_PROTOCOL,      // IP protocol number (uint8)
+    PACKET_COL_TCP_FLAGS,     // TCP flags byte (FIN=0x01 ... CWR=0x80), 0 for other protocols (uint8)
+    PACKET_COL_SIZE,          // IPv4 datagram size in bytes (uint32)
+    PACKET_COL_LABEL,         // AttackLabel (uint8)
+    PACKET_COL_INSTANCE,      // Attack instance, row of the window in attack-schedule.csv, 0 = benign (uint32)
+    PACKET_COLUMN_COUNT
+};
+
+/// Schema entry stored after the file header.
+struct ColumnarColumnInfo {
+    char name[14];        // Zero-terminated column name
+    uint8_t type;         // ColumnType
+    uint8_t width;        // Bytes per value
+};
+static_assert(sizeof(ColumnarColumnInfo) == 16, "ColumnarColumnInfo must stay 16 bytes");
+
+/// Header at the start of every columnar file.
+struct ColumnarFileHeader {
+    char magic[8];         // "IDSCOLS1"
+    uint32_t version;      // COLUMNAR_VERSION
+    uint32_t columnCount;  // Number of ColumnarColumnInfo entries that follow
+};
+static_assert(sizeof(ColumnarFileHeader) == 16, "ColumnarFileHeader must stay 16 bytes");
+
+/// Trailer at the end of every complete columnar file.
+struct ColumnarFileTrailer {
+    uint64_t footerOffset;   // File offset of the row group table
+    uint32_t rowGroupCount;  // Entries in the row group table
+    char magic[4];           // "IDSC"
+};
+static_assert(sizeof(ColumnarFileTrailer) == 16, "ColumnarFileTrailer must stay 16 bytes");
+
+constexpr char COLUMNAR_MAGIC[8] = {'I', 'D', 'S', 'C', 'O', 'L', 'S', '1'};
+constexpr char COLUMNAR_TRAILER_MAGIC[4] = {'I', 'D', 'S', 'C'};
+constexpr uint32_t COLUMNAR_VERSION = 1;
+
+/// Schema of the packet record file, indexed by PacketColumn.
+inline const ColumnarColumnInfo* PacketColumnSchema() {
+    static const ColumnarColumnInfo schema[PACKET_COLUMN_COUNT] = {
+        {"time_ns", COLUMN_INT64, 8},   {"node", COLUMN_UINT32, 4},     {"interface", COLUMN_UINT32, 4},
+        {"direction", COLUMN_UINT8, 1}, {"src_ip", COLUMN_UINT32, 4},   {"dst_ip", COLUMN_UINT32, 4},
+        {"src_port", COLUMN_UINT16, 2}, {"dst_port", COLUMN_UINT16, 2}, {"protocol", COLUMN_UINT8, 1},
+        {"tcp_flags", COLUMN_UINT8, 1}, {"size", COLUMN_UINT32, 4},     {"label", COLUMN_UINT8, 1},
+        {"instance", COLUMN_UINT32, 4}};
+    return schema;
+}
+
+/**
+ * Buffers packet records column by column and writes one row group each time the buffers fill.
+ *
+ * The column buffers are allocated once in Open; recording a packet parses the IPv4 and transport
+ * headers from raw bytes and stores one value per column, and a full row group is handed to the
+ * output writer with one Write per column.
+ */
+class ColumnarPacketExporter {
+public:
+    ColumnarPacketExporter() : m_file(nullptr), m_schedule(nullptr), m_rowGroupRows(0), m_rows(0), m_rowCount(0),
+                               m_offset(0) {}
+
+    ~ColumnarPacketExporter() { Close(); }
+
+    ColumnarPacketExporter(const ColumnarPacketExporter&) = delete;
+    ColumnarPacketExporter& operator=(const ColumnarPacketExporter&) = delete;
+
+    /**
+     * Starts exporting into a file, writes the header and schema and allocates the column buffers.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @param rowGroupRows Rows per row group.
+     * @param schedule Attack schedule used to label rows, or nullptr to take the label and instance
+     *                 passed to RecordIpv4 (the packet's AttackTag).
+     * @return true if the file is valid.
+     */
+    bool Open(AsyncOutputFile* file, uint32_t rowGroupRows, const AttackSchedule* schedule) {
+        Close();
+        m_file = file;
+        if (m_file == nullptr) {
+            return false;
+        }
+        m_schedule = schedule;
+        m_rowGroupRows = rowGroupRows > 0 ? rowGroupRows : 1;
+        const ColumnarColumnInfo* schema = PacketColumnSchema();
+        for (uint32_t c = 0; c < PACKET_COLUMN_COUNT; ++c) {
+            m_columns[c].assign(static_cast<size_t>(m_rowGroupRows) * schema[c].width, 0);
+        }
+        m_rows = 0;
+        m_rowCount = 0;
+        m_rowGroups.clear();
+
+        ColumnarFileHeader header;
+        std::memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+        header.version = COLUMNAR_VERSION;
+        header.columnCount = PACKET_COLUMN_COUNT;
+        m_file->Write(&header, sizeof(header));
+        m_file->Write(schema, sizeof(ColumnarColumnInfo) * PACKET_COLUMN_COUNT);
+        m_offset = sizeof(header) + sizeof(ColumnarColumnInfo) * PACKET_COLUMN_COUNT;
+        return true;
+    }
+
+    /// Returns true while a file is open.
+    bool IsOpen() const { return m_file != nullptr; }
+
+    /**
+     * Parses an IPv4 packet and appends one row, writing a row group first if the buffers are full.
+     * Non-first fragments have no transport header, so their ports and flags are 0.
+     *
+     * @param timeNs Simulation time in nanoseconds.
+     * @param nodeId ID of the node sending or receiving the packet.
+     * @param interface IPv4 interface index on the node.
+     * @param direction PACKET_TRACE_TX or PACKET_TRACE_RX.
+     * @param bytes Leading bytes of the packet, starting with the IPv4 header.
+     * @param length Number of valid bytes in bytes.
+     * @param size Packet size in bytes.
+     * @param instance Attack instance of the packet, used when the exporter has no schedule.
+     * @param label AttackLabel of the packet, used when the exporter has no schedule.
+     */
+    void RecordIpv4(int64_t timeNs, uint32_t nodeId, uint32_t interface, uint8_t direction, const uint8_t* bytes,
+                    size_t length, uint32_t size, uint32_t instance = 0, uint8_t label = ATTACK_BENIGN) {
+        PacketTuple t;
+        if (!ParseIpv4Tuple(bytes, length, t)) {
+            return;
+        }
+        if (m_schedule != nullptr) {
+            instance = m_schedule->Match(timeNs / 1e9, t.src, t.dst, t.protocol, t.srcPort, t.dstPort);
+            label = m_schedule->InstanceLabel(instance);
+        }
+
+        if (m_rows == m_rowGroupRows) {
+            WriteRowGroup();
+        }
+        Store(PACKET_COL_TIME_NS, timeNs);
+        Store(PACKET_COL_NODE, nodeId);
+        Store(PACKET_COL_INTERFACE, interface);
+        Store(PACKET_COL_DIRECTION, direction);
+        Store(PACKET_COL_SRC_IP, t.src);
+        Store(PACKET_COL_DST_IP, t.dst);
+        Store(PACKET_COL_SRC_PORT, t.srcPort);
+        Store(PACKET_COL_DST_PORT, t.dstPort);
+        Store(PACKET_COL_PROTOCOL, t.protocol);
+        Store(PACKET_COL_TCP_FLAGS, t.tcpFlags);
+        Store(PACKET_COL_SIZE, size);
+        Store(PACKET_COL_LABEL, label);
+        Store(PACKET_COL_INSTANCE, instance);
+        ++m_rows;
+        ++m_rowCount;
+    }
+
+    /// Writes the last row group, the footer and the trailer, and closes the file.
+    void Close() {
+        if (m_file == nullptr) {
+            return;
+        }
+        WriteRowGroup();
+        ColumnarFileTrailer trailer;
+        trailer.footerOffset = m_offset;
+        trailer.rowGroupCount = static_cast<uint32_t>(GetRowGroupCount());
+        std::memcpy(trailer.magic, COLUMNAR_TRAILER_MAGIC, sizeof(trailer.magic));
+        if (!m_rowGroups.empty()) {
+            m_file->Write(m_rowGroups.data(), m_rowGroups.size() * sizeof(uint64_t));
+        }
+        m_file->Write(&trailer, sizeof(trailer));
+        m_file->Close();
+        m_file = nullptr;
+    }
+
+    /// Total number of rows exported since Open.
+    uint64_t GetRowCount() const { return m_rowCount; }
+
+    /// Number of row groups written since Open.
+    uint64_t GetRowGroupCount() const { return m_rowGroups.size() / (3 + PACKET_COLUMN_COUNT); }
+
+private:
+    /// Stores a value in the current row of a column; T must match the column width.
+    template <typename T>
+    void Store(uint32_t column, T value) {
+        std::memcpy(&m_columns[column][m_rows * sizeof(T)], &value, sizeof(T));
+    }
+
+    /// Writes the buffered rows as one row group and records its footer entry.
+    void WriteRowGroup() {
+        if (m_rows == 0 || m_file == nullptr) {
+            return;
+        }
+        int64_t firstNs;
+        int64_t lastNs;
+        std::memcpy(&firstNs, &m_columns[PACKET_COL_TIME_NS][0], sizeof(firstNs));
+        std::memcpy(&lastNs, &m_columns[PACKET_COL_TIME_NS][(m_rows - 1) * sizeof(int64_t)], sizeof(lastNs));
+        m_rowGroups.push_back(m_rows);
+        m_rowGroups.push_back(static_cast<uint64_t>(firstNs));
+        m_rowGroups.push_back(static_cast<uint64_t>(lastNs));
+
+        static const char padding[8] = {0};
+        const ColumnarColumnInfo* schema = PacketColumnSchema();
+        for (uint32_t c = 0; c < PACKET_COLUMN_COUNT; ++c) {
+            size_t bytes = static_cast<size_t>(m_rows) * schema[c].width;
+            size_t padded = (bytes + 7) & ~static_cast<size_t>(7);
+            m_rowGroups.push_back(m_offset);
+            m_file->Write(m_columns[c].data(), bytes);
+            if (padded > bytes) {
+                m_file->Write(padding, padded - bytes);
+            }
+            m_offset += padded;
+        }
+        m_rows = 0;
+    }
+
+    AsyncOutputFile* m_file;                        // Output file
+    const AttackSchedule* m_schedule;               // Labels rows, null to use the caller's labels
+    uint32_t m_rowGroupRows;                        // Rows per row group
+    uint32_t m_rows;                                // Rows buffered in the current row group
+    uint64_t m_rowCount;                            // Rows exported since Open
+    uint64_t m_offset;                              // File offset of the next byte written
+    std::vector<uint8_t> m_columns[PACKET_COLUMN_COUNT];  // Column buffers of the current row group
+    std::vector<uint64_t> m_rowGroups;              // Footer entries of the written row groups
+};
+
+} // namespace ns3
+
+#endif // IDS_PACKET_EXPORT_H
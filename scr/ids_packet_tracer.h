@@ -0,0 +1,176 @@
+// Binary Packet Event Tracer for the IDS Dataset Simulation
+//
+// The text callbacks in ids_dataset.cc format one line per packet through NS_LOG_UNCOND, which
+// becomes the dominant cost of a run during the flood attacks. This tracer stores fixed-size
+// binary records (time, node, device, size, direction, label) in a preallocated ring buffer and drains
+// the buffer in bulk to an AsyncOutputFile, so the per-packet cost is a single struct store and the
+// file I/O happens on the output writer thread (see ids_async_output.h).
+//
+// File layout:
+// - PacketTraceFileHeader (16 bytes): magic "IDSTRACE", format version and record size.
+// - A flat sequence of PacketTraceRecord entries (24 bytes each, little-endian host order).
+//
+// Use ids_trace_decoder.cc to turn a trace file back into CSV or a short summary.
+
+#ifndef IDS_PACKET_TRACER_H
+#define IDS_PACKET_TRACER_H
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ns3 {
+
+/// Direction of a traced packet event.
+enum PacketTraceDirection : uint8_t {
+    PACKET_TRACE_TX = 0,  // Packet left the device (PhyTxEnd)
+    PACKET_TRACE_RX = 1   // Packet was received by the device (PhyRxEnd)
+};
+
+/// One traced packet event. The layout is fixed so the file can be read back without parsing.
+struct PacketTraceRecord {
+    int64_t timeNs;        // Simulation time in nanoseconds
+    uint32_t nodeId;       // ns-3 node ID
+    uint32_t deviceIndex;  // Device index on the node (Node::GetDevice)
+    uint32_t size;         // Packet size in bytes as seen by the device
+    uint8_t direction;     // PacketTraceDirection
+    uint8_t label;         // AttackLabel from the packet's AttackTag (version 2; zero in version 1)
+    uint8_t reserved[2];   // Padding, always zero
+};
+static_assert(sizeof(PacketTraceRecord) == 24, "PacketTraceRecord must stay 24 bytes");
+
+/// Header at the start of every trace file.
+struct PacketTraceFileHeader {
+    char magic[8];         // "IDSTRACE"
+    uint32_t version;      // PACKET_TRACE_VERSION
+    uint32_t recordSize;   // sizeof(PacketTraceRecord)
+};
+static_assert(sizeof(PacketTraceFileHeader) == 16, "PacketTraceFileHeader must stay 16 bytes");
+
+constexpr char PACKET_TRACE_MAGIC[8] = {'I', 'D', 'S', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t PACKET_TRACE_VERSION = 2;
+
+/**
+ * Collects packet events into a preallocated ring buffer and writes them to disk in bulk.
+ *
+ * Records are appended at the head of the ring; once the ring is full (or on Flush/Close) all
+ * pending records are handed to the output file with at most two copies, so the simulator thread
+ * never formats text or issues a syscall per packet.
+ */
+class PacketTracer {
+public:
+    PacketTracer() : m_file(nullptr), m_head(0), m_pending(0), m_recordCount(0) {}
+
+    ~PacketTracer() { Close(); }
+
+    PacketTracer(const PacketTracer&) = delete;
+    PacketTracer& operator=(const PacketTracer&) = delete;
+
+    /**
+     * Starts tracing into a file and allocates the ring buffer.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @param capacity Number of records held in memory before a bulk drain.
+     * @return true if the file is valid.
+     */
+    bool Open(AsyncOutputFile* file, uint32_t capacity) {
+        Close();
+        m_file = file;
+        if (m_file == nullptr) {
+            return false;
+        }
+        m_ring.assign(capacity > 0 ? capacity : 1, PacketTraceRecord());
+        m_head = 0;
+        m_pending = 0;
+        m_recordCount = 0;
+
+        PacketTraceFileHeader header;
+        std::memcpy(header.magic, PACKET_TRACE_MAGIC, sizeof(header.magic));
+        header.version = PACKET_TRACE_VERSION;
+        header.recordSize = sizeof(PacketTraceRecord);
+        m_file->Write(&header, sizeof(header));
+        return true;
+    }
+
+    /// Returns true while a trace file is open.
+    bool IsOpen() const { return m_file != nullptr; }
+
+    /**
+     * Appends one packet event to the ring buffer, draining it first if it is full.
+     *
+     * @param timeNs Simulation time in nanoseconds.
+     * @param nodeId ID of the node owning the device.
+     * @param deviceIndex Index of the device on the node.
+     * @param size Packet size in bytes.
+     * @param direction PACKET_TRACE_TX or PACKET_TRACE_RX.
+     * @param label AttackLabel of the packet.
+     */
+    void Record(int64_t timeNs, uint32_t nodeId, uint32_t deviceIndex, uint32_t size, uint8_t direction,
+                uint8_t label = ATTACK_BENIGN) {
+        if (m_pending == m_ring.size()) {
+            Drain();
+        }
+        PacketTraceRecord& record = m_ring[m_head];
+        record.timeNs = timeNs;
+        record.nodeId = nodeId;
+        record.deviceIndex = deviceIndex;
+        record.size = size;
+        record.direction = direction;
+        record.label = label;
+        record.reserved[0] = record.reserved[1] = 0;
+        m_head = (m_head + 1 == m_ring.size()) ? 0 : m_head + 1;
+        ++m_pending;
+        ++m_recordCount;
+    }
+
+    /// Hands all pending records to the output writer.
+    void Flush() {
+        Drain();
+        if (m_file != nullptr) {
+            m_file->Flush();
+        }
+    }
+
+    /// Drains the ring buffer and closes the trace file.
+    void Close() {
+        if (m_file == nullptr) {
+            return;
+        }
+        Drain();
+        m_file->Close();
+        m_file = nullptr;
+    }
+
+    /// Total number of records traced since Open.
+    uint64_t GetRecordCount() const { return m_recordCount; }
+
+private:
+    /// Writes the pending records, oldest first, with at most two Write calls.
+    void Drain() {
+        if (m_pending == 0 || m_file == nullptr) {
+            m_pending = 0;
+            return;
+        }
+        size_t tail = (m_head + m_ring.size() - m_pending) % m_ring.size();
+        size_t firstChunk = std::min(m_pending, m_ring.size() - tail);
+        m_file->Write(&m_ring[tail], firstChunk * sizeof(PacketTraceRecord));
+        if (firstChunk < m_pending) {
+            m_file->Write(&m_ring[0], (m_pending - firstChunk) * sizeof(PacketTraceRecord));
+        }
+        m_pending = 0;
+    }
+
+    AsyncOutputFile* m_file;                  // Output trace file
+    std::vector<PacketTraceRecord> m_ring;    // Preallocated ring buffer
+    size_t m_head;                            // Next slot to write
+    size_t m_pending;                         // Records not yet written to disk
+    uint64_t m_recordCount;                   // Records traced since Open
+};
+
+} // namespace ns3
+
+#endif // IDS_PACKET_TRACER_H
@@ -0,0 +1,281 @@
+// Simulation Throughput Profiler for the IDS Dataset Simulation
+//
+// The scenario runs for 1500 simulated seconds and its cost is dominated by a few attack phases
+// (SYN flood, UDP flood, DDoS). This profiler samples the simulator every profile interval and
+// writes a timeline of executed events, wall-clock time and event queue depth, so a slow phase
+// shows up in the CSV without an external profiler. Each interval is tagged with the attack phase
+// active at its start (see ids_attack_schedule.h), and the end-of-run report sums the timeline per
+// phase.
+//
+// ns-3 does not expose the size of the event queue, so the profiler installs CountingMapScheduler,
+// a MapScheduler (the default scheduler) that keeps a running count of queued events. Cancelled
+// events stay in the queue until they are popped and are included in the depth. The same
+// scheduler can count executed events per node context for the application attribution report
+// (see ids_app_attribution.h).
+//
+// Timeline format (one row per interval):
+//   sim_start_s,sim_end_s,wall_s,events,events_per_wall_s,sim_to_wall,queue_depth,phase
+
+#ifndef IDS_SIM_PROFILER_H
+#define IDS_SIM_PROFILER_H
+
+#include "ns3/map-scheduler.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+
+#include "ids_async_output.h"
+#include "ids_attack_schedule.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * MapScheduler that counts the events it holds and, optionally, the events it hands out per
+ * context (node ID).
+ *
+ * The counts are static because the simulator owns a single scheduler; they are read from the
+ * simulator thread only.
+ */
+class CountingMapScheduler : public MapScheduler {
+public:
+    static TypeId GetTypeId() {
+        static TypeId tid = TypeId("ns3::IdsCountingMapScheduler")
+                                .SetParent<MapScheduler>()
+                                .SetGroupName("Core")
+                                .AddConstructor<CountingMapScheduler>();
+        return tid;
+    }
+
+    void Insert(const Scheduler::Event& ev) override {
+        MapScheduler::Insert(ev);
+        ++Depth();
+    }
+
+    Scheduler::Event RemoveNext() override {
+        --Depth();
+        Scheduler::Event ev = MapScheduler::RemoveNext();
+        if (CountContexts()) {
+            std::vector<uint64_t>& counts = ContextEvents();
+            uint32_t slot = (ev.key.m_context == Simulator::NO_CONTEXT) ? 0 : ev.key.m_context + 1;
+            if (slot >= counts.size()) {
+                counts.resize(slot + 1, 0);
+            }
+            ++counts[slot];
+        }
+        return ev;
+    }
+
+    void Remove(const Scheduler::Event& ev) override {
+        MapScheduler::Remove(ev);
+        --Depth();
+    }
+
+    /// Number of events currently queued.
+    static uint64_t GetDepth() { return Depth(); }
+
+    /// Starts counting dequeued events per context.
+    static void EnableContextCounts() { CountContexts() = true; }
+
+    /**
+     * Returns the number of events dequeued for a node since EnableContextCounts. Events are
+     * counted when they leave the queue, so cancelled events are included.
+     *
+     * @param nodeId Node ID, or Simulator::NO_CONTEXT for events scheduled without a context.
+     */
+    static uint64_t GetContextEvents(uint32_t nodeId) {
+        const std::vector<uint64_t>& counts = ContextEvents();
+        uint32_t slot = (nodeId == Simulator::NO_CONTEXT) ? 0 : nodeId + 1;
+        return slot < counts.size() ? counts[slot] : 0;
+    }
+
+    /// Makes the simulator use a CountingMapScheduler; queued events are moved into it.
+    static void Install() {
+        ObjectFactory factory;
+        factory.SetTypeId(GetTypeId());
+        Simulator::SetScheduler(factory);
+    }
+
+private:
+    static uint64_t& Depth() {
+        static uint64_t depth = 0;
+        return depth;
+    }
+
+    static bool& CountContexts() {
+        static bool enabled = false;
+        return enabled;
+    }
+
+    /// Slot 0 holds events without a context, slot n + 1 the events of node n.
+    static std::vector<uint64_t>& ContextEvents() {
+        static std::vector<uint64_t> counts;
+        return counts;
+    }
+};
+
+/**
+ * Samples executed events, wall-clock time and queue depth at a fixed simulated interval.
+ */
+class SimulationProfiler {
+public:
+    SimulationProfiler()
+        : m_file(nullptr), m_schedule(nullptr), m_lastSim(0.0), m_lastWall(0.0), m_lastEvents(0),
+          m_slowestStart(0.0), m_slowestWall(0.0) {
+        ResetTotals();
+    }
+
+    ~SimulationProfiler() { Close(); }
+
+    SimulationProfiler(const SimulationProfiler&) = delete;
+    SimulationProfiler& operator=(const SimulationProfiler&) = delete;
+
+    /**
+     * Writes the CSV header and schedules the first sample at the current simulation time.
+     * CountingMapScheduler::Install must have been called for the queue depth column.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @param interval Simulated time between samples.
+     * @param schedule Attack schedule used to tag intervals with a phase, or nullptr.
+     * @return true if the file is valid.
+     */
+    bool Open(AsyncOutputFile* file, Time interval, const AttackSchedule* schedule) {
+        Close();
+        m_file = file;
+        if (m_file == nullptr) {
+            return false;
+        }
+        m_interval = interval;
+        m_schedule = schedule;
+        ResetTotals();
+        static const char header[] = "sim_start_s,sim_end_s,wall_s,events,events_per_wall_s,sim_to_wall,queue_depth,"
+                                     "phase\n";
+        m_file->Write(header, sizeof(header) - 1);
+        Simulator::ScheduleNow(&SimulationProfiler::Start, this);
+        return true;
+    }
+
+    /// Writes the final partial interval and closes the timeline. Call after Simulator::Run.
+    void Close() {
+        if (m_file == nullptr) {
+            return;
+        }
+        if (m_started) {
+            Sample();
+        }
+        m_file->Close();
+        m_file = nullptr;
+    }
+
+    /**
+     * Writes per-phase totals and the slowest interval.
+     *
+     * @param os The stream receiving the report.
+     */
+    void Report(std::ostream& os) const {
+        os << "Simulation profile: " << m_totalEvents << " events in " << m_totalWall << " s wall for "
+           << m_totalSim << " s simulated";
+        if (m_slowestWall > 0.0) {
+            os << ", slowest interval at " << m_slowestStart << " s (" << m_slowestWall << " s wall)";
+        }
+        os << std::endl;
+        for (uint32_t p = 0; p < ATTACK_LABEL_COUNT; ++p) {
+            if (m_phaseSim[p] <= 0.0) {
+                continue;
+            }
+            os << "  " << AttackLabelName(p) << ": " << m_phaseSim[p] << " s simulated, " << m_phaseWall[p]
+               << " s wall, " << m_phaseEvents[p] << " events, "
+               << (m_phaseWall[p] > 0.0 ? m_phaseEvents[p] / m_phaseWall[p] : 0.0) << " events/s, sim/wall "
+               << (m_phaseWall[p] > 0.0 ? m_phaseSim[p] / m_phaseWall[p] : 0.0) << std::endl;
+        }
+    }
+
+private:
+    void ResetTotals() {
+        m_started = false;
+        m_totalEvents = 0;
+        m_totalWall = 0.0;
+        m_totalSim = 0.0;
+        m_slowestStart = 0.0;
+        m_slowestWall = 0.0;
+        for (uint32_t p = 0; p < ATTACK_LABEL_COUNT; ++p) {
+            m_phaseEvents[p] = 0;
+            m_phaseWall[p] = 0.0;
+            m_phaseSim[p] = 0.0;
+        }
+    }
+
+    /// First sample: takes the reference point inside Simulator::Run.
+    void Start() {
+        m_started = true;
+        m_wallStart = std::chrono::steady_clock::now();
+        m_lastSim = Simulator::Now().GetSeconds();
+        m_lastWall = 0.0;
+        m_lastEvents = Simulator::GetEventCount();
+        Simulator::Schedule(m_interval, &SimulationProfiler::Tick, this);
+    }
+
+    /// Periodic sample.
+    void Tick() {
+        Sample();
+        Simulator::Schedule(m_interval, &SimulationProfiler::Tick, this);
+    }
+
+    /// Writes one timeline row for the interval since the previous sample.
+    void Sample() {
+        double sim = Simulator::Now().GetSeconds();
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_wallStart).count();
+        uint64_t events = Simulator::GetEventCount();
+        double dSim = sim - m_lastSim;
+        double dWall = wall - m_lastWall;
+        uint64_t dEvents = events - m_lastEvents;
+        uint8_t phase = (m_schedule != nullptr) ? m_schedule->ActivePhase(m_lastSim) : ATTACK_BENIGN;
+
+        char line[192];
+        int n = std::snprintf(line, sizeof(line), "%.3f,%.3f,%.6f,%llu,%.0f,%.3f,%llu,%s\n", m_lastSim, sim, dWall,
+                              static_cast<unsigned long long>(dEvents), dWall > 0.0 ? dEvents / dWall : 0.0,
+                              dWall > 0.0 ? dSim / dWall : 0.0,
+                              static_cast<unsigned long long>(CountingMapScheduler::GetDepth()),
+                              AttackLabelName(phase));
+        m_file->Write(line, static_cast<size_t>(n));
+
+        m_phaseEvents[phase] += dEvents;
+        m_phaseWall[phase] += dWall;
+        m_phaseSim[phase] += dSim;
+        m_totalEvents += dEvents;
+        m_totalWall += dWall;
+        m_totalSim += dSim;
+        if (dWall > m_slowestWall) {
+            m_slowestWall = dWall;
+            m_slowestStart = m_lastSim;
+        }
+        m_lastSim = sim;
+        m_lastWall = wall;
+        m_lastEvents = events;
+    }
+
+    AsyncOutputFile* m_file;                             // Timeline CSV
+    const AttackSchedule* m_schedule;                    // Phase lookup, may be null
+    Time m_interval;                                     // Simulated time between samples
+    bool m_started;                                      // Start has run
+    std::chrono::steady_clock::time_point m_wallStart;   // Wall clock at the first sample
+    double m_lastSim;                                    // Simulated time of the previous sample
+    double m_lastWall;                                   // Wall seconds of the previous sample
+    uint64_t m_lastEvents;                               // Event count of the previous sample
+    double m_slowestStart;                               // Start of the interval with most wall time
+    double m_slowestWall;                                // Wall seconds of that interval
+    uint64_t m_totalEvents;
+    double m_totalWall;
+    double m_totalSim;
+    uint64_t m_phaseEvents[ATTACK_LABEL_COUNT];          // Totals per AttackLabel
+    double m_phaseWall[ATTACK_LABEL_COUNT];
+    double m_phaseSim[ATTACK_LABEL_COUNT];
+};
+
+} // namespace ns3
+
+#endif // IDS_SIM_PROFILER_H
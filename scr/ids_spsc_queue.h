@@ -0,0 +1,100 @@
+// Single-Producer Single-Consumer Queue for the IDS Dataset Simulation
+//
+// Bounded lock-free ring used to hand packet records from the simulator thread to a worker
+// thread (ids_flow_features.h). Exactly one thread may push and exactly one thread may pop:
+// - The head and tail counters only grow; the slot is the counter modulo the power-of-two
+//   capacity, so full (tail - head == capacity) and empty (tail == head) are unambiguous.
+// - Each side publishes its counter with a release store and reads the other side's with an
+//   acquire load, which orders the slot copy with the counter update without any lock.
+// - Each side caches the last value it read of the other side's counter and only reloads it when
+//   the cached value says full or empty, so the shared cache lines move only when needed. The
+//   producer and consumer fields live on separate cache lines.
+// Push and Pop never block; the caller decides how to wait. Only depends on the C++ standard
+// library.
+
+#ifndef IDS_SPSC_QUEUE_H
+#define IDS_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Bounded lock-free queue with one producer thread and one consumer thread.
+ *
+ * @tparam T Copyable record type.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    /**
+     * Creates the queue with all slots allocated.
+     *
+     * @param capacity Records the queue holds, rounded up to a power of two.
+     */
+    explicit SpscQueue(size_t capacity) : m_tail(0), m_headCache(0), m_head(0), m_tailCache(0) {
+        size_t slots = 2;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        m_mask = slots - 1;
+        m_items.resize(slots);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t GetCapacity() const { return m_items.size(); }
+
+    /**
+     * Appends a record. Producer thread only.
+     *
+     * @param item The record.
+     * @return false if the queue is full.
+     */
+    bool Push(const T& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache == m_items.size()) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache == m_items.size()) {
+                return false;
+            }
+        }
+        m_items[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest record. Consumer thread only.
+     *
+     * @param item Receives the record.
+     * @return false if the queue is empty.
+     */
+    bool Pop(T& item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) {
+                return false;
+            }
+        }
+        item = m_items[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> m_tail;   // Records pushed, written by the producer
+    size_t m_headCache;                       // Producer's copy of m_head
+    alignas(64) std::atomic<size_t> m_head;   // Records popped, written by the consumer
+    size_t m_tailCache;                       // Consumer's copy of m_tail
+    alignas(64) size_t m_mask;                // Slots - 1
+    std::vector<T> m_items;                   // Ring of slots
+};
+
+} // namespace ns3
+
+#endif // IDS_SPSC_QUEUE_H
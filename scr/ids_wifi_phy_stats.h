@@ -0,0 +1,247 @@
+// Aggregating Wi-Fi PHY Trace Sink for the IDS Dataset Simulation
+//
+// The Wi-Fi callbacks in ids_dataset.cc used to print one line per frame (SNR, WifiMode and
+// preamble). With 10+ stations over a 1500 s run that is millions of formatted lines. This sink
+// instead keeps per-station, per-mode counters and SNR/size histograms in flat arrays and writes
+// a compact CSV summary every flush interval, so tracing the Wi-Fi segment costs a few array
+// increments per frame.
+//
+// Summary format (one block per flush window):
+//   window_start_s,window_end_s,station,mode,tx_frames,tx_bytes,rx_frames,rx_bytes,snr_mean_db,snr_hist,size_hist
+// - One row per (station, mode) with traffic in the window; histogram columns are empty.
+// - One row per active station with mode "all" carrying the histograms as colon-separated bin
+//   counts (trailing empty bins trimmed). SNR bins are 1 dB wide starting at 0 dB (received
+//   frames only); size bins are WIFI_STATS_SIZE_BIN_BYTES wide (transmitted and received frames).
+
+#ifndef IDS_WIFI_PHY_STATS_H
+#define IDS_WIFI_PHY_STATS_H
+
+#include "ids_async_output.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+constexpr uint32_t WIFI_STATS_MAX_MODES = 16;        // Distinct WifiModes tracked (802.11a uses 8)
+constexpr uint32_t WIFI_STATS_SNR_BINS = 64;         // 1 dB SNR bins, 0 dB .. 63+ dB
+constexpr uint32_t WIFI_STATS_SIZE_BINS = 20;        // Frame size bins, last bin collects the rest
+constexpr uint32_t WIFI_STATS_SIZE_BIN_BYTES = 128;  // Width of one frame size bin
+
+/**
+ * Per-station Wi-Fi PHY statistics stored in flat arrays and flushed as periodic summaries.
+ *
+ * Stations are registered once with AddStation before tracing starts; each trace sink is bound
+ * to its station slot so recording a frame never searches by node or device.
+ */
+class WifiPhyStats {
+public:
+    WifiPhyStats() : m_file(nullptr), m_windowStart(0.0) {
+        // Linear SNR thresholds for each 1 dB bin, so recording never calls log10
+        for (uint32_t b = 0; b < WIFI_STATS_SNR_BINS; ++b) {
+            m_snrThresholds[b] = std::pow(10.0, b / 10.0);
+        }
+    }
+
+    ~WifiPhyStats() { Close(); }
+
+    WifiPhyStats(const WifiPhyStats&) = delete;
+    WifiPhyStats& operator=(const WifiPhyStats&) = delete;
+
+    /**
+     * Starts writing summaries to a file and writes the CSV header.
+     *
+     * @param file Output file created by the AsyncOutputWriter.
+     * @return true if the file is valid.
+     */
+    bool Open(AsyncOutputFile* file) {
+        Close();
+        m_file = file;
+        if (m_file == nullptr) {
+            return false;
+        }
+        static const char header[] = "window_start_s,window_end_s,station,mode,tx_frames,tx_bytes,rx_frames,rx_bytes,"
+                                     "snr_mean_db,snr_hist,size_hist\n";
+        m_file->Write(header, sizeof(header) - 1);
+        return true;
+    }
+
+    /**
+     * Registers a station and returns its slot for binding to the trace sinks.
+     *
+     * @param name Label used for the station in the summary (e.g. "sta-3" or "ap").
+     * @return The station slot.
+     */
+    uint32_t AddStation(const std::string& name) {
+        m_stationNames.push_back(name);
+        uint32_t stations = m_stationNames.size();
+        m_counters.resize(stations * WIFI_STATS_MAX_MODES * COUNTER_COUNT, 0);
+        m_snrHist.resize(stations * WIFI_STATS_SNR_BINS, 0);
+        m_sizeHist.resize(stations * WIFI_STATS_SIZE_BINS, 0);
+        return stations - 1;
+    }
+
+    /**
+     * Returns the slot of a WifiMode, registering it on first use.
+     * Works with any type providing GetUid() and GetUniqueName() (ns3::WifiMode).
+     */
+    template <typename Mode>
+    uint32_t GetModeSlot(const Mode& mode) {
+        uint32_t uid = mode.GetUid();
+        for (uint32_t m = 0; m < m_modeUids.size(); ++m) {
+            if (m_modeUids[m] == uid) {
+                return m;
+            }
+        }
+        if (m_modeUids.size() == WIFI_STATS_MAX_MODES) {
+            return WIFI_STATS_MAX_MODES - 1;  // Fold any further modes into the last slot
+        }
+        m_modeUids.push_back(uid);
+        m_modeNames.push_back(mode.GetUniqueName());
+        return m_modeUids.size() - 1;
+    }
+
+    /**
+     * Records a transmitted frame.
+     *
+     * @param station Station slot returned by AddStation.
+     * @param modeSlot Mode slot returned by GetModeSlot.
+     * @param size Frame size in bytes.
+     */
+    void RecordTx(uint32_t station, uint32_t modeSlot, uint32_t size) {
+        uint64_t* counters = &m_counters[(station * WIFI_STATS_MAX_MODES + modeSlot) * COUNTER_COUNT];
+        ++counters[TX_FRAMES];
+        counters[TX_BYTES] += size;
+        ++m_sizeHist[station * WIFI_STATS_SIZE_BINS + SizeBin(size)];
+    }
+
+    /**
+     * Records a successfully received frame.
+     *
+     * @param station Station slot returned by AddStation.
+     * @param modeSlot Mode slot returned by GetModeSlot.
+     * @param size Frame size in bytes.
+     * @param snr Linear signal-to-noise ratio reported by the PHY.
+     */
+    void RecordRx(uint32_t station, uint32_t modeSlot, uint32_t size, double snr) {
+        uint64_t* counters = &m_counters[(station * WIFI_STATS_MAX_MODES + modeSlot) * COUNTER_COUNT];
+        ++counters[RX_FRAMES];
+        counters[RX_BYTES] += size;
+        ++m_sizeHist[station * WIFI_STATS_SIZE_BINS + SizeBin(size)];
+        ++m_snrHist[station * WIFI_STATS_SNR_BINS + SnrBin(snr)];
+    }
+
+    /**
+     * Writes the summary of the current window and resets all counters and histograms.
+     *
+     * @param now Current simulation time in seconds (end of the window).
+     */
+    void Flush(double now) {
+        if (m_file == nullptr) {
+            return;
+        }
+        for (uint32_t s = 0; s < m_stationNames.size(); ++s) {
+            bool active = false;
+            for (uint32_t m = 0; m < m_modeUids.size(); ++m) {
+                const uint64_t* c = &m_counters[(s * WIFI_STATS_MAX_MODES + m) * COUNTER_COUNT];
+                if (c[TX_FRAMES] == 0 && c[RX_FRAMES] == 0) {
+                    continue;
+                }
+                active = true;
+                Print("%.3f,%.3f,%s,%s,%llu,%llu,%llu,%llu,,,\n", m_windowStart, now,
+                      m_stationNames[s].c_str(), m_modeNames[m].c_str(),
+                      static_cast<unsigned long long>(c[TX_FRAMES]), static_cast<unsigned long long>(c[TX_BYTES]),
+                      static_cast<unsigned long long>(c[RX_FRAMES]), static_cast<unsigned long long>(c[RX_BYTES]));
+            }
+            if (active) {
+                const uint64_t* snr = &m_snrHist[s * WIFI_STATS_SNR_BINS];
+                const uint64_t* size = &m_sizeHist[s * WIFI_STATS_SIZE_BINS];
+                Print("%.3f,%.3f,%s,all,,,,,%.1f,%s,%s\n", m_windowStart, now,
+                      m_stationNames[s].c_str(), SnrMeanDb(snr),
+                      FormatHistogram(snr, WIFI_STATS_SNR_BINS).c_str(),
+                      FormatHistogram(size, WIFI_STATS_SIZE_BINS).c_str());
+            }
+        }
+        std::fill(m_counters.begin(), m_counters.end(), 0);
+        std::fill(m_snrHist.begin(), m_snrHist.end(), 0);
+        std::fill(m_sizeHist.begin(), m_sizeHist.end(), 0);
+        m_windowStart = now;
+    }
+
+    /// Closes the summary file without flushing the current window.
+    void Close() {
+        if (m_file != nullptr) {
+            m_file->Close();
+            m_file = nullptr;
+        }
+    }
+
+private:
+    /// Counter layout for one (station, mode) cell.
+    enum Counter { TX_FRAMES = 0, TX_BYTES, RX_FRAMES, RX_BYTES, COUNTER_COUNT };
+
+    /// Formats one summary line into a stack buffer and appends it to the output file.
+    template <typename... Args>
+    void Print(const char* format, Args... args) {
+        char line[1024];
+        int n = std::snprintf(line, sizeof(line), format, args...);
+        if (n > 0) {
+            m_file->Write(line, std::min<size_t>(n, sizeof(line) - 1));
+        }
+    }
+
+    static uint32_t SizeBin(uint32_t size) {
+        return std::min(size / WIFI_STATS_SIZE_BIN_BYTES, WIFI_STATS_SIZE_BINS - 1);
+    }
+
+    /// Finds the 1 dB bin of a linear SNR with a binary search over the precomputed thresholds.
+    uint32_t SnrBin(double snr) const {
+        const double* end = m_snrThresholds + WIFI_STATS_SNR_BINS;
+        uint32_t bin = std::upper_bound(m_snrThresholds, end, snr) - m_snrThresholds;
+        return bin == 0 ? 0 : bin - 1;
+    }
+
+    /// Mean SNR in dB estimated from the bin centres of a station's SNR histogram.
+    static double SnrMeanDb(const uint64_t* hist) {
+        uint64_t total = 0;
+        double weighted = 0.0;
+        for (uint32_t b = 0; b < WIFI_STATS_SNR_BINS; ++b) {
+            total += hist[b];
+            weighted += hist[b] * (b + 0.5);
+        }
+        return total > 0 ? weighted / total : 0.0;
+    }
+
+    static std::string FormatHistogram(const uint64_t* hist, uint32_t bins) {
+        uint32_t used = bins;
+        while (used > 0 && hist[used - 1] == 0) {
+            --used;
+        }
+        std::string out;
+        for (uint32_t b = 0; b < used; ++b) {
+            if (b > 0) {
+                out += ':';
+            }
+            out += std::to_string(hist[b]);
+        }
+        return out;
+    }
+
+    AsyncOutputFile* m_file;                 // Summary CSV
+    double m_windowStart;                    // Start of the current window (seconds)
+    double m_snrThresholds[WIFI_STATS_SNR_BINS];
+    std::vector<std::string> m_stationNames; // Station slot -> label
+    std::vector<uint32_t> m_modeUids;        // Mode slot -> WifiMode UID
+    std::vector<std::string> m_modeNames;    // Mode slot -> WifiMode unique name
+    std::vector<uint64_t> m_counters;        // [station][mode][counter]
+    std::vector<uint64_t> m_snrHist;         // [station][snr bin]
+    std::vector<uint64_t> m_sizeHist;        // [station][size bin]
+};
+
+} // namespace ns3
+
+#endif // IDS_WIFI_PHY_STATS_H